@@ -20,6 +20,18 @@ using AllocationAnalysisScratchSizeFn = std::function<unsigned(Operation *)>;
 
 unsigned defaultAllocationAnalysisScratchSizeFn(Operation *op);
 
+/// Strategy used to assign shared memory offsets to buffers.
+enum class AllocationPolicy {
+  /// First-fit coloring of the interference graph.
+  GraphColoring,
+  /// Best-fit packing of buffers over their liveness intervals. The graph
+  /// coloring result is kept whenever it is not larger.
+  BestFit,
+};
+
+/// Returns the policy selected through `TRITON_SMEM_BEST_FIT`.
+AllocationPolicy getDefaultAllocationPolicy();
+
 // To convert a tensor from one layout to another, we need to allocate a
 // temporary buffer (i.e., scratch buffer) in shared memory. The conversion may
 // require multiple iterations, with each iteration involving multiple
@@ -111,7 +123,9 @@ public:
 
   /// Runs allocation analysis on the given top-level operation.
   void run(FuncAllocMapT &funcAllocMap,
-           triton::AllocationAnalysisScratchSizeFn scratchSizeGetter);
+           triton::AllocationAnalysisScratchSizeFn scratchSizeGetter,
+           triton::AllocationPolicy policy =
+               triton::AllocationPolicy::GraphColoring);
 
   /// Returns the operation this analysis was constructed from.
   Operation *getOperation() const { return operation; }
@@ -176,6 +190,10 @@ public:
   /// Returns the size of total shared memory allocated
   size_t getSharedMemorySize() const { return sharedMemorySize; }
 
+  /// Returns the number of bytes saved by the selected allocation policy
+  /// compared to graph coloring.
+  size_t getSharedMemorySizeSaved() const { return sharedMemorySizeSaved; }
+
   /// Returns mapping from operation to list of live LDS buffers
   std::map<Operation *, SmallVector<BufferId>> getLiveBuffers();
 
@@ -244,6 +262,7 @@ private:
   AliasBufferMapT aliasBuffer;
   BufferSetT bufferSet;
   size_t sharedMemorySize = 0;
+  size_t sharedMemorySizeSaved = 0;
 
   size_t bufferIdCounter = 0;
 
@@ -262,7 +281,9 @@ public:
 
   ModuleAllocation(ModuleOp moduleOp,
                    triton::AllocationAnalysisScratchSizeFn scratchSizeGetter =
-                       triton::defaultAllocationAnalysisScratchSizeFn)
+                       triton::defaultAllocationAnalysisScratchSizeFn,
+                   triton::AllocationPolicy policy =
+                       triton::getDefaultAllocationPolicy())
       : CallGraph<Allocation>(moduleOp) {
     walk<WalkOrder::PreOrder, WalkOrder::PostOrder>(
         // Pre-order edge walk callback
@@ -271,7 +292,7 @@ public:
         [&](FunctionOpInterface funcOp) {
           auto [iter, inserted] = funcMap.try_emplace(funcOp, funcOp);
           if (inserted)
-            iter->second.run(funcMap, scratchSizeGetter);
+            iter->second.run(funcMap, scratchSizeGetter, policy);
         });
   }
 
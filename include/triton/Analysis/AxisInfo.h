@@ -199,6 +199,11 @@ using CallbackType = std::function<void(AxisInfoVisitorList &)>;
 // axis info based on the axis info of all the callers.  In the future, we can
 // perform optimization using function cloning so that each call site will have
 // unique axis info.
+//
+// Passes should get the analysis with `getAnalysis<ModuleAxisInfoAnalysis>()`
+// rather than constructing it, so that it is shared with the following passes
+// when they are run on unchanged IR. Passes that only annotate operations, and
+// therefore neither create nor erase values, mark it as preserved.
 using AxisInfoMapT = DenseMap<Value, AxisInfo>;
 class ModuleAxisInfoAnalysis : public CallGraph<AxisInfoMapT> {
 public:
@@ -260,6 +265,10 @@ public:
 
   unsigned getMaskAlignment(Value mask);
 
+  // Returns the number of dataflow solver runs of all the instances of the
+  // analysis in this process, for compile-time benchmarks.
+  static uint64_t getNumSolverRuns();
+
 private:
   void initialize(FunctionOpInterface funcOp,
                   axisinfo::CallbackType callback = nullptr);
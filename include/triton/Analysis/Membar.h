@@ -3,6 +3,7 @@
 
 #include "Allocation.h"
 
+#include <map>
 #include <set>
 
 namespace mlir {
@@ -24,12 +25,8 @@ struct BlockInfo {
 
   /// Unions two BlockInfo objects.
   BlockInfo &join(const BlockInfo &other) {
-    for (auto &interval : other.syncReadIntervals)
-      syncReadIntervals[interval.first].insert(interval.second.begin(),
-                                               interval.second.end());
-    for (auto &interval : other.syncWriteIntervals)
-      syncWriteIntervals[interval.first].insert(interval.second.begin(),
-                                                interval.second.end());
+    join(syncReadIntervals, other.syncReadIntervals);
+    join(syncWriteIntervals, other.syncWriteIntervals);
     return *this;
   }
 
@@ -77,17 +74,70 @@ struct BlockInfo {
   bool operator!=(const BlockInfo &other) const { return !(*this == other); }
 
 private:
+  /// Merges `src` into `dst`. Both maps are sorted by interval, so each
+  /// insertion is hinted with the position following the previous one and
+  /// costs amortized constant time.
+  static void join(IntervalMapT &dst, const IntervalMapT &src) {
+    auto hint = dst.begin();
+    for (auto &[interval, ops] : src) {
+      auto it = dst.try_emplace(hint, interval);
+      it->second.insert(ops.begin(), ops.end());
+      hint = std::next(it);
+    }
+  }
+
+  /// Returns true if an interval of `lhsIntervalSet` intersects an interval
+  /// of `rhsIntervalSet` with a pair of operations that is not filtered out.
+  /// Both maps are sorted by start, so the overlapping pairs are enumerated
+  /// with a single sweep that keeps the intervals of each side that are still
+  /// open, instead of comparing every pair of intervals.
   bool isIntersected(const IntervalMapT &lhsIntervalSet,
                      const IntervalMapT &rhsIntervalSet,
                      MembarFilterFn filter) const {
-    for (auto &lhs : lhsIntervalSet)
-      for (auto &rhs : rhsIntervalSet)
-        if (lhs.first.intersects(rhs.first))
-          for (auto lhsOp : lhs.second)
-            for (auto rhsOp : rhs.second)
-              if (!filter || !filter(lhsOp, rhsOp))
-                return true;
-
+    using EntryT = IntervalMapT::value_type;
+    auto opsIntersect = [&](const EntryT &lhs, const EntryT &rhs) {
+      if (!filter)
+        return true;
+      for (auto lhsOp : lhs.second)
+        for (auto rhsOp : rhs.second)
+          if (!filter(lhsOp, rhsOp))
+            return true;
+      return false;
+    };
+
+    // Open intervals of each side, keyed by interval end.
+    std::multimap<size_t, const EntryT *> lhsOpen, rhsOpen;
+    // Closes the intervals of `open` that end before `start` and returns true
+    // if `entry` intersects one of the remaining ones.
+    auto visit = [&](const EntryT &entry,
+                     std::multimap<size_t, const EntryT *> &open, bool isLhs) {
+      size_t start = entry.first.start();
+      open.erase(open.begin(), open.upper_bound(start));
+      for (auto &[end, other] : open) {
+        if (!entry.first.intersects(other->first))
+          continue;
+        if (isLhs ? opsIntersect(entry, *other) : opsIntersect(*other, entry))
+          return true;
+      }
+      return false;
+    };
+
+    auto lhsIt = lhsIntervalSet.begin(), lhsEnd = lhsIntervalSet.end();
+    auto rhsIt = rhsIntervalSet.begin(), rhsEnd = rhsIntervalSet.end();
+    while (lhsIt != lhsEnd || rhsIt != rhsEnd) {
+      if (rhsIt == rhsEnd ||
+          (lhsIt != lhsEnd && lhsIt->first.start() <= rhsIt->first.start())) {
+        if (visit(*lhsIt, rhsOpen, /*isLhs=*/true))
+          return true;
+        lhsOpen.emplace(lhsIt->first.end(), &*lhsIt);
+        ++lhsIt;
+      } else {
+        if (visit(*rhsIt, lhsOpen, /*isLhs=*/false))
+          return true;
+        rhsOpen.emplace(rhsIt->first.end(), &*rhsIt);
+        ++rhsIt;
+      }
+    }
     return false;
   }
 };
@@ -1,5 +1,5 @@
-#ifndef TRITONAMD_ANALYSIS_RANGE_ANALYSIS_H
-#define TRITONAMD_ANALYSIS_RANGE_ANALYSIS_H
+#ifndef TRITON_ANALYSIS_RANGE_ANALYSIS_H
+#define TRITON_ANALYSIS_RANGE_ANALYSIS_H
 
 #include "mlir/Analysis/DataFlow/IntegerRangeAnalysis.h"
 #include "mlir/Analysis/DataFlow/SparseAnalysis.h"
@@ -7,10 +7,8 @@
 #include "mlir/Interfaces/LoopLikeInterface.h"
 
 namespace mlir::triton {
-class FuncOp;
-}
 
-namespace mlir::triton::AMD {
+class FuncOp;
 
 /// This struct (analysis) adapt's upstream's IntegerRangeAnalysis (inferring
 /// lower/upperbounds on integer constants) to our needs.
@@ -125,6 +123,10 @@ struct TritonIntegerRangeAnalysis : dataflow::IntegerRangeAnalysis {
   /// If one uses collectAssumptions below then `assumptions` will look like
   /// %K -> {arith.cmpi slt..., arith.cmpi sge}.
   llvm::DenseMap<Value, SetVector<Operation *>> assumptions;
+
+  /// Upper bound on the number of programs along each axis of the grid, which
+  /// bounds the ranges of `tt.get_program_id` and `tt.get_num_programs`.
+  int64_t maxNumPrograms = 1 << 16;
 };
 
 std::optional<SmallVector<std::optional<ConstantIntRanges>>>
@@ -140,6 +142,6 @@ void populateFoldTrueCmpIOpPatterns(RewritePatternSet &patterns,
 void initializeFuncOps(Operation *op,
                        TritonIntegerRangeAnalysis *rangeAnalysis);
 
-} // namespace mlir::triton::AMD
+} // namespace mlir::triton
 
 #endif
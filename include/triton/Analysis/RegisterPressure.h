@@ -0,0 +1,51 @@
+#ifndef TRITON_ANALYSIS_REGISTER_PRESSURE_H
+#define TRITON_ANALYSIS_REGISTER_PRESSURE_H
+
+#include "mlir/Analysis/Liveness.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace mlir::triton {
+
+/// Returns the number of 32-bit registers a thread needs to hold a value of
+/// the given type. Only tensors with an encoding are counted: scalars are few
+/// and often uniform, and memory descriptors point to shared or tensor memory.
+unsigned getNumI32RegsPerThread(Type type);
+
+/// Static estimate of the number of 32-bit registers per thread live at each
+/// operation, computed from the tensor encodings and the liveness of the
+/// values. It knows nothing about rematerialization or instruction selection,
+/// so it is meant to compare schedules and configurations rather than to
+/// predict the exact register count of the kernel.
+class RegisterPressureAnalysis {
+public:
+  explicit RegisterPressureAnalysis(Operation *root);
+
+  /// Returns the registers live while `op` executes: the values live across
+  /// it, plus its results or the operands it consumes, whichever is larger,
+  /// since a result can reuse the registers of an operand it is the last use
+  /// of. Ops nested in the regions of `op` are not included.
+  unsigned getPressure(Operation *op) const { return pressure.lookup(op); }
+
+  /// Returns the largest pressure at any operation nested in `region`.
+  unsigned getMaxPressure(Region &region) const;
+
+  /// Returns the largest pressure at any operation nested in the root.
+  unsigned getMaxPressure() const;
+
+private:
+  /// Adds the values live across `op` in its block to `across`, and returns
+  /// the registers of the values it consumes.
+  unsigned getLiveValues(Operation *op, SmallVectorImpl<Value> &across) const;
+
+  unsigned computePressure(Operation *op);
+
+  Operation *root;
+  Liveness liveness;
+  DenseMap<Operation *, unsigned> pressure;
+  /// Values live across an op with regions, for the ops nested in it.
+  DenseMap<Operation *, SmallVector<Value>> liveAcross;
+};
+
+} // namespace mlir::triton
+
+#endif // TRITON_ANALYSIS_REGISTER_PRESSURE_H
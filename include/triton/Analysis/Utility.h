@@ -240,18 +240,29 @@ bool supportMMA(Value value, int version);
 // kWarp or kLane) if it can be avoided
 triton::LinearLayout minimalCvtLayout(Type srcTy, Type dstTy);
 
+// Returns how a conversion from `srcTy` to `dstTy` moves data. Plans are
+// memoized on the TritonGPU dialect, keyed by the shape, the two encodings and
+// the element bitwidth.
+std::shared_ptr<const triton::gpu::ConvertLayoutPlan>
+getConvertLayoutPlan(RankedTensorType srcTy, RankedTensorType dstTy);
+
 // Conversion from `srcTy` to `dstTy` only involves reordering of registers.
 // There is no need for data exchange across threads, warps, or blocks.
 bool cvtReordersRegisters(RankedTensorType srcTy, RankedTensorType dstTy);
 
 // Conversion from `srcTy` to `dstTy` involves data exchange across threads
-// within a warp.  No data exchange across warps or blocks is needed.
+// within a warp.  No data exchange across warps or blocks is needed, and warp
+// shuffles are estimated to be cheaper than a round trip through shared memory.
 bool cvtNeedsWarpShuffle(RankedTensorType srcTy, RankedTensorType dstTy);
 
 // Conversion from `srcTy` to `dstTy` involves data exchange across threads,
 // warps, and possibly blocks.
 bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy);
 
+// Bitwidth of the elements of `ty` when a layout conversion moves them between
+// threads. Pointers are moved as 64-bit integers and sub-byte types as bytes.
+unsigned getConvertLayoutBitwidth(RankedTensorType ty);
+
 bool atomicNeedsSharedMemory(Value result);
 
 // Return true if the src and dst layout match.
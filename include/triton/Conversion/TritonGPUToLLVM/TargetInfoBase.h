@@ -59,6 +59,10 @@ public:
   virtual Value programId(RewriterBase &rewriter, Location loc,
                           ModuleOp moduleOp, int axis) const = 0;
 
+  // Reads the free-running cycle counter of the SM (CU) executing the calling
+  // thread as an i64.
+  virtual Value getCycleCounter(RewriterBase &rewriter, Location loc) const = 0;
+
   virtual bool warpReduce(RewriterBase &rewriter, Location loc,
                           SmallVector<Value> &acc, triton::ReduceOp op,
                           unsigned numLaneToReduce,
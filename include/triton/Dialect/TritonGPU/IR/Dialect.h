@@ -11,12 +11,19 @@
 #include "triton/Dialect/TritonGPU/IR/Attributes.h"
 #include "triton/Dialect/TritonGPU/IR/Traits.h"
 #include "triton/Dialect/TritonGPU/IR/Types.h"
+#include "llvm/Support/RWMutex.h"
 
+#include <atomic>
+#include <list>
+#include <memory>
 #include <unordered_map>
 
 // LinearLayoutCache Utils
 using CacheKey =
     std::tuple<std::vector<int64_t>, mlir::Attribute, std::vector<int64_t>>;
+// Shape, source and destination encodings, and element bitwidth
+using ConvertLayoutPlanKey = std::tuple<std::vector<int64_t>, mlir::Attribute,
+                                        mlir::Attribute, unsigned>;
 
 namespace llvm {
 template <typename T> size_t hash_value(const std::vector<T> &vec) {
@@ -25,8 +32,10 @@ template <typename T> size_t hash_value(const std::vector<T> &vec) {
 } // namespace llvm
 
 namespace std {
-template <> struct hash<CacheKey> {
-  size_t operator()(const CacheKey &key) const noexcept {
+template <typename... Ts>
+struct hash<std::tuple<std::vector<int64_t>, mlir::Attribute, Ts...>> {
+  size_t operator()(const std::tuple<std::vector<int64_t>, mlir::Attribute,
+                                     Ts...> &key) const noexcept {
     using llvm::hash_value;
     size_t seed = 0;
     std::apply(
@@ -58,29 +67,146 @@ std::optional<int> maybeLookupNumWarps(Operation *op);
 // Utility to find the number of threads per warp
 int lookupThreadsPerWarp(OpBuilder &rewriter);
 
+struct CacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t size = 0;
+};
+
+// Thread-safe cache with a bounded size. Lookups only take a shared lock:
+// instead of a strict least-recently-used order, every hit sets a reference bit
+// and eviction sweeps the entries in insertion order, sparing (and clearing)
+// those referenced since the last sweep. Values are handed out as shared
+// immutable handles: a hit never copies the cached value and an evicted value
+// stays alive for as long as a caller holds its handle.
 template <typename Key, typename Value> class Cache {
 public:
-  std::optional<Value> get(const Key &key) {
+  using Handle = std::shared_ptr<const Value>;
+
+  static constexpr size_t kDefaultCapacity = 1 << 14;
+
+  explicit Cache(size_t capacity = kDefaultCapacity) : capacity(capacity) {}
+
+  Handle get(const Key &key) {
     std::shared_lock lock(mutex);
-    auto it = cache.find(key);
-    if (it != cache.end()) {
-      return it->second;
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+      ++misses;
+      return nullptr;
     }
-    return std::nullopt;
+    ++hits;
+    it->second.referenced.store(true, std::memory_order_relaxed);
+    return it->second.value;
   }
 
-  void set(Key key, Value result) {
+  // Inserts `value` unless another thread inserted `key` first, and returns
+  // the handle that is cached for `key`.
+  Handle set(Key key, Value value) {
+    auto handle = std::make_shared<const Value>(std::move(value));
     std::scoped_lock lock(mutex);
-    cache.emplace(std::move(key), std::move(result));
+    auto [it, inserted] = entries.try_emplace(std::move(key));
+    if (!inserted)
+      return it->second.value;
+    it->second.value = handle;
+    // Insert right behind the clock hand so the new entry is swept last.
+    clock.insert(hand, &*it);
+    evictLocked();
+    return handle;
+  }
+
+  // Sets the maximum number of cached entries, 0 meaning unbounded.
+  void setCapacity(size_t newCapacity) {
+    std::scoped_lock lock(mutex);
+    capacity = newCapacity;
+    evictLocked();
+  }
+
+  CacheStats getStats() {
+    CacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    std::shared_lock lock(mutex);
+    stats.size = entries.size();
+    return stats;
   }
 
 private:
-  std::unordered_map<Key, Value> cache;
+  struct Entry {
+    Handle value;
+    std::atomic<bool> referenced = false;
+  };
+  using Map = std::unordered_map<Key, Entry>;
+
+  void evictLocked() {
+    if (capacity == 0)
+      return;
+    while (entries.size() > capacity) {
+      if (hand == clock.end())
+        hand = clock.begin();
+      auto *entry = *hand;
+      if (entry->second.referenced.exchange(false,
+                                            std::memory_order_relaxed)) {
+        ++hand;
+        continue;
+      }
+      hand = clock.erase(hand);
+      entries.erase(entry->first);
+      ++evictions;
+    }
+  }
+
+  Map entries;
+  // The entries in insertion order, swept circularly by `hand` on eviction.
+  // Elements of an unordered_map are never moved, so the pointers stay valid.
+  std::list<typename Map::value_type *> clock;
+  typename std::list<typename Map::value_type *>::iterator hand = clock.end();
+  size_t capacity;
   llvm::sys::SmartRWMutex<true> mutex;
+  std::atomic<uint64_t> hits = 0;
+  std::atomic<uint64_t> misses = 0;
+  std::atomic<uint64_t> evictions = 0;
 };
 
 using LinearLayoutCache = Cache<CacheKey, LinearLayout>;
 using LinearEncodingCache = Cache<CacheKey, LinearEncodingAttr>;
+
+// How a ttg.convert_layout moves data, from the cheapest to the most expensive
+// strategy.
+enum class ConvertLayoutStrategy {
+  // The two layouts are equivalent.
+  Identity,
+  // Every thread already holds its data and only reorders its registers.
+  RegisterPermutation,
+  // Data only moves between the lanes of a warp, using warp shuffles.
+  WarpShuffle,
+  // Data is staged through swizzled shared memory.
+  SharedMemory,
+  // Data moves between CTAs through distributed shared memory.
+  DistributedSharedMemory,
+};
+
+// The data movement needed by a layout conversion. It only depends on the
+// shape, the two encodings and the element bitwidth, so it is computed once
+// per such key and shared by the analyses and the lowering.
+struct ConvertLayoutPlan {
+  ConvertLayoutStrategy strategy = ConvertLayoutStrategy::Identity;
+  // The minimal conversion, see minimalCvtLayout.
+  LinearLayout conversion;
+  // WarpShuffle: the factors of the conversion computed by
+  // getWarpLayoutConvertDecomposition.
+  LinearLayout pReg, pLane;
+  SmallVector<std::pair<int, int>> mixedTranspositions;
+  // SharedMemory, DistributedSharedMemory and WarpShuffle: the swizzled layout
+  // through which the registers, stripped of broadcasting, are or would be
+  // staged, along with the log2 of its read and write bank conflicts.
+  LinearLayout sharedLayout;
+  int readBankConflicts = 0;
+  int writeBankConflicts = 0;
+};
+
+using ConvertLayoutPlanCache = Cache<ConvertLayoutPlanKey, ConvertLayoutPlan>;
 } // namespace mlir::triton::gpu
 
 #define GET_OP_CLASSES
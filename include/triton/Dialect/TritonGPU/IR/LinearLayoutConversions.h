@@ -4,6 +4,7 @@
 #ifndef TRITON_DIALECT_TRITONGPU_IR_LINEARLAYOUTCONVERSIONS_H
 #define TRITON_DIALECT_TRITONGPU_IR_LINEARLAYOUTCONVERSIONS_H
 
+#include <memory>
 #include <optional>
 
 #include "triton/Tools/LinearLayout.h"
@@ -53,6 +54,13 @@ LinearLayout toLinearLayout(RankedTensorType type);
 LinearLayout toLinearLayout(MemDescType type);
 LinearLayout toLinearLayout(TensorOrMemDesc type);
 
+// Same as toLinearLayout, but returns the layout held by the layout cache
+// rather than a copy of it. Prefer these when the layout is only read.
+std::shared_ptr<const LinearLayout>
+getCachedLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
+                      ArrayRef<int64_t> allocationShape);
+std::shared_ptr<const LinearLayout> getCachedLinearLayout(TensorOrMemDesc type);
+
 // Convert the shared encoding of a tensor with `nvmma_shared` layout to a
 // LinearLayout that maps from a linear shared memory offset to tensor index.
 //
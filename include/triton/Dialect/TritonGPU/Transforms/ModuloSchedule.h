@@ -0,0 +1,157 @@
+#ifndef TRITON_TRITONGPU_TRANSFORMS_PIPELINER_MODULO_SCHEDULE_H_
+#define TRITON_TRITONGPU_TRANSFORMS_PIPELINER_MODULO_SCHEDULE_H_
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace mlir::triton::gpu {
+
+// The execution resources an op can hold while it runs. `Issue` is the
+// instruction stream of the warps: asynchronous ops only hold it for the cycle
+// they are issued in, while synchronous ones hold it until they are done.
+enum class PipelineResource {
+  Issue,
+  GlobalMemory,
+  SharedMemory,
+  TensorCore,
+  NumResources,
+};
+
+// How long an op takes on a target. `latency` is the number of cycles after
+// which its results can be used, `occupancy` the number of cycles it holds
+// `resource` and `issueCycles` the number of cycles it holds the issue slot.
+struct OpTiming {
+  PipelineResource resource = PipelineResource::Issue;
+  int latency = 0;
+  int occupancy = 0;
+  int issueCycles = 0;
+};
+
+// Per-target latency and throughput table used by the modulo scheduler. The
+// throughputs are per SM (or CU), assuming one CTA per SM.
+struct PipelineTargetDesc {
+  // Latency of a global load and bytes per cycle of cp.async, TMA or buffer
+  // loads.
+  int globalLatency;
+  double globalBytesPerCycle;
+  // Latency of a ds_read/ds_write (ld.shared/st.shared) and bytes per cycle.
+  int sharedLatency;
+  double sharedBytesPerCycle;
+  // Latency of an MMA (mma.sync, wgmma, tcgen05 or MFMA) and dense 16-bit
+  // FLOPs per cycle.
+  int mmaLatency;
+  double mmaFlopsPerCycle;
+  // Budgets the schedule has to fit in.
+  int64_t sharedMemoryBytes;
+  int registersPerThread;
+};
+
+class PipelineTargetModel {
+public:
+  explicit PipelineTargetModel(const PipelineTargetDesc &desc) : desc(desc) {}
+
+  // Return the model of the `ttg.target` of the module.
+  static PipelineTargetModel get(ModuleOp module);
+
+  // Return the timing of the op. Ops the model doesn't know are free.
+  OpTiming getTiming(Operation *op) const;
+
+  // Return the timing of a global load, a shared memory access or an MMA of
+  // the given size, for ops that are not created yet.
+  OpTiming getGlobalLoadTiming(int64_t bytes) const;
+  OpTiming getSharedMemoryTiming(int64_t bytes) const;
+  OpTiming getMMATiming(int64_t flops, bool isAsync) const;
+
+  const PipelineTargetDesc &getDesc() const { return desc; }
+
+private:
+  PipelineTargetDesc desc;
+};
+
+// Iterative modulo scheduler (Rau, "Iterative Modulo Scheduling", 1994) over
+// a dependence graph of the ops of a loop body. It looks for the smallest
+// initiation interval (II), in cycles, at which the ops can be placed without
+// oversubscribing any resource, that fits the shared memory and register
+// budgets of the target and that uses no more than the given number of stages.
+class ModuloScheduler {
+public:
+  struct Node {
+    // The op, or null for an op the caller will only create after scheduling.
+    Operation *op;
+    OpTiming timing;
+    // Bytes of one shared memory buffer holding the result. The number of
+    // buffers is the number of stages to the last user, plus `extraBuffers`.
+    int64_t sharedMemoryBytes = 0;
+    int extraBuffers = 0;
+    // 32-bit registers per thread holding the result. Each stage it is carried
+    // across holds a copy.
+    int numRegs = 0;
+  };
+
+  struct Edge {
+    unsigned src;
+    unsigned dst;
+    int latency;
+    // Number of iterations the dependency is carried over.
+    int distance;
+    // The user can only wait for the value at a stage boundary, e.g. for an
+    // asynchronous copy into a multi-buffered allocation.
+    bool crossStage;
+  };
+
+  struct Result {
+    int ii;
+    int numStages;
+    // The start cycle of each node, relative to the start of its iteration.
+    SmallVector<int> times;
+    // Bytes of shared memory and 32-bit registers per thread held by the
+    // nodes.
+    int64_t sharedMemoryBytes;
+    int numRegs;
+
+    int getStage(unsigned node) const { return times[node] / ii; }
+    int getSlot(unsigned node) const { return times[node] % ii; }
+  };
+
+  explicit ModuloScheduler(const PipelineTargetModel &model) : model(model) {}
+
+  unsigned addNode(Node node);
+  void addEdge(unsigned src, unsigned dst, int latency, int distance = 0,
+               bool crossStage = false);
+
+  // Add an op with the timing given by the target model.
+  unsigned addOp(Operation *op, int64_t sharedMemoryBytes = 0, int numRegs = 0);
+
+  // Set the 32-bit registers per thread live in the loop whatever the
+  // schedule. The values carried across stages have to fit in the rest.
+  void setLiveRegisters(int numRegs) { liveRegs = numRegs; }
+
+  const Node &getNode(unsigned node) const { return nodes[node]; }
+  unsigned getNumNodes() const { return nodes.size(); }
+
+  // Schedule the graph in at most `maxStages` stages.
+  FailureOr<Result> run(int maxStages) const;
+
+private:
+  int getResMII() const;
+  bool hasPositiveCycle(int ii) const;
+  std::optional<Result> scheduleAt(int ii, int maxStages) const;
+  void computeBudgets(Result &result) const;
+
+  const PipelineTargetModel &model;
+  SmallVector<Node> nodes;
+  SmallVector<Edge> edges;
+  int liveRegs = 0;
+};
+
+// Return the number of bytes of a tensor or memory descriptor of the given
+// type, or 0 for any other type.
+int64_t getNumBytes(Type type);
+
+} // namespace mlir::triton::gpu
+
+#endif // TRITON_TRITONGPU_TRANSFORMS_PIPELINER_MODULO_SCHEDULE_H_
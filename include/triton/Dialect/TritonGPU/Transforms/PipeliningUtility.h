@@ -65,6 +65,15 @@ Value sinkValueRedefinition(RewriterBase &rewriter, Value in, Value out,
 bool loopHasDistGreaterThanOne(scf::ForOp forOp);
 bool isOuterLoop(scf::ForOp forOp);
 
+// Yield a copy of every loop-carried value that is passed through the loop
+// unchanged, so that all loop-carried dependencies have a distance of one.
+// The copies are identity casts that canonicalization folds away. Return the
+// copies that were created.
+SmallVector<Operation *> splitLoopCarriedDistances(scf::ForOp forOp);
+// Fold the copies created by `splitLoopCarriedDistances` back into the values
+// they copy.
+void removeLoopCarriedCopies(ArrayRef<Operation *> copies);
+
 /// Function to mask operations during scheduling.
 Operation *predicateOp(RewriterBase &rewriter, Operation *op, Value pred);
 
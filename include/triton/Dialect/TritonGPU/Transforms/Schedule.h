@@ -17,9 +17,12 @@ namespace gpu {
 
 /// Lower the loops to prepare them for pipeline expansion.
 void lowerLoops(ModuleOp moduleOp);
+void lowerLoops(ModuleOp moduleOp,
+                triton::ModuleAxisInfoAnalysis &axisInfoAnalysis);
 
 bool hasGpuBarriers(scf::ForOp forOp);
-bool isSafeToPipeline(scf::ForOp forOp);
+bool isSafeToPipeline(scf::ForOp forOp, bool allowOuterLoops = false,
+                      bool allowLongDistances = false);
 llvm::MapVector<Operation *, std::pair<int, Operation *>>
 loadOpsToIndirectionLevel(scf::ForOp forOp, bool pipelineWithoutDot,
                           triton::ModuleAxisInfoAnalysis &axisInfoAnalysis,
@@ -173,6 +176,11 @@ private:
 // the same stage and ordering cluster as the anchor op.
 void scheduleDependencies(scf::ForOp forOp, CoarseSchedule &schedule);
 
+// Schedule the ops that were added to an outer loop body after the loop was
+// scheduled, e.g. the buffers and the prologue of a nested loop's own pipeline,
+// to the stage and ordering cluster of the nested loop they belong to.
+void scheduleOpsAroundNestedLoops(scf::ForOp forOp, CoarseSchedule &schedule);
+
 class OpBuilderForStage : public mlir::ImplicitLocOpBuilder,
                           public OpBuilder::Listener {
 public:
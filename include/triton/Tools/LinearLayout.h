@@ -313,23 +313,34 @@ namespace mlir::triton {
 //  - CuTe requires a CUDA compiler such as nvcc; LLs do not.
 //
 class LinearLayout {
-private:
+public:
   // bases[inDim][i] = L(0, ..., inDim=2^i, ..., 0).  All other values of L are
   // computed by xor'ing bases together, using the linearity rule.  In addition:
   //
   // - Each inDim has the same set of outDims, in the same order.
   // - The order of dims is minor-to-major, although this only affects reshape.
-  llvm::MapVector<StringAttr /*inDim*/,
-                  std::vector<std::vector<int32_t> /*size=getNumOutDims()*/>
-                  /*size=getInDimSizeLog2(inDim)*/>
-      bases;
+  using BasesT = llvm::MapVector<
+      StringAttr /*inDim*/,
+      std::vector<std::vector<int32_t> /*size=getNumOutDims()*/>
+      /*size=getInDimSizeLog2(inDim)*/>;
 
+private:
+  llvm::MapVector<StringAttr, int32_t /*sizeLog2*/> inDims;
   llvm::MapVector<StringAttr, int32_t /*size*/> outDims;
   int32_t rank = 0;
 
-public:
-  using BasesT = decltype(bases);
+  // The bases, stored as the columns of one GF(2) matrix.  Column c is the
+  // c'th basis counting across all inDims in order.  It packs the coordinates
+  // of all outDims, the first outDim in the least significant bits, into
+  // getNumBasisWords() consecutive words, which is a single word unless the
+  // outDims have more than 64 bits in total.
+  llvm::SmallVector<uint64_t> flatBases;
+
+  // The same bases unpacked once per layout, see BasesT.  These back
+  // getBases() and getBasis(), so that reading a basis never allocates.
+  BasesT bases;
 
+public:
   LinearLayout() = default;
 
   // The 0-dimensional layout that maps everything to 0.  This is useful as a
@@ -361,7 +372,7 @@ public:
                               int32_t outDimSize = 1);
 
   // Creates a LinearLayout from a list of bases.  These are interpreted
-  // according to the rules written for the member variable `bases`.
+  // according to the rules written for BasesT.
   //
   // Calculates the out-dim sizes according to the bases.  Consider the
   // following example.
@@ -434,6 +445,11 @@ public:
 
   const BasesT &getBases() const { return bases; }
 
+  // The bases as columns of a GF(2) matrix with one bit per out-dim bit; see
+  // `flatBases`.
+  ArrayRef<uint64_t> getFlatBases() const { return flatBases; }
+  int32_t getNumBasisWords() const;
+
   // Get the pos'th basis vector for the inDim -> outDim mapping.
   // getBasis(inDim, pos) = L(0, ..., inDim = 2^pos, ..., 0).
   ArrayRef<int32_t> getBasis(StringAttr inDim, int32_t pos) const {
@@ -443,14 +459,11 @@ public:
     assert(static_cast<size_t>(pos) < it->second.size());
     return it->second[pos];
   }
-
-  int32_t getBasis(StringAttr inDim, int32_t pos, StringAttr outDim) const {
-    return getBasis(inDim, pos)[getOutDimIndex(outDim)];
-  }
+  int32_t getBasis(StringAttr inDim, int32_t pos, StringAttr outDim) const;
 
   // These are in minor-to-major order, although if you don't flatten the dims
   // (e.g. by reshaping) then the order doesn't really affect anything.
-  auto getInDimNames() const { return llvm::make_first_range(bases); }
+  auto getInDimNames() const { return llvm::make_first_range(inDims); }
   auto getOutDimNames() const { return llvm::make_first_range(outDims); }
   auto getOutDimSizes() const { return llvm::make_second_range(outDims); }
 
@@ -463,10 +476,10 @@ public:
   // if the dim is not present.
   int32_t getOutDimIndex(StringAttr outDim) const;
 
-  bool hasInDim(StringAttr inDim) const { return bases.contains(inDim); }
+  bool hasInDim(StringAttr inDim) const { return inDims.contains(inDim); }
   bool hasOutDim(StringAttr outDim) const { return outDims.contains(outDim); }
 
-  int32_t getNumInDims() const { return bases.size(); }
+  int32_t getNumInDims() const { return inDims.size(); }
   int32_t getNumOutDims() const { return outDims.size(); }
 
   // Asserts if the dimension is not present.
@@ -770,13 +783,28 @@ private:
   tryCreate(BasesT bases, ArrayRef<std::pair<StringAttr, int32_t>> outDims,
             bool requireSurjective);
 
-  // Constructor that does not check invariants.  Used by tryCreate.
-  struct NoCheckInvariants {};
-  LinearLayout(BasesT bases, ArrayRef<std::pair<StringAttr, int32_t>> outDims,
-               NoCheckInvariants);
+  // Creates a layout from its flat bases, see `flatBases`.  The columns must
+  // be packed according to `outDims`.
+  LinearLayout(llvm::MapVector<StringAttr, int32_t> inDimSizesLog2,
+               ArrayRef<std::pair<StringAttr, int32_t>> outDims,
+               SmallVector<uint64_t> flatBases, bool requireSurjective);
 
+  // Checks `bases` against the out-dims, which must already be set, and packs
+  // them into this layout.
   [[nodiscard]] std::optional<std::string>
-  checkInvariants(bool requireSurjective);
+  initialize(BasesT bases, bool requireSurjective);
+
+  // Unpacks `flatBases` into `bases`.
+  void unpackBases();
+
+  // Index of the first column of `inDim` in `flatBases`.
+  int32_t getFirstColumn(StringAttr inDim) const;
+  // Position of the first bit of `outDim` in a column.
+  int32_t getOutDimOffset(StringAttr outDim) const;
+
+  // Returns X such that A * X = B, setting the free variables of X to zero.
+  // Requires the image of B to be contained in the image of A.
+  static LinearLayout lstsq(const LinearLayout &A, const LinearLayout &B);
 };
 
 inline llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
@@ -44,6 +44,10 @@ inline const std::set<std::string> CACHE_INVALIDATING_ENV_VARS = {
     "ALLOW_LHS_TMEM_LAYOUT_CONVERSION",
     "TRITON_F32_DEFAULT",
     "TRITON_PREFER_TMEM_16x256_LAYOUT",
+    "TRITON_SMEM_BEST_FIT",
+    "TRITON_LAYOUT_COST_MODEL",
+    "TRITON_MODULO_SCHEDULE",
+    "TRITON_PROTON_RECORD_SLOTS",
     // clang-format on
 };
 
@@ -10,8 +10,8 @@
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
-#include "triton/Tools/GenericSwizzling.h"
 #include "triton/Tools/LayoutUtils.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -29,25 +29,13 @@ namespace mlir {
 //===----------------------------------------------------------------------===//
 namespace triton {
 
-// Bitwidth of pointers
-constexpr int kPtrBitWidth = 64;
 // Max shmem LDS/STS instruction in bits
 constexpr int kMaxShmemVecBitLength = 128;
 
-static unsigned getBitwidth(RankedTensorType ty) {
-  auto isPtr = isa<PointerType>(ty.getElementType());
-  return isPtr ? kPtrBitWidth : std::max(ty.getElementTypeBitWidth(), 8u);
-}
-
 static unsigned getNumScratchElemsSwizzledCvt(RankedTensorType srcTy,
                                               RankedTensorType dstTy) {
   auto *ctx = srcTy.getContext();
-  auto srcLayout = gpu::toLinearLayout(srcTy);
-  auto dstLayout = gpu::toLinearLayout(dstTy);
-  srcLayout = actionRemoveBroadcastedRegs(srcLayout).apply(srcLayout);
-  dstLayout = actionRemoveBroadcastedRegs(dstLayout).apply(dstLayout);
-  auto bitwidth = getBitwidth(srcTy);
-  auto smem = gpu::optimalSwizzling(srcLayout, dstLayout, bitwidth);
+  const auto &smem = getConvertLayoutPlan(srcTy, dstTy)->sharedLayout;
   auto reps = smem.getInDimSize(StringAttr::get(ctx, "reps"));
   return smem.getTotalOutDimSize() / reps;
 }
@@ -161,8 +149,8 @@ ScratchConfig getScratchConfigForCvt(RankedTensorType srcTy,
   scratchConfig.outVec = std::min(scratchConfig.outVec, contiguousShapeDim);
   // Clamp the vector length to kMaxShmemVecBitLength / element bitwidth as this
   // is the max vectorisation
-  auto inBitWidth = getBitwidth(srcTy);
-  auto outBitWidth = getBitwidth(dstTy);
+  auto inBitWidth = getConvertLayoutBitwidth(srcTy);
+  auto outBitWidth = getConvertLayoutBitwidth(dstTy);
   scratchConfig.inVec =
       std::min(scratchConfig.inVec, kMaxShmemVecBitLength / inBitWidth);
   scratchConfig.outVec =
@@ -196,7 +184,7 @@ unsigned defaultAllocationAnalysisScratchSizeFn(Operation *op) {
     int threadsPerWarp = gpu::TritonGPUDialect::getThreadsPerWarp(
         op->getParentOfType<ModuleOp>());
     return std::max<int>(dstTy.getNumElements(), threadsPerWarp) *
-           getBitwidth(dstTy) / 8;
+           getConvertLayoutBitwidth(dstTy) / 8;
   }
   if (auto cvtLayout = dyn_cast<gpu::ConvertLayoutOp>(op)) {
     auto srcTy = cvtLayout.getSrc().getType();
@@ -207,7 +195,7 @@ unsigned defaultAllocationAnalysisScratchSizeFn(Operation *op) {
     auto elems = std::max(getNumScratchElemsSwizzledCvt(srcTy, dstTy),
                           getNumScratchElemsPaddedCvt(srcTy, dstTy));
 
-    return elems * getBitwidth(srcTy) / 8;
+    return elems * getConvertLayoutBitwidth(srcTy) / 8;
   }
   if (isa<AtomicRMWOp, AtomicCASOp>(op)) {
     auto value = op->getOperand(0);
@@ -229,14 +217,22 @@ unsigned defaultAllocationAnalysisScratchSizeFn(Operation *op) {
   return 0;
 }
 
+AllocationPolicy getDefaultAllocationPolicy() {
+  return tools::getBoolEnv("TRITON_SMEM_BEST_FIT")
+             ? AllocationPolicy::BestFit
+             : AllocationPolicy::GraphColoring;
+}
+
 class AllocationAnalysis {
 public:
   AllocationAnalysis(Operation *operation,
                      Allocation::FuncAllocMapT *funcAllocMap,
                      Allocation *allocation,
-                     AllocationAnalysisScratchSizeFn scratchSizeGetter)
+                     AllocationAnalysisScratchSizeFn scratchSizeGetter,
+                     AllocationPolicy policy)
       : operation(operation), funcAllocMap(funcAllocMap),
-        allocation(allocation), scratchSizeGetter(scratchSizeGetter) {
+        allocation(allocation), scratchSizeGetter(scratchSizeGetter),
+        policy(policy) {
     run();
   }
 
@@ -248,6 +244,9 @@ private:
   using BufferRangeMapT = llvm::MapVector<BufferT *, Interval<size_t>>;
   /// Nodes -> Nodes
   using GraphT = DenseMap<BufferT *, DenseSet<BufferT *>>;
+  /// Nodes -> Nodes that may not share bytes with them, in a deterministic
+  /// order.
+  using ConflictMapT = DenseMap<BufferT *, llvm::SetVector<BufferT *>>;
 
   void run() {
     getValuesAndSizes();
@@ -542,16 +541,79 @@ private:
     // that we regroup the buffers and color them again. Since we always
     // increase the buffer offset and keep reducing conflicts, we will
     // eventually reach a fixed point.
+    // Liveness ranges do not change while offsets are bumped, so the conflicts
+    // are computed once and each round only revisits the edges of buffers
+    // whose offset moved.
+    buildConflicts(buffers);
     GraphT interference;
     buildInterferenceGraph(buffers, interference);
     do {
-      allocate(buffers, interference);
-      buildInterferenceGraph(buffers, interference);
+      auto moved = allocate(buffers, interference);
+      updateInterferenceGraph(moved, interference);
     } while (!interference.empty());
 
+    if (policy == AllocationPolicy::BestFit)
+      packBestFit(buffers);
+
     LLVM_DEBUG(dumpAllocationSize());
   }
 
+  /// Re-assigns offsets with a best-fit placement over liveness intervals.
+  /// Buffers are visited in descending size order. Each one is placed in the
+  /// smallest gap left between the already placed buffers it interferes with,
+  /// measured from its aligned start, or right after the highest of them if no
+  /// gap is large enough. Unlike the coloring, a buffer is never bumped past
+  /// buffers it does not interfere with. The coloring offsets are restored if
+  /// they are not larger.
+  void packBestFit(const SmallVector<BufferT *> &buffers) {
+    size_t coloringSize = allocation->sharedMemorySize;
+    SmallVector<size_t> coloringOffsets;
+    for (auto *x : buffers)
+      coloringOffsets.push_back(x->offset);
+
+    size_t bestFitSize = 0;
+    SmallPtrSet<BufferT *, 16> placed;
+    SmallVector<BufferT *> neighbors;
+    for (auto *x : buffers) {
+      neighbors.clear();
+      for (auto *y : conflicts.lookup(x)) {
+        if (placed.contains(y))
+          neighbors.push_back(y);
+      }
+      llvm::stable_sort(neighbors, [](BufferT *A, BufferT *B) {
+        return A->offset < B->offset;
+      });
+      size_t cursor = 0;
+      size_t bestGap = std::numeric_limits<size_t>::max();
+      std::optional<size_t> bestOffset;
+      for (auto *y : neighbors) {
+        size_t start = llvm::alignTo(cursor, x->alignment);
+        if (start + x->size <= y->offset && y->offset - start < bestGap) {
+          bestGap = y->offset - start;
+          bestOffset = start;
+        }
+        cursor = std::max(cursor, y->offset + y->size);
+      }
+      if (bestOffset)
+        x->offset = *bestOffset;
+      else
+        x->setOffsetAligned(cursor);
+      placed.insert(x);
+      bestFitSize = std::max(bestFitSize, x->offset + x->size);
+    }
+
+    LDBG("best-fit size: " << bestFitSize
+                           << ", graph coloring size: " << coloringSize);
+    if (bestFitSize >= coloringSize) {
+      for (auto [x, offset] : llvm::zip(buffers, coloringOffsets))
+        x->offset = offset;
+      return;
+    }
+    allocation->sharedMemorySize = bestFitSize;
+    allocation->sharedMemorySizeSaved = coloringSize - bestFitSize;
+    LLVM_DEBUG(dumpBuffers());
+  }
+
   /// Computes the initial shared memory offsets.
   void calculateStarts(const SmallVector<BufferT *> &buffers) {
     //  v = values in shared memory
@@ -613,41 +675,92 @@ private:
     LLVM_DEBUG(dumpBuffers());
   }
 
+  /// Computes, for every buffer, the buffers it may not share bytes with,
+  /// regardless of their current offsets.
+  void buildConflicts(const SmallVector<BufferT *> &buffers) {
+    conflicts.clear();
+    auto addConflict = [&](BufferT *x, BufferT *y) {
+      conflicts[x].insert(y);
+      conflicts[y].insert(x);
+    };
+
+    // Buffers interfere if they are live at the same time. Sweep over the
+    // liveness starts while keeping the buffers that are still live ordered
+    // by liveness end, so that only overlapping pairs are visited.
+    SmallVector<BufferT *> byStart(buffers.begin(), buffers.end());
+    llvm::stable_sort(byStart, [&](BufferT *A, BufferT *B) {
+      return bufferRange.lookup(A).start() < bufferRange.lookup(B).start();
+    });
+    std::multimap<size_t, BufferT *> live;
+    for (auto *x : byStart) {
+      auto xRange = bufferRange.lookup(x);
+      live.erase(live.begin(), live.upper_bound(xRange.start()));
+      for (auto [end, y] : live) {
+        if (xRange.intersects(bufferRange.lookup(y)))
+          addConflict(x, y);
+      }
+      live.insert({xRange.end(), x});
+    }
+
+    // Buffers also interfere if they exist within regions that may execute
+    // simultaneously with respect to each other.
+    llvm::MapVector<Operation *, SmallVector<BufferT *>> asyncBuffers;
+    for (auto *x : buffers) {
+      if (auto *ws = x->owner->getParentWithTrait<OpTrait::AsyncRegions>())
+        asyncBuffers[ws].push_back(x);
+    }
+    for (auto &[ws, group] : asyncBuffers) {
+      for (auto [i, x] : llvm::enumerate(group)) {
+        for (auto *y : ArrayRef(group).drop_front(i + 1)) {
+          if (x->owner->getParentRegion() != y->owner->getParentRegion())
+            addConflict(x, y);
+        }
+      }
+    }
+  }
+
+  static bool overlaps(BufferT *x, BufferT *y) {
+    return x->offset < y->offset + y->size && y->offset < x->offset + x->size;
+  }
+
   /// Builds a graph of all shared memory values. Edges are created between
-  /// shared memory values that are overlapping.
+  /// conflicting shared memory values that are overlapping.
   void buildInterferenceGraph(const SmallVector<BufferT *> &buffers,
                               GraphT &interference) {
     // Reset interference graph
     interference.clear();
-    for (auto x : buffers) {
-      for (auto y : buffers) {
-        if (x == y)
-          continue;
-        auto xStart = x->offset;
-        auto yStart = y->offset;
-        auto xSize = x->size;
-        auto ySize = y->size;
-        Interval xSizeRange = {xStart, xStart + xSize};
-        Interval ySizeRange = {yStart, yStart + ySize};
-        auto xOpRange = bufferRange.lookup(x);
-        auto yOpRange = bufferRange.lookup(y);
-
-        // Buffers interfere if their allocation offsets overlap and they are
-        // live at the same time.
-        if (xOpRange.intersects(yOpRange) &&
-            xSizeRange.intersects(ySizeRange)) {
+    for (auto *x : buffers) {
+      for (auto *y : conflicts.lookup(x)) {
+        if (overlaps(x, y))
           interference[x].insert(y);
-        }
+      }
+    }
+
+    LLVM_DEBUG(dumpInterferenceGraph(interference));
+  }
 
-        // Buffers also interfere if their allocation offsets overlap and they
-        // exist within regions that may execute simultaneously with respect to
-        // each other.
-        auto wsx = x->owner->getParentWithTrait<OpTrait::AsyncRegions>();
-        auto wsy = y->owner->getParentWithTrait<OpTrait::AsyncRegions>();
-        if (wsx && wsy && wsx == wsy &&
-            x->owner->getParentRegion() != y->owner->getParentRegion() &&
-            xSizeRange.intersects(ySizeRange)) {
+  /// Recomputes the edges of the buffers in `moved` after their offsets have
+  /// changed. Edges between two buffers that did not move stay valid.
+  void updateInterferenceGraph(ArrayRef<BufferT *> moved,
+                               GraphT &interference) {
+    auto eraseEdge = [&](BufferT *x, BufferT *y) {
+      auto it = interference.find(x);
+      if (it == interference.end())
+        return;
+      it->second.erase(y);
+      if (it->second.empty())
+        interference.erase(it);
+    };
+    for (auto *x : moved) {
+      if (auto it = interference.find(x); it != interference.end()) {
+        for (auto *y : it->second)
+          eraseEdge(y, x);
+        interference.erase(x);
+      }
+      for (auto *y : conflicts.lookup(x)) {
+        if (overlaps(x, y)) {
           interference[x].insert(y);
+          interference[y].insert(x);
         }
       }
     }
@@ -655,9 +768,10 @@ private:
     LLVM_DEBUG(dumpInterferenceGraph(interference));
   }
 
-  /// Finalizes shared memory offsets considering interference.
-  void allocate(const SmallVector<BufferT *> &buffers,
-                const GraphT &interference) {
+  /// Finalizes shared memory offsets considering interference. Returns the
+  /// buffers whose offset changed.
+  SmallVector<BufferT *> allocate(const SmallVector<BufferT *> &buffers,
+                                  const GraphT &interference) {
     // Reset shared memory size
     allocation->sharedMemorySize = 0;
     // First-fit graph coloring
@@ -669,17 +783,22 @@ private:
     for (auto value : buffers) {
       colors[value] = (value == buffers[0]) ? 0 : -1;
     }
-    SmallVector<bool> available(buffers.size());
+    // A node with N neighbors always finds a color in [0, N].
+    SmallVector<bool> available;
     for (auto x : buffers) {
-      std::fill(available.begin(), available.end(), true);
-      for (auto y : interference.lookup(x)) {
+      auto it = interference.find(x);
+      if (it == interference.end()) {
+        colors[x] = 0;
+        continue;
+      }
+      available.assign(it->second.size() + 1, true);
+      for (auto y : it->second) {
         int color = colors[y];
-        if (color >= 0) {
+        if (color >= 0 && static_cast<size_t>(color) < available.size()) {
           available[color] = false;
         }
       }
-      auto it = std::find(available.begin(), available.end(), true);
-      colors[x] = std::distance(available.begin(), it);
+      colors[x] = std::distance(available.begin(), llvm::find(available, true));
       LLVM_DEBUG({
         llvm::dbgs() << "-- color " << x->id << " " << colors[x] << "\n";
       });
@@ -690,17 +809,22 @@ private:
     // color2: [8, 12) -> [8 + 2 * 15, 12 + 2 * 15) -> [38, 42)
     // TODO(Keren): We are wasting memory here.
     // Nodes with color2 can actually start with 24.
+    SmallVector<BufferT *> moved;
     for (auto x : buffers) {
       size_t newOffset = 0;
       for (auto y : interference.lookup(x)) {
         newOffset = std::max(newOffset, y->offset + y->size);
       }
-      if (colors.lookup(x) != 0)
-        x->setOffsetAligned(newOffset);
+      if (colors.lookup(x) != 0) {
+        size_t oldOffset = x->offset;
+        if (x->setOffsetAligned(newOffset) != oldOffset)
+          moved.push_back(x);
+      }
       allocation->sharedMemorySize =
           std::max(allocation->sharedMemorySize, x->offset + x->size);
     }
     LLVM_DEBUG(dumpBuffers());
+    return moved;
   }
 
 private:
@@ -708,16 +832,19 @@ private:
   Allocation::FuncAllocMapT *funcAllocMap;
   Allocation *allocation;
   BufferRangeMapT bufferRange;
+  ConflictMapT conflicts;
   AllocationAnalysisScratchSizeFn scratchSizeGetter;
+  AllocationPolicy policy;
 };
 
 } // namespace triton
 
 void Allocation::run(
     FuncAllocMapT &funcAllocMap,
-    triton::AllocationAnalysisScratchSizeFn scratchSizeGetter) {
+    triton::AllocationAnalysisScratchSizeFn scratchSizeGetter,
+    triton::AllocationPolicy policy) {
   triton::AllocationAnalysis(getOperation(), &funcAllocMap, this,
-                             scratchSizeGetter);
+                             scratchSizeGetter, policy);
 }
 
 std::map<Operation *, SmallVector<Allocation::BufferId>>
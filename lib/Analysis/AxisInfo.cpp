@@ -7,6 +7,8 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <atomic>
+
 #define DEBUG_TYPE "axis-info"
 #define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
 #define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
@@ -1307,6 +1309,10 @@ unsigned ModuleAxisInfoAnalysis::getMaskAlignment(Value mask) {
   return alignment;
 }
 
+static std::atomic<uint64_t> numSolverRuns{0};
+
+uint64_t ModuleAxisInfoAnalysis::getNumSolverRuns() { return numSolverRuns; }
+
 void ModuleAxisInfoAnalysis::initialize(FunctionOpInterface funcOp,
                                         axisinfo::CallbackType callback) {
   std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
@@ -1315,8 +1321,10 @@ void ModuleAxisInfoAnalysis::initialize(FunctionOpInterface funcOp,
   // regions.
   WalkResult result =
       funcOp.walk<mlir::WalkOrder::PreOrder>([&](Operation *op) {
-        if (op->hasTrait<OpTrait::IsIsolatedFromAbove>() &&
-            failed(solver->initializeAndRun(op)))
+        if (!op->hasTrait<OpTrait::IsIsolatedFromAbove>())
+          return WalkResult::advance();
+        ++numSolverRuns;
+        if (failed(solver->initializeAndRun(op)))
           return WalkResult::interrupt();
         return WalkResult::advance();
       });
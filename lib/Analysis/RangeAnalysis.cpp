@@ -1,4 +1,4 @@
-#include "third_party/amd/include/Analysis/RangeAnalysis.h"
+#include "triton/Analysis/RangeAnalysis.h"
 #include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
 #include "mlir/Analysis/DataFlow/IntegerRangeAnalysis.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -14,7 +14,7 @@
 #include <optional>
 
 #undef DEBUG_TYPE
-#define DEBUG_TYPE "tritonamdgpu-range-analysis"
+#define DEBUG_TYPE "triton-range-analysis"
 #define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
 #define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
 
@@ -23,7 +23,7 @@ using namespace mlir;
 namespace tt = mlir::triton;
 
 std::optional<int64_t>
-triton::AMD::TritonIntegerRangeAnalysis::maybeGetTripCount(
+triton::TritonIntegerRangeAnalysis::maybeGetTripCount(
     LoopLikeOpInterface loop) {
   std::optional<OpFoldResult> lowerBound = loop.getSingleLowerBound();
   std::optional<OpFoldResult> upperBound = loop.getSingleUpperBound();
@@ -87,7 +87,6 @@ triton::AMD::TritonIntegerRangeAnalysis::maybeGetTripCount(
 namespace {
 
 constexpr int64_t kDefaultMaxTripCount = 1024;
-constexpr int64_t kDefaultMaxPrograms = 2 << 15; // 65536
 
 void getEnclosingLoops(Operation &op, SmallVector<LoopLikeOpInterface> &ops) {
   Operation *currOp = op.getParentOp();
@@ -244,7 +243,7 @@ std::optional<ConstantIntRanges> maybeGetAssumedRange(Operation *assumption,
 
 } // namespace
 
-namespace mlir::triton::AMD {
+namespace mlir::triton {
 
 bool isEmptyInitializedRange(ConstantIntRanges rv) {
   if (!rv.umin().getBitWidth() || !rv.umax().getBitWidth() ||
@@ -386,10 +385,10 @@ LogicalResult TritonIntegerRangeAnalysis::visitOperation(
           op)) {
     llvm::TypeSwitch<Operation *>(op)
         .Case<GetProgramIdOp>([&](auto getPIDOp) {
-          inferResultRangesPID(getPIDOp, kDefaultMaxPrograms - 1, joinCallback);
+          inferResultRangesPID(getPIDOp, maxNumPrograms - 1, joinCallback);
         })
         .Case<GetNumProgramsOp>([&](auto getPIDOp) {
-          inferResultRangesPID(getPIDOp, kDefaultMaxPrograms, joinCallback);
+          inferResultRangesPID(getPIDOp, maxNumPrograms, joinCallback);
         })
         .Case<MakeRangeOp>([&](MakeRangeOp makeROp) {
           inferResultRanges(&makeROp, joinCallback);
@@ -623,10 +622,10 @@ void populateFoldTrueCmpIOpPatterns(RewritePatternSet &patterns,
 }
 
 void initializeFuncOps(Operation *op,
-                       AMD::TritonIntegerRangeAnalysis *rangeAnalysis) {
+                       TritonIntegerRangeAnalysis *rangeAnalysis) {
   op->walk<WalkOrder::PreOrder>([&rangeAnalysis](FuncOp funcOp) {
     rangeAnalysis->initializeFuncOp(funcOp);
   });
 }
 
-} // namespace mlir::triton::AMD
+} // namespace mlir::triton
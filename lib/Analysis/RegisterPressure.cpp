@@ -0,0 +1,88 @@
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Dialect/Triton/IR/Types.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "llvm/ADT/DenseSet.h"
+
+namespace mlir::triton {
+
+unsigned getNumI32RegsPerThread(Type type) {
+  auto tensorTy = dyn_cast<RankedTensorType>(type);
+  if (!tensorTy || !tensorTy.getEncoding())
+    return 0;
+  Type elTy = tensorTy.getElementType();
+  unsigned bitWidth =
+      isa<PointerType>(elTy) ? 64 : elTy.getIntOrFloatBitWidth();
+  uint64_t bits = uint64_t(gpu::getTotalElemsPerThread(type)) * bitWidth;
+  return llvm::divideCeil(bits, 32);
+}
+
+RegisterPressureAnalysis::RegisterPressureAnalysis(Operation *root)
+    : root(root), liveness(root) {
+  root->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    if (op != root)
+      pressure[op] = computePressure(op);
+  });
+}
+
+unsigned
+RegisterPressureAnalysis::getLiveValues(Operation *op,
+                                        SmallVectorImpl<Value> &across) const {
+  unsigned consumed = 0;
+  const LivenessBlockInfo *blockInfo = liveness.getLiveness(op->getBlock());
+  for (Value value : blockInfo->currentlyLiveValues(op)) {
+    if (value.getDefiningOp() == op)
+      continue;
+    if (liveness.isDeadAfter(value, op))
+      consumed += getNumI32RegsPerThread(value.getType());
+    else
+      across.push_back(value);
+  }
+  return consumed;
+}
+
+unsigned RegisterPressureAnalysis::computePressure(Operation *op) {
+  SmallVector<Value> across;
+  unsigned consumed = getLiveValues(op, across);
+  if (op->getNumRegions() != 0)
+    liveAcross[op] = across;
+  unsigned produced = 0;
+  for (Type type : op->getResultTypes())
+    produced += getNumI32RegsPerThread(type);
+
+  // The values live across the parent ops stay live in their regions, unless
+  // the parent is isolated from above, e.g. a warp specialized partition that
+  // runs on other warps. Liveness only tracks the values used in a block, so
+  // the ones that are only used after the parent are added here.
+  DenseSet<Value> seen(across.begin(), across.end());
+  for (Operation *parent = op->getParentOp();
+       parent && parent != root &&
+       !parent->hasTrait<OpTrait::IsIsolatedFromAbove>();
+       parent = parent->getParentOp()) {
+    // Parents are visited before the ops nested in them.
+    for (Value value : liveAcross.lookup(parent)) {
+      if (seen.insert(value).second)
+        across.push_back(value);
+    }
+  }
+
+  unsigned regs = std::max(consumed, produced);
+  for (Value value : across)
+    regs += getNumI32RegsPerThread(value.getType());
+  return regs;
+}
+
+unsigned RegisterPressureAnalysis::getMaxPressure(Region &region) const {
+  unsigned maxRegs = 0;
+  region.walk(
+      [&](Operation *op) { maxRegs = std::max(maxRegs, getPressure(op)); });
+  return maxRegs;
+}
+
+unsigned RegisterPressureAnalysis::getMaxPressure() const {
+  unsigned maxRegs = 0;
+  for (auto &[op, regs] : pressure)
+    maxRegs = std::max(maxRegs, regs);
+  return maxRegs;
+}
+
+} // namespace mlir::triton
@@ -1,5 +1,6 @@
 #include "triton/Analysis/Utility.h"
 
+#include <algorithm>
 #include <deque>
 
 #include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
@@ -13,6 +14,7 @@
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+#include "triton/Tools/GenericSwizzling.h"
 #include "triton/Tools/LayoutUtils.h"
 #include "triton/Tools/LinearLayout.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
@@ -758,8 +760,10 @@ bool matchMFMAAndDotOperandShuffleCase(RankedTensorType srcTy,
 LinearLayout minimalCvtLayout(Type srcTy_, Type dstTy_) {
   auto srcTy = cast<triton::gpu::TensorOrMemDesc>(srcTy_);
   auto dstTy = cast<triton::gpu::TensorOrMemDesc>(dstTy_);
-  LinearLayout srcLayout = toLinearLayout(srcTy);
-  LinearLayout dstLayout = toLinearLayout(dstTy);
+  auto srcHandle = getCachedLinearLayout(srcTy);
+  auto dstHandle = getCachedLinearLayout(dstTy);
+  const LinearLayout &srcLayout = *srcHandle;
+  const LinearLayout &dstLayout = *dstHandle;
   auto sDims = to_vector(srcLayout.getInDimNames());
   auto dDims = to_vector(dstLayout.getInDimNames());
   SmallVector<StringAttr> dims;
@@ -784,25 +788,127 @@ LinearLayout minimalCvtLayout(Type srcTy_, Type dstTy_) {
   return comp;
 }
 
-bool cvtReordersRegisters(RankedTensorType srcTy, RankedTensorType dstTy) {
-  auto layout = minimalCvtLayout(srcTy, dstTy);
-  MLIRContext *ctx = srcTy.getContext();
-  auto kRegister = StringAttr::get(ctx, "register");
-  auto outDims = to_vector(layout.getOutDimNames());
-  return outDims.empty() || ArrayRef(outDims) == ArrayRef({kRegister});
+unsigned getConvertLayoutBitwidth(RankedTensorType ty) {
+  if (isa<PointerType>(ty.getElementType()))
+    return 64;
+  return std::max(ty.getElementTypeBitWidth(), 8u);
 }
 
-bool cvtNeedsWarpShuffle(RankedTensorType srcTy, RankedTensorType dstTy) {
-  auto layout = minimalCvtLayout(srcTy, dstTy);
+// The register, lane and warp part of `ty`'s layout without broadcasting in
+// registers, as staged through shared memory by the lowering.
+static LinearLayout getStagedLayout(RankedTensorType ty) {
+  MLIRContext *ctx = ty.getContext();
+  auto cached = getCachedLinearLayout(ty.getShape(), ty.getEncoding(), {});
+  auto layout = cached->sublayout({StringAttr::get(ctx, "register"),
+                                   StringAttr::get(ctx, "lane"),
+                                   StringAttr::get(ctx, "warp")},
+                                  to_vector(cached->getOutDimNames()));
+  return actionRemoveBroadcastedRegs(layout).apply(layout);
+}
+
+// Returns true if a warp-local conversion is cheaper with the shuffles of
+// `plan` than through its shared memory layout. Costs are counted in quarters
+// of a shared memory wavefront: a shuffle takes one wavefront, and a select
+// issues four times as fast. A shared memory access takes a wavefront per 32
+// bits of every lane, replayed once per bank conflict, and the round trip
+// needs a barrier before the loads and one before the next stores.
+static bool isWarpShuffleCheaper(const ConvertLayoutPlan &plan,
+                                 const LinearLayout &srcLayout,
+                                 const LinearLayout &dstLayout,
+                                 unsigned bitwidth) {
+  constexpr int64_t kBarrierCost = 4 * 16;
+  MLIRContext *ctx = srcLayout.getInDimNames().begin()->getContext();
+  StringAttr kReg = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+
+  // Mirrors the packing of `transferWithinWarp`: elements that stay in their
+  // lane are packed into 32-bit registers and 64-bit elements are split.
+  int m = plan.mixedTranspositions.size();
+  int nReg = plan.pReg.getTotalInDimSizeLog2();
+  int nPackPrelim = llvm::Log2_32(std::clamp<int>(32 / bitwidth, 1, 4));
+  int nPack = std::min(nPackPrelim, nReg - m);
+  int64_t numRegs = (int64_t(1) << (nReg - nPack)) * ((bitwidth + 31) / 32);
+  bool pLaneIsTrivial = squareSublayoutIsIdentity(plan.pLane, kLane);
+  int64_t shuffles, selects;
+  if (m == 1 && pLaneIsTrivial) {
+    shuffles = numRegs / 2;
+    selects = 3 * numRegs / 2;
+  } else {
+    shuffles = pLaneIsTrivial ? numRegs - (numRegs >> m) : numRegs;
+    selects = 2 * m * numRegs;
+  }
+  int64_t shuffleCost = 4 * shuffles + selects;
+
+  const LinearLayout &smem = plan.sharedLayout;
+  int32_t vec = smem.getInDimSize(StringAttr::get(ctx, "vector"));
+  int32_t nReps = smem.getInDimSize(StringAttr::get(ctx, "reps"));
+  int64_t wavefronts = std::max<int64_t>(1, vec * bitwidth / 32);
+  int64_t stores = srcLayout.getInDimSize(kReg) / vec * wavefronts
+                   << plan.writeBankConflicts;
+  int64_t loads = dstLayout.getInDimSize(kReg) / vec * wavefronts
+                  << plan.readBankConflicts;
+  int64_t sharedCost = 4 * (stores + loads) + 2 * nReps * kBarrierCost;
+  return shuffleCost <= sharedCost;
+}
+
+std::shared_ptr<const ConvertLayoutPlan>
+getConvertLayoutPlan(RankedTensorType srcTy, RankedTensorType dstTy) {
   MLIRContext *ctx = srcTy.getContext();
-  auto kRegister = StringAttr::get(ctx, "register");
-  auto kLane = StringAttr::get(ctx, "lane");
-  if (to_vector(layout.getOutDimNames()) ==
-      SmallVector<StringAttr, 2>{kRegister, kLane}) {
-    auto factors = getWarpLayoutConvertDecomposition(srcTy, dstTy);
-    return (factors.mixedTranspositions.size() < 2);
+  auto *dialect = ctx->getLoadedDialect<TritonGPUDialect>();
+  unsigned bitwidth = getConvertLayoutBitwidth(srcTy);
+  auto shape = srcTy.getShape();
+  ConvertLayoutPlanKey key{std::vector<int64_t>(shape.begin(), shape.end()),
+                           srcTy.getEncoding(), dstTy.getEncoding(), bitwidth};
+  auto &cache = dialect->getConvertLayoutPlanCache();
+  if (auto plan = cache.get(key))
+    return plan;
+
+  ConvertLayoutPlan plan;
+  plan.conversion = minimalCvtLayout(srcTy, dstTy);
+  auto dims = to_vector(plan.conversion.getInDimNames());
+  auto hasDim = [&](StringRef name) {
+    return llvm::is_contained(dims, StringAttr::get(ctx, name));
+  };
+  if (hasDim("block"))
+    plan.strategy = ConvertLayoutStrategy::DistributedSharedMemory;
+  else if (hasDim("warp") || hasDim("lane"))
+    plan.strategy = ConvertLayoutStrategy::SharedMemory;
+  else if (hasDim("register"))
+    plan.strategy = ConvertLayoutStrategy::RegisterPermutation;
+
+  if (plan.strategy >= ConvertLayoutStrategy::SharedMemory) {
+    auto srcLayout = getStagedLayout(srcTy);
+    auto dstLayout = getStagedLayout(dstTy);
+    plan.sharedLayout = optimalSwizzling(srcLayout, dstLayout, bitwidth);
+    std::tie(plan.readBankConflicts, plan.writeBankConflicts) =
+        logBankConflicts(srcLayout, dstLayout, plan.sharedLayout, bitwidth);
+    // Shuffles only move data within a warp, never across CTAs.
+    if (plan.strategy == ConvertLayoutStrategy::SharedMemory &&
+        !hasDim("warp") && hasDim("lane")) {
+      auto factors = getWarpLayoutConvertDecomposition(srcTy, dstTy);
+      plan.pReg = std::move(factors.pReg);
+      plan.pLane = std::move(factors.pLane);
+      plan.mixedTranspositions = std::move(factors.mixedTranspositions);
+      // Each mixed transposition adds a round of shuffles and selects over
+      // every register, which the estimate has not been validated against, so
+      // conversions with more than one stay in shared memory as they always
+      // have.
+      if (plan.mixedTranspositions.size() < 2 &&
+          isWarpShuffleCheaper(plan, srcLayout, dstLayout, bitwidth))
+        plan.strategy = ConvertLayoutStrategy::WarpShuffle;
+    }
   }
-  return false;
+  return cache.set(std::move(key), std::move(plan));
+}
+
+bool cvtReordersRegisters(RankedTensorType srcTy, RankedTensorType dstTy) {
+  return getConvertLayoutPlan(srcTy, dstTy)->strategy <=
+         ConvertLayoutStrategy::RegisterPermutation;
+}
+
+bool cvtNeedsWarpShuffle(RankedTensorType srcTy, RankedTensorType dstTy) {
+  return getConvertLayoutPlan(srcTy, dstTy)->strategy ==
+         ConvertLayoutStrategy::WarpShuffle;
 }
 
 bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy) {
@@ -10,7 +10,6 @@
 #include "triton/Dialect/TritonGPU/IR/Attributes.h"
 #include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
-#include "triton/Tools/GenericSwizzling.h"
 #include "triton/Tools/LayoutUtils.h"
 #include "llvm/ADT/SmallSet.h"
 
@@ -37,54 +36,42 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
   LogicalResult
   matchAndRewrite(ConvertLayoutOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    MLIRContext *ctx = op.getContext();
-
-    const auto &shape = op.getType().getShape();
     auto srcTy = op.getSrc().getType();
     auto dstTy = op.getType();
 
-    LinearLayout conversion = minimalCvtLayout(srcTy, dstTy);
-    LinearLayout srcLayout = toLinearLayout(srcTy);
-    LinearLayout dstLayout = toLinearLayout(dstTy);
-
-    StringAttr kBlock = str_attr("block");
-    StringAttr kWarp = str_attr("warp");
-    StringAttr kLane = str_attr("lane");
-    StringAttr kRegister = str_attr("register");
-
-    assert(to_vector(conversion.getInDimNames()) ==
-           to_vector(conversion.getOutDimNames()));
-    auto dims = conversion.getInDimNames();
-    if (llvm::is_contained(dims, kBlock)) {
+    auto plan = getConvertLayoutPlan(srcTy, dstTy);
+    assert(to_vector(plan->conversion.getInDimNames()) ==
+           to_vector(plan->conversion.getOutDimNames()));
+    switch (plan->strategy) {
+    case ConvertLayoutStrategy::DistributedSharedMemory:
       // Case 1: Transfer between values in different CTAs.
       //          This requires moving values through distributed shared memory.
       return rewriter.notifyMatchFailure(
           op, "NYI: Transfer between different CTAs");
-    } else if (llvm::is_contained(dims, kWarp)) {
+    case ConvertLayoutStrategy::SharedMemory:
       // Case 2: Transfer between values in the same CTA, in which case we move
-      //         values through shared memory.
-      return transferWithinBlock(op, srcLayout, dstLayout, adaptor, rewriter);
-    } else if (llvm::is_contained(dims, kLane)) {
-      // Case 3. Transfer between values in the same warp, in which case we try
-      //         to move values using warp shuffles, though if the pattern is
-      //         expensive enough we fall back to using shared memory
-      if (cvtNeedsWarpShuffle(srcTy, dstTy))
-        return transferWithinWarp(op, adaptor, rewriter);
-
-      // TODO: Since data is only transferred within a warp over shared memory,
+      //         values through shared memory. This is also the case of
+      //         transfers within a warp that are cheaper through shared memory
+      //         than with warp shuffles.
+      // TODO: When data is only transferred within a warp over shared memory,
       // we should use `bar.warp.sync` instead of `barrier`, which will improve
       // latency when warps issue barriers on different cycles.
-      return transferWithinBlock(op, srcLayout, dstLayout, adaptor, rewriter);
-    } else if (llvm::is_contained(dims, kRegister)) {
+      return transferWithinBlock(op, *plan, adaptor, rewriter);
+    case ConvertLayoutStrategy::WarpShuffle:
+      // Case 3. Transfer between values in the same warp, in which case we
+      //         move values using warp shuffles.
+      return transferWithinWarp(op, *plan, adaptor, rewriter);
+    case ConvertLayoutStrategy::RegisterPermutation:
       // Case 4. Transfer between values in the same thread, in which case we
       //         simply reorder the elements of adaptor.getSrc().
-      return transferWithinThread(op, conversion, adaptor, rewriter);
-    } else {
+      return transferWithinThread(op, plan->conversion, adaptor, rewriter);
+    case ConvertLayoutStrategy::Identity:
       // Cast 5. The two layouts are equivalent. We should probably remove
       // these in RemoveLayoutConversion.
       rewriter.replaceOp(op, adaptor.getSrc());
       return success();
     }
+    llvm_unreachable("unknown convert_layout strategy");
   }
 
   LogicalResult
@@ -113,7 +100,8 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
   SmallVector<Value> transferWithinBlockSwizzlingImpl(
       Location loc, ConversionPatternRewriter &rewriter,
       const LinearLayout &srcLayout, const LinearLayout &dstLayout,
-      ArrayRef<Value> inVals, Type llvmElemTy, Value smemBase) const {
+      const LinearLayout &smem, ArrayRef<Value> inVals, Type llvmElemTy,
+      Value smemBase) const {
     auto *ctx = rewriter.getContext();
     auto b = TritonLLVMOpBuilder(loc, rewriter);
     // We handle transformations recursively as they all need a preprocessing
@@ -125,9 +113,9 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
       auto newInVals = llvm::to_vector(llvm::map_range(inVals, [&](Value v) {
         return b.ptrtoint(llvmElemTyPtr, v).getResult();
       }));
-      auto outVals =
-          transferWithinBlockSwizzlingImpl(loc, rewriter, srcLayout, dstLayout,
-                                           newInVals, llvmElemTyPtr, smemBase);
+      auto outVals = transferWithinBlockSwizzlingImpl(
+          loc, rewriter, srcLayout, dstLayout, smem, newInVals, llvmElemTyPtr,
+          smemBase);
       for (auto &v : outVals) {
         v = b.inttoptr(llvmElemTy, v);
       }
@@ -140,8 +128,9 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
       auto i8ElemTy = i8_ty;
       auto newInVals = llvm::to_vector(llvm::map_range(
           inVals, [&](Value v) { return b.zext(i8ElemTy, v).getResult(); }));
-      auto outVals = transferWithinBlockSwizzlingImpl(
-          loc, rewriter, srcLayout, dstLayout, newInVals, i8ElemTy, smemBase);
+      auto outVals =
+          transferWithinBlockSwizzlingImpl(loc, rewriter, srcLayout, dstLayout,
+                                           smem, newInVals, i8ElemTy, smemBase);
       for (auto &v : outVals) {
         v = b.trunc(llvmElemTy, v);
       }
@@ -154,22 +143,23 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
       auto prmtSrc = removeBroadcastSrc.apply(srcLayout);
       auto newInVals = removeBroadcastSrc.apply(inVals);
       return transferWithinBlockSwizzlingImpl(loc, rewriter, prmtSrc, dstLayout,
-                                              newInVals, llvmElemTy, smemBase);
+                                              smem, newInVals, llvmElemTy,
+                                              smemBase);
     }
 
     // Remove broadcasting in dst
     auto removeBroadcastDst = actionRemoveBroadcastedRegs(dstLayout);
     if (!removeBroadcastDst.isIdentity()) {
       auto prmtDst = removeBroadcastDst.apply(dstLayout);
-      auto outVals = transferWithinBlockSwizzlingImpl(
-          loc, rewriter, srcLayout, prmtDst, inVals, llvmElemTy, smemBase);
+      auto outVals =
+          transferWithinBlockSwizzlingImpl(loc, rewriter, srcLayout, prmtDst,
+                                           smem, inVals, llvmElemTy, smemBase);
       return broadcastAs(outVals, dstLayout);
     }
 
     // At this point we have a type that's at least 8-bit
-    // and we don't have broadcasting in the registers
-    auto bitwidth = llvmElemTy.getIntOrFloatBitWidth();
-    auto smem = optimalSwizzling(srcLayout, dstLayout, bitwidth);
+    // and we don't have broadcasting in the registers, which is what `smem`
+    // was computed for by the conversion plan
 
     // Extract reps from smem
     auto kReg = str_attr("register");
@@ -228,7 +218,8 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
   }
 
   LogicalResult
-  transferWithinBlockSwizzling(ConvertLayoutOp op, Value src,
+  transferWithinBlockSwizzling(ConvertLayoutOp op,
+                               const ConvertLayoutPlan &plan, Value src,
                                ConversionPatternRewriter &rewriter) const {
     // Fallback for now to standard lowering if it can use stmatrix
     auto scratchConfig =
@@ -263,7 +254,8 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
         LLVM::getSharedMemoryBase(loc, rewriter, targetInfo, op.getOperation());
     auto inVals = unpackLLElements(loc, src, rewriter);
     auto outVals = transferWithinBlockSwizzlingImpl(
-        loc, rewriter, srcLayout, dstLayout, inVals, llvmElemTy, smemBase);
+        loc, rewriter, srcLayout, dstLayout, plan.sharedLayout, inVals,
+        llvmElemTy, smemBase);
 
     Value result =
         packLLElements(loc, getTypeConverter(), outVals, rewriter, dstTy);
@@ -272,15 +264,14 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
   }
 
   LogicalResult transferWithinBlock(ConvertLayoutOp op,
-                                    const LinearLayout &srcLayout,
-                                    const LinearLayout &dstLayout,
+                                    const ConvertLayoutPlan &plan,
                                     OpAdaptor adaptor,
                                     ConversionPatternRewriter &rewriter) const {
     assert(cvtNeedsSharedMemory(op.getSrc().getType(), op.getType()));
 
     // Try to use swizzling to implement the conversion
-    if (succeeded(
-            transferWithinBlockSwizzling(op, adaptor.getSrc(), rewriter))) {
+    if (succeeded(transferWithinBlockSwizzling(op, plan, adaptor.getSrc(),
+                                               rewriter))) {
       return success();
     }
 
@@ -293,7 +284,9 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
 
   // Use warp shuffles to implement a layout conversion where data only needs to
   // be moved within warps.
-  LogicalResult transferWithinWarp(ConvertLayoutOp op, OpAdaptor adaptor,
+  LogicalResult transferWithinWarp(ConvertLayoutOp op,
+                                   const ConvertLayoutPlan &plan,
+                                   OpAdaptor adaptor,
                                    ConversionPatternRewriter &rewriter) const {
     auto loc = op.getLoc();
     auto *ctx = op.getContext();
@@ -303,8 +296,12 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
     StringAttr kReg = str_attr("register");
     StringAttr kLane = str_attr("lane");
 
-    auto factors = getWarpLayoutConvertDecomposition(srcTy, dstTy);
-    auto &[pReg, pLane, mixedTranspositions] = factors;
+    // The factors are shared with other conversions of the same plan, and the
+    // transpositions are rewritten below to account for register packing.
+    const LinearLayout &pReg = plan.pReg;
+    const LinearLayout &pLane = plan.pLane;
+    SmallVector<std::pair<int, int>> mixedTranspositions =
+        plan.mixedTranspositions;
     int m = mixedTranspositions.size();
     bool pLaneIsTrivial = squareSublayoutIsIdentity(pLane, kLane);
     assert((m > 0 || !pLaneIsTrivial) && "Shuffles not needed for conversion");
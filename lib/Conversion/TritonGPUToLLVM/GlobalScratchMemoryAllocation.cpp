@@ -1,5 +1,8 @@
 #include "mlir/Analysis/Liveness.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "triton/Analysis/Allocation.h"
 #include "triton/Conversion/TritonGPUToLLVM/Passes.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
 using namespace mlir;
@@ -16,6 +19,106 @@ static int32_t roundUp(int32_t val, int32_t step) {
   return t - (t % step);
 }
 
+namespace {
+
+// A range of a function's global scratch memory: either the buffer of a
+// ttg.global_scratch_alloc or the scratch memory of a callee.
+struct ScratchBuffer {
+  Operation *owner;
+  uint32_t size;
+  uint32_t alignment;
+  Interval<size_t> range;
+  uint32_t offset = 0;
+};
+
+// Computes when the global scratch memory of an operation is in use, as an
+// interval of operation ids in post-order, like the shared memory allocator.
+//
+// Only buffers that are read and written through generic loads, stores and
+// atomics of the current function get a precise interval. Any other use of
+// the pointer (a tensor descriptor read by the async proxy, a call, a store
+// of the pointer itself, a branch or a warp specialized partition) keeps the
+// buffer live for the whole function, so its bytes are never shared.
+class ScratchLiveness {
+public:
+  explicit ScratchLiveness(Operation *funcOp)
+      : funcOp(funcOp), liveness(funcOp) {
+    funcOp->walk<WalkOrder::PostOrder>(
+        [&](Operation *op) { operationId[op] = operationId.size(); });
+  }
+
+  Interval<size_t> getRange(Operation *owner) {
+    Interval<size_t> whole = getSpan(funcOp);
+    if (!isa<triton::gpu::GlobalScratchAllocOp>(owner) ||
+        owner->getParentOfType<WarpSpecializeOp>())
+      return whole;
+
+    size_t start = operationId.lookup(owner);
+    size_t end = start + 1;
+    SmallVector<Value> worklist{owner->getResult(0)};
+    DenseSet<Value> derived{owner->getResult(0)};
+    while (!worklist.empty()) {
+      Value value = worklist.pop_back_val();
+      for (Operation *liveOp : liveness.resolveLiveness(value)) {
+        start = std::min(start, operationId.lookup(liveOp));
+        end = std::max(end, operationId.lookup(liveOp) + 1);
+      }
+      for (Operation *user : value.getUsers()) {
+        if (isa<triton::AddPtrOp, triton::SplatOp, triton::BroadcastOp,
+                triton::ExpandDimsOp, ConvertLayoutOp>(user)) {
+          if (derived.insert(user->getResult(0)).second)
+            worklist.push_back(user->getResult(0));
+        } else if (!isAccessedThrough(user, value)) {
+          return whole;
+        }
+      }
+    }
+    return {start, end};
+  }
+
+private:
+  static bool isAccessedThrough(Operation *user, Value ptr) {
+    if (auto load = dyn_cast<triton::LoadOp>(user))
+      return load.getPtr() == ptr;
+    if (auto store = dyn_cast<triton::StoreOp>(user))
+      return store.getPtr() == ptr;
+    if (auto rmw = dyn_cast<triton::AtomicRMWOp>(user))
+      return rmw.getPtr() == ptr;
+    if (auto cas = dyn_cast<triton::AtomicCASOp>(user))
+      return cas.getPtr() == ptr;
+    return false;
+  }
+
+  // Ids of `op` and all the operations nested in it.
+  Interval<size_t> getSpan(Operation *op) {
+    size_t start = operationId.lookup(op);
+    op->walk([&](Operation *nested) {
+      start = std::min(start, operationId.lookup(nested));
+    });
+    return {start, operationId.lookup(op) + 1};
+  }
+
+  Operation *funcOp;
+  Liveness liveness;
+  DenseMap<Operation *, size_t> operationId;
+};
+
+// Returns whether `buffer` may run after another buffer that shares its
+// bytes was accessed. The entry block runs once, so a buffer allocated there
+// before all the buffers it overlaps is the first to use its bytes.
+bool mayFollowOverlappingBuffer(Operation *funcOp, const ScratchBuffer &buffer,
+                                ArrayRef<const ScratchBuffer *> overlapping) {
+  Block &entry = funcOp->getRegion(0).front();
+  if (buffer.owner->getBlock() != &entry)
+    return true;
+  return llvm::any_of(overlapping, [&](const ScratchBuffer *other) {
+    Operation *ancestor = entry.findAncestorOpInBlock(*other->owner);
+    return !ancestor || !buffer.owner->isBeforeInBlock(ancestor);
+  });
+}
+
+} // namespace
+
 static void allocateGMem(Operation *parentOp,
                          llvm::SetVector<Operation *> &callStack) {
   // Recursively visit any dependency functions
@@ -31,12 +134,8 @@ static void allocateGMem(Operation *parentOp,
 
   MLIRContext *ctx = parentOp->getContext();
   OpBuilder builder(ctx);
-  int32_t offset = 0;
-  uint32_t largestAlignment = 1;
-
-  // Dumb allocation that ignores liveness and makes no attempt to minimize
-  // padding
-  // TODO: Use a real algorithm
+  ScratchLiveness liveness(parentOp);
+  SmallVector<ScratchBuffer> buffers;
   parentOp->walk<WalkOrder::PostOrder>([&](Operation *op) {
     uint32_t nbytes = 0;
     uint32_t align = 0;
@@ -55,15 +154,61 @@ static void allocateGMem(Operation *parentOp,
       nbytes = nbytes_attr.getValue().getZExtValue();
       align = align_attr.getValue().getZExtValue();
     }
-    if (nbytes > 0) {
-      offset = roundUp(offset, align);
-      op->setAttr("ttg.global_scratch_memory_offset",
-                  builder.getI32IntegerAttr(offset));
-      offset += nbytes;
-      largestAlignment = std::max(largestAlignment, align);
-    }
+    if (nbytes > 0)
+      buffers.push_back({op, nbytes, align, liveness.getRange(op)});
   });
-  int32_t totalMemorySize = roundUp(offset, largestAlignment);
+
+  // First fit in program order: each buffer takes the lowest offset that
+  // doesn't overlap the buffers placed before it whose liveness it intersects.
+  // Buffers that are never live at the same time share bytes.
+  int32_t size = 0;
+  uint32_t largestAlignment = 1;
+  SmallVector<const ScratchBuffer *> neighbors;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    ScratchBuffer &buffer = buffers[i];
+    neighbors.clear();
+    for (const ScratchBuffer &placed : ArrayRef(buffers).take_front(i)) {
+      if (placed.range.intersects(buffer.range))
+        neighbors.push_back(&placed);
+    }
+    llvm::stable_sort(neighbors,
+                      [](const ScratchBuffer *a, const ScratchBuffer *b) {
+                        return a->offset < b->offset;
+                      });
+    int32_t offset = 0;
+    for (const ScratchBuffer *neighbor : neighbors) {
+      if (roundUp(offset, buffer.alignment) + buffer.size <= neighbor->offset)
+        break;
+      offset = std::max<int32_t>(offset, neighbor->offset + neighbor->size);
+    }
+    buffer.offset = roundUp(offset, buffer.alignment);
+    buffer.owner->setAttr("ttg.global_scratch_memory_offset",
+                          builder.getI32IntegerAttr(buffer.offset));
+    size = std::max<int32_t>(size, buffer.offset + buffer.size);
+    largestAlignment = std::max(largestAlignment, buffer.alignment);
+  }
+
+  // Other threads may still be accessing the bytes a buffer reuses, so every
+  // thread has to be done with the previous buffer before the new one is
+  // written. Buffers touched by the async proxy are never shared, so a
+  // barrier is enough and no proxy fence is needed.
+  SmallVector<const ScratchBuffer *> overlapping;
+  for (const ScratchBuffer &buffer : buffers) {
+    Interval<size_t> bytes(buffer.offset, buffer.offset + buffer.size);
+    overlapping.clear();
+    for (const ScratchBuffer &other : buffers) {
+      if (&other != &buffer &&
+          bytes.intersects({other.offset, other.offset + other.size}))
+        overlapping.push_back(&other);
+    }
+    if (!overlapping.empty() &&
+        mayFollowOverlappingBuffer(parentOp, buffer, overlapping)) {
+      builder.setInsertionPoint(buffer.owner);
+      builder.create<mlir::gpu::BarrierOp>(buffer.owner->getLoc());
+    }
+  }
+
+  int32_t totalMemorySize = roundUp(size, largestAlignment);
   parentOp->setAttr("ttg.global_scratch_memory_size",
                     builder.getI32IntegerAttr(totalMemorySize));
   parentOp->setAttr("ttg.global_scratch_memory_alignment",
@@ -0,0 +1,204 @@
+#include "mlir/Analysis/DataFlow/IntegerRangeAnalysis.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/RangeAnalysis.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Debug.h"
+
+#include <limits>
+
+#define DEBUG_TYPE "triton-narrow-indexing"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+#define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
+
+namespace mlir::triton {
+
+#define GEN_PASS_DEF_TRITONNARROWINDEXING
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+std::optional<ConstantIntRanges> getRange(const DataFlowSolver &solver,
+                                          Value value) {
+  return (*collectRanges(solver, value))[0];
+}
+
+// Returns true if every value in the range of `value` fits in a signed i32.
+bool fitsInI32(const DataFlowSolver &solver, Value value) {
+  std::optional<ConstantIntRanges> range = getRange(solver, value);
+  if (!range)
+    return false;
+  return range->smin().getSExtValue() >= std::numeric_limits<int32_t>::min() &&
+         range->smax().getSExtValue() <= std::numeric_limits<int32_t>::max();
+}
+
+// Returns true if the mask is known to be true for every element.
+bool isAlwaysTrue(const DataFlowSolver &solver, Value mask) {
+  std::optional<ConstantIntRanges> range = getRange(solver, mask);
+  return range && range->umin().getBoolValue();
+}
+
+Type getI32Type(Type type) {
+  auto i32Ty = IntegerType::get(type.getContext(), 32);
+  if (auto tensorTy = dyn_cast<RankedTensorType>(type))
+    return tensorTy.clone(i32Ty);
+  return i32Ty;
+}
+
+// Rebuilds i64 index computations in i32. Truncation commutes with addition,
+// subtraction and multiplication, so once the final offset is known to fit in
+// i32 the whole computation can be carried out in i32, whether or not the
+// intermediate values fit.
+class IndexNarrower {
+public:
+  // Returns true if `value` can be rebuilt in i32 without truncating any value
+  // that is computed in i64, i.e. if narrowing it removes all the i64 math.
+  bool canNarrow(Value value) {
+    Operation *def = value.getDefiningOp();
+    if (!def)
+      return false;
+    if (auto extOp = dyn_cast<arith::ExtSIOp>(def))
+      return getElementTypeOrSelf(extOp.getIn()).getIntOrFloatBitWidth() <= 32;
+    if (matchPattern(value, m_Constant()))
+      return true;
+    if (isa<arith::AddIOp, arith::SubIOp, arith::MulIOp>(def))
+      return canNarrow(def->getOperand(0)) && canNarrow(def->getOperand(1));
+    if (isa<SplatOp, BroadcastOp, ExpandDimsOp>(def))
+      return canNarrow(def->getOperand(0));
+    return false;
+  }
+
+  Value narrow(OpBuilder &builder, Value value) {
+    if (Value known = narrowed.lookup(value))
+      return known;
+    Operation *def = value.getDefiningOp();
+    Type i32Ty = getI32Type(value.getType());
+    OpBuilder::InsertionGuard guard(builder);
+    builder.setInsertionPoint(def);
+    Location loc = def->getLoc();
+
+    Value result;
+    if (auto extOp = dyn_cast<arith::ExtSIOp>(def)) {
+      result = extOp.getIn();
+      if (result.getType() != i32Ty)
+        result = builder.create<arith::ExtSIOp>(loc, i32Ty, result);
+    } else if (DenseElementsAttr attr;
+               matchPattern(value, m_Constant(&attr))) {
+      auto truncAttr = attr.mapValues(
+          getElementTypeOrSelf(i32Ty),
+          [](const APInt &v) { return v.trunc(32); });
+      result = builder.create<arith::ConstantOp>(loc, i32Ty, truncAttr);
+    } else if (IntegerAttr attr; matchPattern(value, m_Constant(&attr))) {
+      auto truncAttr = builder.getIntegerAttr(i32Ty, attr.getValue().trunc(32));
+      result = builder.create<arith::ConstantOp>(loc, i32Ty, truncAttr);
+    } else if (isa<arith::AddIOp, arith::SubIOp, arith::MulIOp>(def)) {
+      // The overflow flags of the i64 ops don't hold for the narrowed ones.
+      Value lhs = narrow(builder, def->getOperand(0));
+      Value rhs = narrow(builder, def->getOperand(1));
+      result = TypeSwitch<Operation *, Value>(def)
+                   .Case([&](arith::AddIOp) {
+                     return builder.create<arith::AddIOp>(loc, lhs, rhs);
+                   })
+                   .Case([&](arith::SubIOp) {
+                     return builder.create<arith::SubIOp>(loc, lhs, rhs);
+                   })
+                   .Case([&](arith::MulIOp) {
+                     return builder.create<arith::MulIOp>(loc, lhs, rhs);
+                   });
+    } else {
+      assert((isa<SplatOp, BroadcastOp, ExpandDimsOp>(def)) &&
+             "unexpected op in a narrowable index computation");
+      Value src = narrow(builder, def->getOperand(0));
+      OperationState state(loc, def->getName());
+      state.addOperands(src);
+      state.addTypes(i32Ty);
+      state.addAttributes(def->getAttrs());
+      result = builder.create(state)->getResult(0);
+    }
+    narrowed[value] = result;
+    return result;
+  }
+
+private:
+  DenseMap<Value, Value> narrowed;
+};
+
+} // namespace
+
+class NarrowIndexingPass
+    : public impl::TritonNarrowIndexingBase<NarrowIndexingPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    DenseMap<Value, SetVector<Operation *>> assumptions =
+        TritonIntegerRangeAnalysis::collectAssumptions(mod);
+    std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
+    auto *rangeAnalysis = solver->load<TritonIntegerRangeAnalysis>(assumptions);
+    // The first axis of a CUDA grid can have up to 2^31 - 1 programs.
+    rangeAnalysis->maxNumPrograms = std::numeric_limits<int32_t>::max();
+    initializeFuncOps(mod, rangeAnalysis);
+    if (failed(solver->initializeAndRun(mod)))
+      return signalPassFailure();
+
+    // Query the solver before any rewrite, since it knows nothing about the
+    // values created below.
+    IndexNarrower narrower;
+    SmallVector<AddPtrOp> narrowOffsets;
+    SmallVector<Operation *> unmasked;
+    mod.walk([&](Operation *op) {
+      if (auto addPtrOp = dyn_cast<AddPtrOp>(op)) {
+        Value offset = addPtrOp.getOffset();
+        if (getElementTypeOrSelf(offset).isInteger(64) &&
+            fitsInI32(*solver, offset) && narrower.canNarrow(offset))
+          narrowOffsets.push_back(addPtrOp);
+      } else if (auto loadOp = dyn_cast<LoadOp>(op)) {
+        if (loadOp.getMask() && isAlwaysTrue(*solver, loadOp.getMask()))
+          unmasked.push_back(op);
+      } else if (auto storeOp = dyn_cast<StoreOp>(op)) {
+        if (storeOp.getMask() && isAlwaysTrue(*solver, storeOp.getMask()))
+          unmasked.push_back(op);
+      }
+    });
+
+    SmallVector<Operation *> maybeDead;
+    OpBuilder builder(mod.getContext());
+    for (AddPtrOp addPtrOp : narrowOffsets) {
+      LDBG("narrowing the offset of " << addPtrOp);
+      Value offset = addPtrOp.getOffset();
+      addPtrOp.getOffsetMutable().assign(narrower.narrow(builder, offset));
+      maybeDead.push_back(offset.getDefiningOp());
+    }
+    for (Operation *op : unmasked) {
+      LDBG("dropping the mask of " << *op);
+      if (auto loadOp = dyn_cast<LoadOp>(op)) {
+        maybeDead.push_back(loadOp.getMask().getDefiningOp());
+        if (loadOp.getOther())
+          maybeDead.push_back(loadOp.getOther().getDefiningOp());
+        loadOp.getMaskMutable().clear();
+        loadOp.getOtherMutable().clear();
+      } else {
+        auto storeOp = cast<StoreOp>(op);
+        maybeDead.push_back(storeOp.getMask().getDefiningOp());
+        storeOp.getMaskMutable().clear();
+      }
+    }
+
+    // Erase the i64 index computations and the masks left without users.
+    DenseSet<Operation *> erased;
+    while (!maybeDead.empty()) {
+      Operation *op = maybeDead.pop_back_val();
+      if (!op || erased.contains(op) || !isOpTriviallyDead(op))
+        continue;
+      for (Value operand : op->getOperands())
+        maybeDead.push_back(operand.getDefiningOp());
+      erased.insert(op);
+      op->erase();
+    }
+  }
+};
+
+} // namespace mlir::triton
@@ -1185,14 +1185,14 @@ LinearLayout SliceEncodingAttr::toLinearLayout(ArrayRef<int64_t> shape) const {
                       llvm::to_vector(sliceLL.getOutDimNames()));
 }
 
-LinearLayout
+LinearLayoutCache::Handle
 TritonGPUDialect::toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
                                  ArrayRef<int64_t> allocationShape) {
   CacheKey key{
       std::vector<int64_t>(shape.begin(), shape.end()), layout,
       std::vector<int64_t>(allocationShape.begin(), allocationShape.end())};
   if (auto result = llCache.get(key)) {
-    return *result;
+    return result;
   }
 
   // Layouts are distributed or shared in triton core
@@ -1228,8 +1228,7 @@ TritonGPUDialect::toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
     }
   }
 
-  llCache.set(std::move(key), result);
-  return result;
+  return llCache.set(std::move(key), std::move(result));
 }
 
 LinearLayout toLinearLayout(RankedTensorType type) {
@@ -1252,11 +1251,25 @@ LinearLayout toLinearLayout(TensorOrMemDesc type) {
 
 LinearLayout toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
                             ArrayRef<int64_t> allocationShape) {
+  return *getCachedLinearLayout(shape, layout, allocationShape);
+}
+
+std::shared_ptr<const LinearLayout>
+getCachedLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
+                      ArrayRef<int64_t> allocationShape) {
   auto *ctx = layout.getContext();
   return ctx->getLoadedDialect<TritonGPUDialect>()->toLinearLayout(
       shape, layout, allocationShape);
 }
 
+std::shared_ptr<const LinearLayout>
+getCachedLinearLayout(TensorOrMemDesc type) {
+  if (auto memDesc = dyn_cast<MemDescType>(type))
+    return getCachedLinearLayout(memDesc.getShape(), memDesc.getEncoding(),
+                                 memDesc.getAllocShape());
+  return getCachedLinearLayout(type.getShape(), type.getEncoding(), {});
+}
+
 LinearLayout getLayoutWithinBlock(const LinearLayout &layout) {
   assert(!layout.getInDimNames().empty());
   MLIRContext *ctx = layout.getInDimNames().begin()->getContext();
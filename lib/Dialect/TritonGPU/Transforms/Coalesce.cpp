@@ -155,7 +155,8 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
   void runOnOperation() override {
     // Run axis info analysis
     ModuleOp moduleOp = getOperation();
-    ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
+    ModuleAxisInfoAnalysis &axisInfoAnalysis =
+        getAnalysis<ModuleAxisInfoAnalysis>();
 
     // For each i/o operation, we determine what layout
     // the pointers should have for best memory coalescing
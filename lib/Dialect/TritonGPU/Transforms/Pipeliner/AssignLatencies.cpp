@@ -25,18 +25,6 @@ namespace {
 // assignLatencies
 //===----------------------------------------------------------------------===//
 
-// Return true if the preconditions for pipelining the loop are met.
-bool preCondition(scf::ForOp forOp) {
-  // Skip loop with distance > 1 for now.
-  // TODO: relax the constraint in the expander.
-  if (loopHasDistGreaterThanOne(forOp))
-    return false;
-  // Don't pipeline outer loops.
-  if (isOuterLoop(forOp))
-    return false;
-  return true;
-}
-
 bool hasLatenciesAssigned(scf::ForOp forOp) {
   auto helper = TritonDialect::getLoaded(forOp)->getLatencyAttrHelper();
   for (auto &op : forOp.getBody()->without_terminator()) {
@@ -46,6 +34,20 @@ bool hasLatenciesAssigned(scf::ForOp forOp) {
   return false;
 }
 
+// Return true if the preconditions for pipelining the loop are met.
+// Loop-carried dependencies with a distance greater than one are split into
+// steps of one by the scheduler.
+bool preCondition(scf::ForOp forOp) {
+  // Only pipeline outer loops on request. Their nested loops are placed in the
+  // last stage, so this prefetches the loads feeding them across iterations of
+  // the outer loop.
+  if (isOuterLoop(forOp) &&
+      !forOp->hasAttr(mlir::triton::kNumStagesAttrName) &&
+      !hasLatenciesAssigned(forOp))
+    return false;
+  return true;
+}
+
 void assignUserProvidedLatencies(scf::ForOp forOp,
                                  DenseMap<Operation *, int> &opLatency) {
   auto helper = TritonDialect::getLoaded(forOp)->getLatencyAttrHelper();
@@ -59,14 +61,13 @@ void assignUserProvidedLatencies(scf::ForOp forOp,
 class AssignLoadLatencies {
 public:
   AssignLoadLatencies(scf::ForOp forOp, int numStages,
-                      DenseMap<Operation *, int> &opLatency)
-      : forOp(forOp), numStages(numStages), opLatency(opLatency) {};
+                      DenseMap<Operation *, int> &opLatency,
+                      tt::ModuleAxisInfoAnalysis &axisInfoAnalysis)
+      : forOp(forOp), numStages(numStages), opLatency(opLatency),
+        axisInfoAnalysis(axisInfoAnalysis) {};
 
   void run() {
     bool pipelineWithoutDot = forOp->hasAttr(mlir::triton::kNumStagesAttrName);
-    ModuleOp moduleOp = forOp->getParentOfType<ModuleOp>();
-    tt::ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
-
     llvm::MapVector<Operation *, std::pair<int, Operation *>> loadOpToIndLevel =
         loadOpsToIndirectionLevel(forOp, pipelineWithoutDot, axisInfoAnalysis,
                                   numStages);
@@ -88,6 +89,7 @@ private:
   scf::ForOp forOp;
   int numStages;
   DenseMap<Operation *, int> &opLatency;
+  tt::ModuleAxisInfoAnalysis &axisInfoAnalysis;
 
 public:
   static bool canHaveSharedEncoding(tt::LoadOp op) {
@@ -226,7 +228,9 @@ private:
 // requested number of stages assign the latencies in a way that cover all the
 // stages with the sum of latencies in the chain from the first load to the
 // final dot op.
-void assignLatencies(ModuleOp moduleOp, int defaultNumStages) {
+void assignLatencies(
+    ModuleOp moduleOp, int defaultNumStages,
+    function_ref<tt::ModuleAxisInfoAnalysis &()> getAxisInfoAnalysis) {
   SmallVector<scf::ForOp> loops;
   moduleOp->walk([&](scf::ForOp forOp) {
     // Bail out for loops with num_stage <= 1.
@@ -244,7 +248,8 @@ void assignLatencies(ModuleOp moduleOp, int defaultNumStages) {
       continue;
     }
     int numStages = getNumStagesOrDefault(forOp, defaultNumStages);
-    AssignLoadLatencies(forOp, numStages, opLatency).run();
+    AssignLoadLatencies(forOp, numStages, opLatency, getAxisInfoAnalysis())
+        .run();
     AssignMMALatencies(forOp, opLatency).run();
   }
   serializeLatencies(moduleOp, opLatency);
@@ -351,7 +356,14 @@ struct AssignLatencies
     : public impl::TritonGPUAssignLatenciesBase<AssignLatencies> {
   using TritonGPUAssignLatenciesBase::TritonGPUAssignLatenciesBase;
 
-  void runOnOperation() override { assignLatencies(getOperation(), numStages); }
+  void runOnOperation() override {
+    assignLatencies(getOperation(), numStages, [&]() -> auto & {
+      return getAnalysis<tt::ModuleAxisInfoAnalysis>();
+    });
+    // Latencies are attributes, so the values and their axis info are
+    // unchanged.
+    markAnalysesPreserved<tt::ModuleAxisInfoAnalysis>();
+  }
 };
 
 } // namespace mlir::triton::gpu
@@ -1065,7 +1065,11 @@ scf::ForOp lowerMMA(ttng::MMAv5OpInterface mma, scf::ForOp forOp,
 
 scf::ForOp lowerMMAs(scf::ForOp forOp, CoarseSchedule &schedule) {
   SmallVector<ttng::MMAv5OpInterface> mmas;
-  forOp.walk([&](ttng::MMAv5OpInterface mma) { mmas.push_back(mma); });
+  forOp.walk([&](ttng::MMAv5OpInterface mma) {
+    // MMAs of nested loops are lowered with their own loop.
+    if (mma->getParentOfType<scf::ForOp>() == forOp)
+      mmas.push_back(mma);
+  });
   for (auto mma : mmas) {
     forOp = lowerMMA(mma, forOp, schedule);
   }
@@ -1082,6 +1086,7 @@ void lowerLoop(scf::ForOp forOp,
   if (failed(schedule.deSerialize(forOp))) {
     return;
   }
+  scheduleOpsAroundNestedLoops(forOp, schedule);
   scf::ForOp newForOp = lowerMMAs(forOp, schedule);
   newForOp = lowerLoads(newForOp, schedule, axisInfoAnalysis);
   newForOp = lowerTMADescriptors(newForOp, schedule);
@@ -1092,6 +1097,11 @@ void lowerLoop(scf::ForOp forOp,
 
 void lowerLoops(ModuleOp moduleOp) {
   triton::ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
+  lowerLoops(moduleOp, axisInfoAnalysis);
+}
+
+void lowerLoops(ModuleOp moduleOp,
+                triton::ModuleAxisInfoAnalysis &axisInfoAnalysis) {
   SmallVector<scf::ForOp> loops;
   moduleOp->walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
   if (loops.empty())
@@ -0,0 +1,466 @@
+#include "triton/Dialect/TritonGPU/Transforms/ModuloSchedule.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "llvm/ADT/SmallVectorExtras.h"
+#include "llvm/Support/Debug.h"
+#include <cmath>
+#include <limits>
+
+#define DEBUG_TYPE "triton-modulo-schedule"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+#define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
+
+using namespace mlir;
+namespace ttng = mlir::triton::nvidia_gpu;
+
+namespace mlir::triton::gpu {
+
+//===----------------------------------------------------------------------===//
+// Target model
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+// Rough figures from vendor documentation and microbenchmarks. Only their
+// ratios matter for the schedule.
+// clang-format off
+constexpr PipelineTargetDesc kAmpereDatacenter = {
+    /*globalLatency=*/500, /*globalBytesPerCycle=*/10,
+    /*sharedLatency=*/30, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/32, /*mmaFlopsPerCycle=*/2048,
+    /*sharedMemoryBytes=*/166912, /*registersPerThread=*/255};
+constexpr PipelineTargetDesc kAmpere = {
+    /*globalLatency=*/500, /*globalBytesPerCycle=*/6,
+    /*sharedLatency=*/30, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/32, /*mmaFlopsPerCycle=*/1024,
+    /*sharedMemoryBytes=*/101376, /*registersPerThread=*/255};
+constexpr PipelineTargetDesc kHopper = {
+    /*globalLatency=*/600, /*globalBytesPerCycle=*/14,
+    /*sharedLatency=*/30, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/64, /*mmaFlopsPerCycle=*/4096,
+    /*sharedMemoryBytes=*/232448, /*registersPerThread=*/255};
+constexpr PipelineTargetDesc kBlackwell = {
+    /*globalLatency=*/700, /*globalBytesPerCycle=*/28,
+    /*sharedLatency=*/30, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/128, /*mmaFlopsPerCycle=*/8192,
+    /*sharedMemoryBytes=*/232448, /*registersPerThread=*/255};
+constexpr PipelineTargetDesc kCDNA2 = {
+    /*globalLatency=*/600, /*globalBytesPerCycle=*/8,
+    /*sharedLatency=*/64, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/32, /*mmaFlopsPerCycle=*/1024,
+    /*sharedMemoryBytes=*/65536, /*registersPerThread=*/512};
+constexpr PipelineTargetDesc kCDNA3 = {
+    /*globalLatency=*/700, /*globalBytesPerCycle=*/8,
+    /*sharedLatency=*/64, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/32, /*mmaFlopsPerCycle=*/2048,
+    /*sharedMemoryBytes=*/65536, /*registersPerThread=*/512};
+constexpr PipelineTargetDesc kCDNA4 = {
+    /*globalLatency=*/700, /*globalBytesPerCycle=*/13,
+    /*sharedLatency=*/64, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/32, /*mmaFlopsPerCycle=*/4096,
+    /*sharedMemoryBytes=*/163840, /*registersPerThread=*/512};
+constexpr PipelineTargetDesc kRDNA = {
+    /*globalLatency=*/500, /*globalBytesPerCycle=*/8,
+    /*sharedLatency=*/64, /*sharedBytesPerCycle=*/128,
+    /*mmaLatency=*/32, /*mmaFlopsPerCycle=*/512,
+    /*sharedMemoryBytes=*/65536, /*registersPerThread=*/256};
+// clang-format on
+
+const PipelineTargetDesc &getTargetDesc(ModuleOp module) {
+  auto targetAttr = module->getAttrOfType<StringAttr>(AttrTargetName);
+  if (!targetAttr)
+    return kAmpere;
+  StringRef target = targetAttr.strref();
+  if (target.consume_front("cuda:")) {
+    int capability = 0;
+    if (target.getAsInteger(10, capability))
+      return kAmpere;
+    if (capability >= 100)
+      return kBlackwell;
+    if (capability >= 90)
+      return kHopper;
+    if (capability == 80 || capability == 87)
+      return kAmpereDatacenter;
+    return kAmpere;
+  }
+  if (target.consume_front("hip:")) {
+    if (target.starts_with("gfx950"))
+      return kCDNA4;
+    if (target.starts_with("gfx94"))
+      return kCDNA3;
+    if (target.starts_with("gfx90a") || target.starts_with("gfx908"))
+      return kCDNA2;
+    return kRDNA;
+  }
+  return kAmpere;
+}
+
+int getCycles(double work, double perCycle) {
+  return std::max(1, static_cast<int>(std::ceil(work / perCycle)));
+}
+
+// Return the bytes moved by a memory op: the largest tensor it produces or
+// memory descriptor it accesses.
+int64_t getTransferBytes(Operation *op) {
+  int64_t bytes = 0;
+  for (Type type : op->getResultTypes())
+    bytes = std::max(bytes, getNumBytes(type));
+  for (Type type : op->getOperandTypes()) {
+    if (isa<MemDescType>(type))
+      bytes = std::max(bytes, getNumBytes(type));
+  }
+  return bytes;
+}
+
+int64_t getNumElements(ArrayRef<int64_t> shape) {
+  int64_t numElements = 1;
+  for (int64_t dim : shape)
+    numElements *= dim;
+  return numElements;
+}
+
+} // namespace
+
+int64_t getNumBytes(Type type) {
+  if (auto tensorTy = dyn_cast<RankedTensorType>(type)) {
+    Type elTy = tensorTy.getElementType();
+    if (!elTy.isIntOrFloat())
+      return 0;
+    return tensorTy.getNumElements() * elTy.getIntOrFloatBitWidth() / 8;
+  }
+  if (auto memDescTy = dyn_cast<MemDescType>(type)) {
+    Type elTy = memDescTy.getElementType();
+    if (!elTy.isIntOrFloat())
+      return 0;
+    return getNumElements(memDescTy.getShape()) *
+           elTy.getIntOrFloatBitWidth() / 8;
+  }
+  return 0;
+}
+
+PipelineTargetModel PipelineTargetModel::get(ModuleOp module) {
+  return PipelineTargetModel(getTargetDesc(module));
+}
+
+OpTiming PipelineTargetModel::getGlobalLoadTiming(int64_t bytes) const {
+  int occupancy = getCycles(bytes, desc.globalBytesPerCycle);
+  return {PipelineResource::GlobalMemory, desc.globalLatency + occupancy,
+          occupancy, /*issueCycles=*/1};
+}
+
+OpTiming PipelineTargetModel::getSharedMemoryTiming(int64_t bytes) const {
+  int occupancy = getCycles(bytes, desc.sharedBytesPerCycle);
+  return {PipelineResource::SharedMemory, desc.sharedLatency + occupancy,
+          occupancy, /*issueCycles=*/1};
+}
+
+OpTiming PipelineTargetModel::getMMATiming(int64_t flops,
+                                           bool isAsync) const {
+  int occupancy = getCycles(flops, desc.mmaFlopsPerCycle);
+  // mma.sync and MFMA instructions are issued by the warps one after the
+  // other, wgmma and tcgen05 are issued once and run in the background.
+  return {PipelineResource::TensorCore, desc.mmaLatency + occupancy, occupancy,
+          isAsync ? 1 : occupancy};
+}
+
+OpTiming PipelineTargetModel::getTiming(Operation *op) const {
+  if (isa<LoadOp, DescriptorLoadOp, DescriptorGatherOp,
+          AsyncCopyGlobalToLocalOp, ttng::AsyncTMACopyGlobalToLocalOp,
+          ttng::AsyncTMAGatherOp>(op))
+    return getGlobalLoadTiming(getTransferBytes(op));
+  if (isa<LocalLoadOp, LocalStoreOp>(op) ||
+      (isa<LocalAllocOp>(op) && op->getNumOperands() == 1))
+    return getSharedMemoryTiming(getTransferBytes(op));
+  if (auto dotOp = dyn_cast<DotOpInterface>(op)) {
+    auto aShape = cast<ShapedType>(dotOp.getA().getType()).getShape();
+    auto bShape = cast<ShapedType>(dotOp.getB().getType()).getShape();
+    int64_t flops = 2 * getNumElements(aShape) * bShape.back();
+    return getMMATiming(flops,
+                        isa<ttng::WarpGroupDotOp, ttng::MMAv5OpInterface>(op));
+  }
+  return {};
+}
+
+//===----------------------------------------------------------------------===//
+// ModuloScheduler
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+int floorDiv(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+// Reservation of a resource for `length` cycles from `start`, modulo II.
+struct Reservation {
+  PipelineResource resource;
+  int start;
+  int length;
+  unsigned node;
+};
+
+bool overlaps(int ii, int aStart, int aLength, int bStart, int bLength) {
+  int aToB = ((bStart - aStart) % ii + ii) % ii;
+  int bToA = ((aStart - bStart) % ii + ii) % ii;
+  return aToB < aLength || bToA < bLength;
+}
+
+SmallVector<std::pair<PipelineResource, int>, 2>
+getResourceUsage(const OpTiming &timing) {
+  SmallVector<std::pair<PipelineResource, int>, 2> usage;
+  if (timing.issueCycles > 0)
+    usage.push_back({PipelineResource::Issue, timing.issueCycles});
+  if (timing.resource != PipelineResource::Issue && timing.occupancy > 0)
+    usage.push_back({timing.resource, timing.occupancy});
+  return usage;
+}
+
+} // namespace
+
+unsigned ModuloScheduler::addNode(Node node) {
+  nodes.push_back(node);
+  return nodes.size() - 1;
+}
+
+unsigned ModuloScheduler::addOp(Operation *op, int64_t sharedMemoryBytes,
+                                int numRegs) {
+  return addNode({op, model.getTiming(op), sharedMemoryBytes,
+                  /*extraBuffers=*/0, numRegs});
+}
+
+void ModuloScheduler::addEdge(unsigned src, unsigned dst, int latency,
+                              int distance, bool crossStage) {
+  // Values carried to the next iteration are produced before they are used,
+  // which a zero latency wouldn't order within a stage.
+  if (distance > 0)
+    latency = std::max(latency, 1);
+  edges.push_back({src, dst, latency, distance, crossStage});
+}
+
+int ModuloScheduler::getResMII() const {
+  std::array<int64_t, static_cast<size_t>(PipelineResource::NumResources)>
+      usage{};
+  for (const Node &node : nodes) {
+    for (auto [resource, cycles] : getResourceUsage(node.timing))
+      usage[static_cast<size_t>(resource)] += cycles;
+  }
+  return std::max<int64_t>(1, *llvm::max_element(usage));
+}
+
+// Bellman-Ford on the longest paths: a cycle whose latency exceeds II times
+// its distance can't be scheduled at that II.
+bool ModuloScheduler::hasPositiveCycle(int ii) const {
+  SmallVector<int64_t> dist(nodes.size(), 0);
+  for (size_t i = 0; i <= nodes.size(); ++i) {
+    bool changed = false;
+    for (const Edge &edge : edges) {
+      int64_t d = dist[edge.src] + edge.latency -
+                  static_cast<int64_t>(ii) * edge.distance;
+      if (d > dist[edge.dst]) {
+        dist[edge.dst] = d;
+        changed = true;
+      }
+    }
+    if (!changed)
+      return false;
+  }
+  return true;
+}
+
+void ModuloScheduler::computeBudgets(Result &result) const {
+  result.sharedMemoryBytes = 0;
+  result.numRegs = 0;
+  for (auto [i, node] : llvm::enumerate(nodes)) {
+    // The number of stages the result is carried across. Values carried to
+    // the next iteration are there with or without pipelining.
+    int span = 0;
+    for (const Edge &edge : edges) {
+      if (edge.src == i)
+        span = std::max(span, result.getStage(edge.dst) - result.getStage(i));
+    }
+    if (node.sharedMemoryBytes > 0) {
+      result.sharedMemoryBytes +=
+          node.sharedMemoryBytes * (std::max(span, 1) + node.extraBuffers);
+    }
+    if (node.numRegs > 0)
+      result.numRegs += node.numRegs * span;
+  }
+}
+
+std::optional<ModuloScheduler::Result>
+ModuloScheduler::scheduleAt(int ii, int maxStages) const {
+  unsigned numNodes = nodes.size();
+  // Schedule the nodes with the longest path to the end of the iteration
+  // first.
+  SmallVector<int64_t> height(numNodes, 0);
+  for (unsigned i = 0; i < numNodes; ++i) {
+    bool changed = false;
+    for (const Edge &edge : edges) {
+      int64_t h = height[edge.dst] + edge.latency -
+                  static_cast<int64_t>(ii) * edge.distance;
+      if (h > height[edge.src]) {
+        height[edge.src] = h;
+        changed = true;
+      }
+    }
+    if (!changed)
+      break;
+  }
+  auto order = llvm::to_vector(llvm::seq<unsigned>(0, numNodes));
+  llvm::stable_sort(
+      order, [&](unsigned a, unsigned b) { return height[a] > height[b]; });
+
+  SmallVector<SmallVector<const Edge *>> inEdges(numNodes), outEdges(numNodes);
+  for (const Edge &edge : edges) {
+    inEdges[edge.dst].push_back(&edge);
+    outEdges[edge.src].push_back(&edge);
+  }
+
+  constexpr int kUnscheduled = -1;
+  SmallVector<int> times(numNodes, kUnscheduled);
+  SmallVector<int> prevTimes(numNodes, kUnscheduled);
+  SmallVector<Reservation> table;
+
+  auto isSatisfied = [&](const Edge &edge) {
+    int src = times[edge.src];
+    int dst = times[edge.dst] + ii * edge.distance;
+    if (dst < src + edge.latency)
+      return false;
+    return !edge.crossStage || floorDiv(dst, ii) > floorDiv(src, ii);
+  };
+  auto getConflicts = [&](unsigned node, int time) {
+    SmallVector<unsigned> conflicts;
+    for (auto [resource, length] : getResourceUsage(nodes[node].timing)) {
+      for (const Reservation &r : table) {
+        if (r.resource == resource &&
+            overlaps(ii, time, length, r.start, r.length))
+          conflicts.push_back(r.node);
+      }
+    }
+    return conflicts;
+  };
+  auto unschedule = [&](unsigned node) {
+    times[node] = kUnscheduled;
+    llvm::erase_if(table, [&](const Reservation &r) { return r.node == node; });
+  };
+
+  int budget = 8 * numNodes;
+  while (budget-- > 0) {
+    auto next = llvm::find_if(
+        order, [&](unsigned node) { return times[node] == kUnscheduled; });
+    if (next == order.end())
+      break;
+    unsigned node = *next;
+
+    // The earliest start allowed by the predecessors scheduled so far.
+    int earliest = 0;
+    for (const Edge *edge : inEdges[node]) {
+      int src = times[edge->src];
+      if (src == kUnscheduled || edge->src == node)
+        continue;
+      int start = src + edge->latency - ii * edge->distance;
+      if (edge->crossStage)
+        start = std::max(start, (floorDiv(src, ii) + 1 - edge->distance) * ii);
+      earliest = std::max(earliest, start);
+    }
+
+    // Try the first slot without resource conflicts in the next II cycles:
+    // the earliest start or the end of one of the reservations.
+    SmallVector<int> candidates = {earliest};
+    for (const Reservation &r : table) {
+      int end = (r.start + r.length) % ii;
+      candidates.push_back(earliest + ((end - earliest) % ii + ii) % ii);
+    }
+    llvm::sort(candidates);
+    std::optional<int> time;
+    for (int candidate : candidates) {
+      if (getConflicts(node, candidate).empty()) {
+        time = candidate;
+        break;
+      }
+    }
+    // Otherwise, force the node in and evict whatever it conflicts with.
+    if (!time) {
+      int prev = prevTimes[node];
+      time = prev == kUnscheduled || earliest > prev ? earliest : prev + 1;
+      for (unsigned conflict : getConflicts(node, *time))
+        unschedule(conflict);
+    }
+
+    times[node] = prevTimes[node] = *time;
+    for (auto [resource, length] : getResourceUsage(nodes[node].timing))
+      table.push_back({resource, *time % ii, length, node});
+    for (const Edge *edge : outEdges[node]) {
+      if (edge->dst != node && times[edge->dst] != kUnscheduled &&
+          !isSatisfied(*edge))
+        unschedule(edge->dst);
+    }
+  }
+  if (llvm::is_contained(times, kUnscheduled))
+    return std::nullopt;
+
+  // Start the first stage at the earliest node.
+  int shift = floorDiv(*llvm::min_element(times), ii) * ii;
+  Result result;
+  result.ii = ii;
+  result.times = llvm::map_to_vector(times, [&](int t) { return t - shift; });
+  result.numStages = 1 + *llvm::max_element(result.times) / ii;
+  if (result.numStages > maxStages)
+    return std::nullopt;
+  computeBudgets(result);
+  const PipelineTargetDesc &desc = model.getDesc();
+  if (result.sharedMemoryBytes > desc.sharedMemoryBytes ||
+      result.numRegs > std::max(0, desc.registersPerThread - liveRegs)) {
+    LDBG("II " << ii << " needs " << result.sharedMemoryBytes
+               << " bytes of shared memory and " << result.numRegs
+               << " registers on top of " << liveRegs);
+    return std::nullopt;
+  }
+  return result;
+}
+
+FailureOr<ModuloScheduler::Result> ModuloScheduler::run(int maxStages) const {
+  if (nodes.empty() || maxStages < 1)
+    return failure();
+
+  // Scheduling everything back to back always fits the resources, so there is
+  // no need to look beyond the length of one iteration.
+  int64_t maxII = 1;
+  for (const Node &node : nodes) {
+    maxII += node.timing.latency + node.timing.occupancy +
+             node.timing.issueCycles;
+  }
+  for (const Edge &edge : edges)
+    maxII += edge.latency;
+  maxII = std::min<int64_t>(maxII, std::numeric_limits<int>::max() / 4);
+
+  int resMII = getResMII();
+  if (hasPositiveCycle(maxII)) {
+    LDBG("Dependence cycle within one iteration");
+    return failure();
+  }
+  // The recurrences bound the II from below as well.
+  int lo = resMII, hi = maxII;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (hasPositiveCycle(mid))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  int mii = lo;
+  LDBG("ResMII = " << resMII << ", MII = " << mii);
+
+  // Grow the II geometrically: the exact minimum matters less than the time
+  // spent looking for it.
+  for (int64_t ii = mii; ii <= maxII; ii += std::max<int64_t>(1, ii / 32)) {
+    if (auto result = scheduleAt(ii, maxStages)) {
+      LDBG("Scheduled at II " << ii << " in " << result->numStages
+                              << " stages");
+      return *result;
+    }
+  }
+  return failure();
+}
+
+} // namespace mlir::triton::gpu
@@ -161,6 +161,32 @@ bool mlir::triton::isOuterLoop(scf::ForOp forOp) {
   });
 }
 
+SmallVector<Operation *>
+mlir::triton::splitLoopCarriedDistances(scf::ForOp forOp) {
+  Operation *yieldOp = forOp.getBody()->getTerminator();
+  OpBuilder builder(yieldOp);
+  SmallVector<Operation *> copies;
+  for (OpOperand &operand : yieldOp->getOpOperands()) {
+    Value value = operand.get();
+    if (value.getDefiningOp())
+      continue;
+    // A value yielded `n` iterations after it was defined becomes a chain of
+    // `n` copies, each one iteration apart, which the expander supports.
+    auto copy = builder.create<UnrealizedConversionCastOp>(
+        value.getLoc(), value.getType(), value);
+    operand.set(copy.getResult(0));
+    copies.push_back(copy);
+  }
+  return copies;
+}
+
+void mlir::triton::removeLoopCarriedCopies(ArrayRef<Operation *> copies) {
+  for (Operation *copy : copies) {
+    copy->getResult(0).replaceAllUsesWith(copy->getOperand(0));
+    copy->erase();
+  }
+}
+
 // Function to mask operations during scheduling.
 Operation *mlir::triton::predicateOp(RewriterBase &rewriter, Operation *op,
                                      Value pred) {
@@ -301,3 +301,45 @@ void tt::scheduleDependencies(scf::ForOp forOp, tt::CoarseSchedule &schedule) {
     }
   }
 }
+
+void tt::scheduleOpsAroundNestedLoops(scf::ForOp forOp,
+                                      tt::CoarseSchedule &schedule) {
+  auto isScheduledLoop = [&](Operation &op) {
+    return isa<scf::ForOp, scf::WhileOp>(op) && schedule.count(&op);
+  };
+  DenseMap<Operation *, Operation *> nextLoop;
+  Operation *loop = nullptr;
+  for (Operation &op : llvm::reverse(forOp.getBody()->without_terminator())) {
+    nextLoop[&op] = loop;
+    if (isScheduledLoop(op))
+      loop = &op;
+  }
+
+  Operation *prevLoop = nullptr;
+  DenseSet<Operation *> afterPrevLoop;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (isScheduledLoop(op)) {
+      prevLoop = &op;
+      continue;
+    }
+    if (schedule.count(&op))
+      continue;
+    // Ops that consume the results of the preceding loop or whose results are
+    // unused, like buffer deallocations and waits, stay after it. The others
+    // feed the following loop.
+    bool usesPrevLoop =
+        llvm::any_of(getNestedOperands(&op), [&](Value operand) {
+          Operation *def = operand.getDefiningOp();
+          return def && (def == prevLoop || afterPrevLoop.contains(def));
+        });
+    Operation *anchor = nextLoop.lookup(&op);
+    if (prevLoop && (!anchor || usesPrevLoop || op.use_empty()))
+      anchor = prevLoop;
+    if (!anchor)
+      continue;
+    if (anchor == prevLoop)
+      afterPrevLoop.insert(&op);
+    auto [stage, cluster] = schedule[anchor];
+    schedule.insert(&op, stage, cluster);
+  }
+}
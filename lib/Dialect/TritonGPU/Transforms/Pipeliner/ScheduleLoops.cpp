@@ -1,12 +1,16 @@
 #include "mlir/IR/Dominance.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/MMAv5PipelineUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/ModuloSchedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
 #include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/Support/Debug.h"
 
 #define DEBUG_TYPE "triton-loop-pipeline"
@@ -30,12 +34,14 @@ bool hasGpuBarriers(scf::ForOp forOp) {
 }
 
 // Return true if the preconditions for pipelining the loop are met.
-bool isSafeToPipeline(scf::ForOp forOp) {
-  // Skip loop with distance > 1.
-  if (loopHasDistGreaterThanOne(forOp))
+bool isSafeToPipeline(scf::ForOp forOp, bool allowOuterLoops,
+                      bool allowLongDistances) {
+  // Skip loop with distance > 1, unless the caller splits them.
+  if (loopHasDistGreaterThanOne(forOp) && !allowLongDistances)
     return false;
-  // Don't pipeline outer loops.
-  if (isOuterLoop(forOp))
+  // Outer loops can only be pipelined with their nested loops in the last
+  // stage.
+  if (isOuterLoop(forOp) && !allowOuterLoops)
     return false;
   // Skip loops with barriers.
   if (hasGpuBarriers(forOp))
@@ -136,6 +142,17 @@ void scheduleRemainingToLastStage(scf::ForOp forOp, CoarseSchedule &schedule,
 }
 
 namespace {
+// Nested loops cannot be predicated, so they have to run in the last stage,
+// which is never part of the prologue.
+bool nestedLoopsInLastStage(scf::ForOp forOp, CoarseSchedule &schedule) {
+  int lastStage = schedule.getNumStages() - 1;
+  return llvm::all_of(forOp.getBody()->without_terminator(),
+                      [&](Operation &op) {
+                        return !isa<scf::ForOp, scf::WhileOp>(op) ||
+                               schedule[&op].first == lastStage;
+                      });
+}
+
 bool hasLatenciesAssigned(scf::ForOp forOp,
                           const DenseMap<Operation *, int> &opLatency) {
   for (auto &op : forOp.getBody()->without_terminator()) {
@@ -242,21 +259,126 @@ CoarseSchedule scheduleKeyOps(scf::ForOp forOp,
   return schedule;
 }
 
+// Re-schedule the key ops with the modulo scheduler, from the latency and
+// throughput of the ops on the target rather than their latencies in stages.
+// The stage latencies still bound the number of stages, so this only removes
+// stages that don't hide any latency at the II the loop runs at, or that don't
+// fit the shared memory and register budgets.
+CoarseSchedule
+moduloScheduleKeyOps(scf::ForOp forOp,
+                     const DenseMap<Operation *, int> &opLatency,
+                     const PipelineTargetModel &model,
+                     unsigned liveRegisters) {
+  CoarseSchedule keyOps = scheduleKeyOps(forOp, opLatency);
+  if (keyOps.empty())
+    return keyOps;
+
+  ModuloScheduler scheduler(model);
+  // The values live in the loop before pipelining hold their registers
+  // whatever the schedule, so the copies carried across stages get the rest.
+  scheduler.setLiveRegisters(liveRegisters);
+  DenseMap<Operation *, unsigned> opToNode;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    // Pipelined loads are multi-buffered in shared memory, the values of
+    // other ops carried across stages are kept in registers.
+    int64_t sharedMemoryBytes = 0;
+    int numRegs = 0;
+    if (opLatency.count(&op) &&
+        isa<LoadOp, DescriptorLoadOp, DescriptorGatherOp>(op)) {
+      sharedMemoryBytes = getNumBytes(op.getResult(0).getType());
+    } else {
+      for (Type type : op.getResultTypes())
+        numRegs += getNumI32RegsPerThread(type);
+    }
+    opToNode[&op] = scheduler.addOp(&op, sharedMemoryBytes, numRegs);
+  }
+  Block *body = forOp.getBody();
+  for (Operation &op : body->without_terminator()) {
+    for (Value operand : getNestedOperands(&op)) {
+      // A value yielded unchanged is carried over one more iteration.
+      int distance = 0;
+      while (auto arg = dyn_cast<BlockArgument>(operand)) {
+        if (arg.getOwner() != body || arg.getArgNumber() == 0 ||
+            distance > static_cast<int>(forOp.getNumRegionIterArgs()))
+          break;
+        operand = body->getTerminator()->getOperand(arg.getArgNumber() - 1);
+        ++distance;
+      }
+      Operation *def = operand.getDefiningOp();
+      if (def)
+        def = body->findAncestorOpInBlock(*def);
+      if (!def)
+        continue;
+      unsigned src = opToNode[def];
+      // The users of a latency op wait for it at the start of a stage.
+      bool crossStage = distance == 0 && opLatency.lookup(def) > 0;
+      scheduler.addEdge(src, opToNode[&op],
+                        scheduler.getNode(src).timing.latency, distance,
+                        crossStage);
+    }
+  }
+
+  FailureOr<ModuloScheduler::Result> result =
+      scheduler.run(keyOps.getNumStages());
+  if (failed(result)) {
+    LDBG("No modulo schedule fits, keeping the latency-based schedule");
+    return keyOps;
+  }
+
+  // Order the clusters by the cycle the ops start at within the II, which
+  // keeps producers ahead of their users in the same stage. Ops placed in the
+  // epilogue cluster stay there.
+  CoarseSchedule schedule(result->numStages);
+  CoarseSchedule::Cluster keyOpsEpilogue = std::prev(keyOps.clusters.end());
+  SmallVector<int> slots;
+  for (auto &[op, stageAndCluster] : keyOps.opToStageAndCluster) {
+    if (stageAndCluster.second != keyOpsEpilogue)
+      slots.push_back(result->getSlot(opToNode[op]));
+  }
+  llvm::sort(slots);
+  DenseMap<int, CoarseSchedule::Cluster> slotToCluster;
+  for (int slot : slots) {
+    if (!slotToCluster.count(slot))
+      slotToCluster[slot] = schedule.clusters.newAtBack();
+  }
+  CoarseSchedule::Cluster epilogue = schedule.clusters.newAtBack();
+  for (auto &[op, stageAndCluster] : keyOps.opToStageAndCluster) {
+    unsigned node = opToNode[op];
+    schedule.insert(op, result->getStage(node),
+                    stageAndCluster.second == keyOpsEpilogue
+                        ? epilogue
+                        : slotToCluster[result->getSlot(node)]);
+  }
+  return schedule;
+}
+
 // Get an initial schedule for the loop. This is the base schedule from which
 // the rest of the pass will backward propagate dependencies.
+// The key ops are modulo scheduled if `model` is set, in which case
+// `liveRegisters` is the peak register pressure of the loop body.
 CoarseSchedule getInitialSchedule(scf::ForOp forOp,
-                                  const DenseMap<Operation *, int> &opLatency) {
-  if (!isSafeToPipeline(forOp))
+                                  const DenseMap<Operation *, int> &opLatency,
+                                  const PipelineTargetModel *model,
+                                  unsigned liveRegisters) {
+  // Loops with assigned latencies have their loop-carried distances split by
+  // `scheduleLoop` once they are scheduled.
+  bool hasLatencies = hasLatenciesAssigned(forOp, opLatency);
+  if (!isSafeToPipeline(forOp, /*allowOuterLoops=*/true,
+                        /*allowLongDistances=*/hasLatencies))
     return CoarseSchedule(0);
 
   // If the loop has assigned latencies, use them to determine the initial
-  // schedule.
-  if (hasLatenciesAssigned(forOp, opLatency))
+  // schedule. Outer loops keep the latency-based schedule, which places their
+  // nested loops in the last stage.
+  if (hasLatencies) {
+    if (model && !isOuterLoop(forOp))
+      return moduloScheduleKeyOps(forOp, opLatency, *model, liveRegisters);
     return scheduleKeyOps(forOp, opLatency);
+  }
 
   // If the loop has an existing schedule, use it as the base schedule.
   CoarseSchedule schedule;
-  if (forOp->hasAttr(kWarpSpecializeAttrName) &&
+  if (forOp->hasAttr(kWarpSpecializeAttrName) && !isOuterLoop(forOp) &&
       succeeded(schedule.deSerialize(forOp))) {
     // The loop was partitioned from a warp-specialized loop, meaning it can
     // have a partial view of the original loop stages. Re-schedule the loop
@@ -344,12 +466,21 @@ CoarseSchedule::Cluster schedulePrologueAndEpilogue(scf::ForOp forOp,
   return afterPrologue;
 }
 
-void scheduleLoop(scf::ForOp forOp,
-                  const DenseMap<Operation *, int> &opLatency) {
+// Returns true if ops were added to the loop. The schedule itself is only
+// recorded as attributes.
+bool scheduleLoop(scf::ForOp forOp, const DenseMap<Operation *, int> &opLatency,
+                  const PipelineTargetModel *model, unsigned liveRegisters) {
   // Based on the latencies, schedule the key ops to the stages.
-  CoarseSchedule schedule = getInitialSchedule(forOp, opLatency);
+  CoarseSchedule schedule =
+      getInitialSchedule(forOp, opLatency, model, liveRegisters);
   if (schedule.empty())
-    return;
+    return false;
+  // The expander only supports loop-carried dependencies with a distance of
+  // one. Split the longer ones with copies that are scheduled like any other
+  // op, once the loop is known to be pipelined.
+  SmallVector<Operation *> copies;
+  if (hasLatenciesAssigned(forOp, opLatency))
+    copies = splitLoopCarriedDistances(forOp);
   LLVM_DEBUG({
     schedule.serialize(forOp);
     DBGS() << "Initial coarse schedule:\n" << forOp << "\n";
@@ -367,11 +498,25 @@ void scheduleLoop(scf::ForOp forOp,
     DBGS() << "Coarse schedule with dependencies:\n" << forOp << "\n";
   });
   scheduleDistanceOneDependencies(forOp, schedule);
+  // A copy is scheduled relative to the user of the value it yields, so a
+  // chain of copies is scheduled one link at a time.
+  if (!copies.empty()) {
+    size_t numScheduled;
+    do {
+      numScheduled = schedule.opToStageAndCluster.size();
+      scheduleDistanceOneDependencies(forOp, schedule);
+    } while (schedule.opToStageAndCluster.size() != numScheduled);
+  }
   LLVM_DEBUG({
     schedule.serialize(forOp);
     DBGS() << "Coarse schedule with dist 1:\n" << forOp << "\n";
   });
   scheduleRemainingToLastStage(forOp, schedule, afterPrologue);
+  if (!nestedLoopsInLastStage(forOp, schedule)) {
+    LDBG("Nested loop is not in the last stage, not pipelining the loop");
+    removeLoopCarriedCopies(copies);
+    return false;
+  }
   LLVM_DEBUG({
     schedule.serialize(forOp);
     DBGS() << "Final coarse schedule:\n" << forOp << "\n";
@@ -379,18 +524,36 @@ void scheduleLoop(scf::ForOp forOp,
 
   // Write the schedule to the IR
   schedule.serialize(forOp);
+  return !copies.empty();
 }
 
 /// Schedule the loops based on the latencies assigned to the operations.
-void scheduleLoops(ModuleOp moduleOp) {
+/// Returns true if ops were added to any of the loops.
+bool scheduleLoops(ModuleOp moduleOp, bool moduloSchedule) {
   DenseMap<Operation *, int> opLatency = deserializeLatencies(moduleOp);
-  SmallVector<scf::ForOp> loops;
-  moduleOp->walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
-  if (loops.empty())
-    return;
-  for (auto forOp : loops) {
-    scheduleLoop(forOp, opLatency);
+  std::optional<PipelineTargetModel> model;
+  if (moduloSchedule)
+    model = PipelineTargetModel::get(moduleOp);
+  bool changed = false;
+  for (auto funcOp : moduleOp.getOps<FunctionOpInterface>()) {
+    SmallVector<scf::ForOp> loops;
+    funcOp->walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
+    if (loops.empty())
+      continue;
+    // Scheduling a loop adds copies that the analysis doesn't know about, so
+    // the pressure of every loop is read before any of them is scheduled.
+    DenseMap<Operation *, unsigned> liveRegisters;
+    if (model) {
+      RegisterPressureAnalysis pressure(funcOp);
+      for (auto forOp : loops)
+        liveRegisters[forOp] = pressure.getMaxPressure(forOp.getBodyRegion());
+    }
+    for (auto forOp : loops) {
+      changed |= scheduleLoop(forOp, opLatency, model ? &*model : nullptr,
+                              liveRegisters.lookup(forOp));
+    }
   }
+  return changed;
 }
 
 } // namespace
@@ -405,7 +568,14 @@ void scheduleLoops(ModuleOp moduleOp) {
 struct ScheduleLoops : public impl::TritonGPUScheduleLoopsBase<ScheduleLoops> {
   using TritonGPUScheduleLoopsBase::TritonGPUScheduleLoopsBase;
 
-  void runOnOperation() override { scheduleLoops(getOperation()); }
+  void runOnOperation() override {
+    bool useModuloSchedule =
+        moduloSchedule || tools::getBoolEnv("TRITON_MODULO_SCHEDULE");
+    // The schedule is only recorded as attributes, but the copies that split
+    // loop-carried distances are new values the axis info doesn't know about.
+    if (!scheduleLoops(getOperation(), useModuloSchedule))
+      markAnalysesPreserved<ModuleAxisInfoAnalysis>();
+  }
 };
 
 } // namespace mlir::triton::gpu
@@ -159,6 +159,9 @@ static void expandLoops(ModuleOp moduleOp) {
     if (failed(schedule.deSerialize(forOp))) {
       continue;
     }
+    // Nested loops were expanded first, and their prologues and epilogues
+    // belong to the stage of the nested loop.
+    scheduleOpsAroundNestedLoops(forOp, schedule);
 
     std::vector<std::pair<Operation *, unsigned>> finalSchedule =
         schedule.createFinalSchedule(forOp);
@@ -225,8 +228,9 @@ struct PipelinePass : public impl::TritonGPUPipelineBase<PipelinePass> {
   void runOnOperation() override {
     ModuleOp moduleOp = getOperation();
     // Transform the loop by introducing async operations to prepare it for
-    // pipeline expansion.
-    lowerLoops(moduleOp);
+    // pipeline expansion. The axis info computed by AssignLatencies is reused
+    // when the passes in between only annotate the IR.
+    lowerLoops(moduleOp, getAnalysis<ModuleAxisInfoAnalysis>());
     if (dumpIntermediateSteps) {
       llvm::dbgs()
           << "// -----// SoftwarePipeliner internal IR Dump After: LowerLoops\n"
@@ -20,6 +20,7 @@
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #include <deque>
 
 namespace mlir::triton::gpu {
@@ -63,7 +64,8 @@ public:
     LayoutInfo() {}
     llvm::SmallSetVector<Attribute, 8> encodings;
   };
-  LayoutPropagation(FuncOp F) : funcOp(F) {}
+  LayoutPropagation(FuncOp F, bool useCostModel = false)
+      : funcOp(F), useCostModel(useCostModel) {}
   // Find the anchor ops and set their layout in the data structure.
   void initAnchorLayout();
   // Recursively Propagate the layout to all the users of the anchor ops until
@@ -77,6 +79,10 @@ public:
                    SmallVector<Value> &changed, Operation *op);
   // Resolve cases where a value has multiple layouts associated to it.
   void resolveConflicts();
+  // Revisit the layouts picked for `candidates` to minimize the estimated
+  // cost of the conversions around them.
+  void resolveConflictsByCost(
+      const llvm::MapVector<Value, SmallVector<Attribute>> &candidates);
   // Rewrite the IR for the full module.
   void rewrite();
   // Rewrite the IR for a region.
@@ -110,11 +116,13 @@ private:
   DenseMap<std::pair<Value, Attribute>, Value> rewriteMapping;
   SetVector<Operation *> opToDelete;
   FuncOp funcOp;
+  bool useCostModel;
 };
 
 class LayoutRematerialization {
 public:
-  LayoutRematerialization(FuncOp F) : funcOp(F) {}
+  LayoutRematerialization(FuncOp F, bool useCostModel = false)
+      : funcOp(F), useCostModel(useCostModel) {}
 
   // Map the original value to the remat'ed one.
   void addRematValue(Value old, Attribute encoding, Value newV);
@@ -161,6 +169,7 @@ private:
   // DenseMap<std::pair<Operation*, Attribute>, Operation*>
   SetVector<Operation *> opToDelete;
   FuncOp funcOp;
+  bool useCostModel;
   DominanceInfo domInfo;
   PostDominanceInfo postDomInfo;
 };
@@ -178,6 +187,35 @@ void LayoutRematerialization::cleanup() {
     op->erase();
 }
 
+// Estimated cost of a layout conversion, in the milli-SM-cycles used by
+// backward rematerialization.
+struct ConvertLayoutCost {
+  int64_t cycles = 0;
+  // Bytes stored to and loaded back from shared memory.
+  int64_t sharedMemoryBytes = 0;
+};
+
+ConvertLayoutCost getConvertLayoutCost(RankedTensorType srcTy,
+                                       RankedTensorType dstTy) {
+  if (srcTy.getEncoding() == dstTy.getEncoding() ||
+      cvtReordersRegisters(srcTy, dstTy))
+    return {};
+  unsigned bitwidth = getConvertLayoutBitwidth(srcTy);
+  int64_t bytes = srcTy.getNumElements() * bitwidth / 8;
+  // A round of shuffles goes through the same crossbar as a shared memory
+  // access, but needs no barrier.
+  if (!cvtNeedsSharedMemory(srcTy, dstTy))
+    return {8 * bytes, 0};
+
+  // The store and the load each cost 8 per byte, replayed once per bank
+  // conflict of the layout picked by the lowering, and then we double it to
+  // account for the synchronisation.
+  auto plan = getConvertLayoutPlan(srcTy, dstTy);
+  int64_t storeCost = (8 * bytes) << plan->writeBankConflicts;
+  int64_t loadCost = (8 * bytes) << plan->readBankConflicts;
+  return {2 * (storeCost + loadCost), 2 * bytes};
+}
+
 // Return true if the op is an op with a layout we don't want to change. We will
 // propagate the layout starting from anchor ops.
 bool isLayoutAnchor(Operation *op) {
@@ -337,6 +375,7 @@ void LayoutPropagation::propagateLayout() {
 }
 
 void LayoutPropagation::resolveConflicts() {
+  llvm::MapVector<Value, SmallVector<Attribute>> candidates;
   for (auto &it : layouts) {
     Operation *op = it.first.getDefiningOp();
     LayoutInfo &info = it.second;
@@ -354,9 +393,87 @@ void LayoutPropagation::resolveConflicts() {
         break;
       }
     }
+    // The cost model doesn't account for coalescing, so memory ops keep the
+    // heuristic.
+    if (useCostModel && !isLoadOrStore)
+      candidates.insert({it.first, llvm::to_vector(info.encodings)});
     info.encodings.clear();
     info.encodings.insert(encoding);
   }
+  if (!candidates.empty())
+    resolveConflictsByCost(candidates);
+}
+
+void LayoutPropagation::resolveConflictsByCost(
+    const llvm::MapVector<Value, SmallVector<Attribute>> &candidates) {
+  auto getEncoding = [&](Value value) -> Attribute {
+    auto it = layouts.find(value);
+    if (it != layouts.end())
+      return *it->second.encodings.begin();
+    return cast<RankedTensorType>(value.getType()).getEncoding();
+  };
+  auto getCost = [](RankedTensorType type, Attribute src, Attribute dst) {
+    return getConvertLayoutCost(type.cloneWithEncoding(src),
+                                type.cloneWithEncoding(dst))
+        .cycles;
+  };
+  // Cost of the conversions between `value` in `encoding` and the operands
+  // of its producer and the users, given their current layouts. Edges that
+  // change the shape are not conversions and are ignored.
+  auto getLocalCost = [&](Value value, Attribute encoding) {
+    auto type = cast<RankedTensorType>(value.getType());
+    int64_t cost = 0;
+    if (Operation *def = value.getDefiningOp()) {
+      for (Value operand : def->getOperands()) {
+        auto operandType = dyn_cast<RankedTensorType>(operand.getType());
+        if (operandType && operandType.getShape() == type.getShape())
+          cost += getCost(operandType, getEncoding(operand), encoding);
+      }
+    }
+    for (Operation *user : value.getUsers()) {
+      // Users that are not rewritten take the value in its original layout.
+      Attribute userEncoding = type.getEncoding();
+      if (user->getNumResults() == 1 && layouts.contains(user->getResult(0))) {
+        Value result = user->getResult(0);
+        auto resultType = dyn_cast<RankedTensorType>(result.getType());
+        if (!resultType || resultType.getShape() != type.getShape())
+          continue;
+        userEncoding = getEncoding(result);
+      }
+      cost += getCost(type, encoding, userEncoding);
+    }
+    return cost;
+  };
+
+  // Every switch lowers the total cost, so this converges. The number of
+  // sweeps is bounded nonetheless since the local costs are approximate.
+  constexpr int kMaxSweeps = 8;
+  bool changed = true;
+  for (int sweep = 0; changed && sweep < kMaxSweeps; ++sweep) {
+    changed = false;
+    for (auto &[value, encodings] : candidates) {
+      Attribute current = getEncoding(value);
+      Attribute best = current;
+      int64_t bestCost = getLocalCost(value, current);
+      for (Attribute encoding : encodings) {
+        int64_t cost = getLocalCost(value, encoding);
+        if (cost < bestCost) {
+          best = encoding;
+          bestCost = cost;
+        }
+      }
+      if (best == current)
+        continue;
+      LLVM_DEBUG({
+        DBGS() << "cost model picks " << best << " for " << value
+               << " (cost " << bestCost << ")\n";
+      });
+      LayoutInfo &info = layouts[value];
+      info.encodings.clear();
+      info.encodings.insert(best);
+      changed = true;
+    }
+  }
 }
 
 void LayoutPropagation::dump() {
@@ -1187,6 +1304,11 @@ void LayoutRematerialization::backwardRematerialization(
   // and store each cost 8 * convertLayoutBytes, and then we double
   // it to account for extra cost due to synchronisation.
   int64_t convertLayoutCost = 32 * convertLayoutBytes;
+  // With the cost model, the conversion is priced from its layouts instead.
+  if (useCostModel) {
+    convertLayoutCost =
+        getConvertLayoutCost(convertOp.getSrc().getType(), targetType).cycles;
+  }
   int64_t rematerialisationCost = 0;
 
   // Evaluate single-use status for every operation in slice
@@ -1587,9 +1709,9 @@ void LayoutRematerialization::hoistConvertIntoConditionals(
   rewriteSlice(slice, layout, convertOp, mapping);
 }
 
-void backwardRematerialization(ModuleOp module) {
-  module.walk([](FuncOp funcOp) {
-    LayoutRematerialization layoutRemat(funcOp);
+void backwardRematerialization(ModuleOp module, bool useCostModel) {
+  module.walk([&](FuncOp funcOp) {
+    LayoutRematerialization layoutRemat(funcOp, useCostModel);
     layoutRemat.backwardRematerialization();
     layoutRemat.cleanup();
   });
@@ -1617,6 +1739,10 @@ class TritonGPURemoveLayoutConversionsPass
     : public impl::TritonGPURemoveLayoutConversionsBase<
           TritonGPURemoveLayoutConversionsPass> {
 public:
+  using impl::TritonGPURemoveLayoutConversionsBase<
+      TritonGPURemoveLayoutConversionsPass>::
+      TritonGPURemoveLayoutConversionsBase;
+
   // Cleanup convert ops.
   void cleanupConvertOps() {
     MLIRContext *context = &getContext();
@@ -1636,10 +1762,12 @@ public:
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp m = getOperation();
+    bool useCostModel =
+        costModel || tools::getBoolEnv("TRITON_LAYOUT_COST_MODEL");
 
     // 1. Propagate layout forward starting from "anchor" ops.
-    m.walk([](FuncOp funcOp) {
-      LayoutPropagation layoutPropagation(funcOp);
+    m.walk([&](FuncOp funcOp) {
+      LayoutPropagation layoutPropagation(funcOp, useCostModel);
       layoutPropagation.initAnchorLayout();
       layoutPropagation.propagateLayout();
       layoutPropagation.resolveConflicts();
@@ -1655,7 +1783,7 @@ public:
 
     // 2. For remaining convert ops, try to rematerialize the slice of producer
     // operation to avoid having to convert.
-    backwardRematerialization(m);
+    backwardRematerialization(m, useCostModel);
     LLVM_DEBUG({
       DBGS() << "Module after backward remat:\n";
       m.dump();
@@ -1686,6 +1814,16 @@ public:
       DBGS() << "Module after final cleanups:\n";
       m.dump();
     });
+
+    // 5. Report the conversions that are left. Pricing them builds linear
+    // layouts, so the traffic is only estimated with the cost model on.
+    m.walk([&](ConvertLayoutOp convertOp) {
+      ++numRemainingConverts;
+      if (useCostModel)
+        sharedMemoryBytes += getConvertLayoutCost(convertOp.getSrc().getType(),
+                                                  convertOp.getType())
+                                 .sharedMemoryBytes;
+    });
   }
 };
 
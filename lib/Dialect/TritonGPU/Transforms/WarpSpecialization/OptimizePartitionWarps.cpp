@@ -3,6 +3,7 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Conversion/TritonToTritonGPU/Passes.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
@@ -139,38 +140,33 @@ static LogicalResult relayoutWarps(ModuleAxisInfoAnalysis &axisInfo,
 // optimizePartitionWarps
 //===----------------------------------------------------------------------===//
 
-// Get the number of i32 registers required to store a tensor.
-static unsigned getTensorNumI32Regs(RankedTensorType ty) {
-  unsigned numElems = getTotalElemsPerThread(ty) *
-                      product(getThreadsPerWarp(ty)) *
-                      product(getWarpsPerCTA(ty));
-  unsigned elSize =
-      isa<PointerType>(ty.getElementType()) ? 64 : ty.getElementTypeBitWidth();
-  return numElems * elSize / 32;
-}
-
 static LogicalResult optimizePartitionNumWarps(ModuleAxisInfoAnalysis &axisInfo,
                                                WarpSpecializeOp wsOp,
                                                RunPipelineFn runPipeline) {
-  // Extremely rough estimate of the number of registers needed per partition.
-  // For each partition, get the number of i32 registers used by the largest
-  // tensor value.
+  // Rough estimate of the number of registers needed per partition, over all
+  // its threads: the peak register pressure of the partition, but at least
+  // twice its largest tensor value, assuming the largest tensor accounts for
+  // half of the registers used by a warpgroup.
   //
   // Because the partition region is isolated from above, we could in theory
   // compile it to PTX and read the number of registers that got allocated.
+  const unsigned threadsPerWarp =
+      TritonGPUDialect::getThreadsPerWarp(axisInfo.getModuleOp());
+  RegisterPressureAnalysis pressure(wsOp);
   SmallVector<unsigned> maxTensorRegs;
-  for (Region *partition : wsOp.getPartitionRegions()) {
-    unsigned &tensorRegs = maxTensorRegs.emplace_back(0);
+  for (auto [partition, numWarps] :
+       llvm::zip(wsOp.getPartitionRegions(), wsOp.getPartitionNumWarps())) {
+    unsigned largestTensorRegs = 0;
     partition->walk([&](Operation *op) {
       for (Type type :
            llvm::concat<Type>(op->getOperandTypes(), op->getResultTypes())) {
-        if (auto tensor = dyn_cast<RankedTensorType>(type))
-          tensorRegs = std::max(tensorRegs, getTensorNumI32Regs(tensor));
+        largestTensorRegs =
+            std::max(largestTensorRegs, getNumI32RegsPerThread(type));
       }
     });
-    // Assume that the largest tensor accounts for half of the registers used
-    // by a warpgroup.
-    tensorRegs *= 2;
+    unsigned regsPerThread =
+        std::max(2 * largestTensorRegs, pressure.getMaxPressure(*partition));
+    maxTensorRegs.push_back(regsPerThread * threadsPerWarp * numWarps);
   }
 
   // Reduce the number of warps used by partitions. For partitions with no
@@ -185,8 +181,6 @@ static LogicalResult optimizePartitionNumWarps(ModuleAxisInfoAnalysis &axisInfo,
   // register distributions, mostly beneficial for single-warp warpgroups that
   // just do some artihmetic.
   constexpr unsigned nTotalRegs = 1 << 16; // for Blackwell SMs
-  const unsigned threadsPerWarp =
-      TritonGPUDialect::getThreadsPerWarp(axisInfo.getModuleOp());
   const unsigned defaultNumWarps = lookupNumWarps(wsOp);
 
   SmallVector<int32_t> partitionNumWarps =
@@ -293,7 +287,7 @@ struct OptimizePartitionWarps
 } // namespace
 
 void OptimizePartitionWarps::runOnOperation() {
-  ModuleAxisInfoAnalysis axisInfo(getOperation());
+  ModuleAxisInfoAnalysis &axisInfo = getAnalysis<ModuleAxisInfoAnalysis>();
   auto runPipelineFn = [&](OpPassManager &pm, ModuleOp container) {
     // The module must be directly nested under the current op for `runPipeline`
     // to work.
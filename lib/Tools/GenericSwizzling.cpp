@@ -1,6 +1,5 @@
 #include "triton/Tools/GenericSwizzling.h"
 
-#include "third_party/f2reduce/f2reduce.h"
 #include "triton/Tools/LayoutUtils.h"
 #include "triton/Tools/LinearLayout.h"
 #include "llvm/ADT/DenseSet.h"
@@ -65,16 +64,32 @@ std::vector<std::vector<int32_t>> unflatten(ArrayRef<int32_t> basis) {
   return unflattened;
 }
 
+// Brings `rows` into reduced row echelon form over GF(2).  Bit i of a row is
+// column i, and the pivot of a row is its lowest set bit.  Zero rows end up
+// last.
+void rowReduce(MutableArrayRef<uint64_t> rows, int32_t numCols) {
+  size_t rank = 0;
+  for (int32_t col = 0; col < numCols && rank < rows.size(); ++col) {
+    uint64_t bit = 1ull << col;
+    auto *it = llvm::find_if(rows.drop_front(rank),
+                             [&](uint64_t row) { return row & bit; });
+    if (it == rows.end())
+      continue;
+    std::swap(rows[rank], *it);
+    for (size_t r = 0; r < rows.size(); ++r)
+      if (r != rank && (rows[r] & bit))
+        rows[r] ^= rows[rank];
+    ++rank;
+  }
+}
+
 // Compute the nullspace basis of `vectors`
 SmallVector<int32_t> nullspaceBasis(ArrayRef<int32_t> vectors, int32_t dim) {
   // Solve A^T x = 0, where A is the matrix of vectors
   // To do this, we form a matrix where each vector is a row
   const int32_t nRows = vectors.size();
-  auto mat = std::make_unique<uint64_t[]>(nRows);
-  for (int i = 0; i < nRows; ++i)
-    mat[i] = static_cast<uint64_t>(vectors[i]);
-  f2reduce::inplace_rref_strided(mat.get(), /*rows=*/nRows, /*cols=*/dim,
-                                 /*stride=*/1);
+  SmallVector<uint64_t> mat(vectors.begin(), vectors.end());
+  rowReduce(mat, dim);
 
   llvm::SmallDenseSet<int32_t> pivotCols;
   for (int32_t r = 0; r < nRows; ++r)
@@ -185,12 +200,8 @@ SmallVector<int32_t> computeSegment(const SmallVector<int32_t> &bankSrc,
 
 SmallVector<int32_t> complementBasis(ArrayRef<int32_t> basis, int32_t dim) {
   const int32_t nRows = basis.size();
-  auto mat = std::make_unique<uint64_t[]>(nRows);
-  for (int r = 0; r < nRows; ++r)
-    mat[r] = static_cast<uint64_t>(basis[r]);
-
-  f2reduce::inplace_rref_strided(mat.get(), /*rows=*/nRows,
-                                 /*cols=*/dim, /*stride=*/1);
+  SmallVector<uint64_t> mat(basis.begin(), basis.end());
+  rowReduce(mat, dim);
 
   llvm::SmallDenseSet<int32_t> pivotCols;
   for (int r = 0; r < nRows; ++r) {
@@ -1,11 +1,9 @@
 #include "triton/Tools/LinearLayout.h"
 
 #include <cstdint>
-#include <set>
 #include <vector>
 
 #include "mlir/IR/BuiltinAttributes.h"
-#include "third_party/f2reduce/f2reduce.h"
 #include "triton/Tools/LayoutUtils.h"
 #include "triton/Tools/StrUtil.h"
 #include "llvm/ADT/STLExtras.h"
@@ -53,84 +51,193 @@ BasesT makeBasesMap(
   return ret;
 }
 
-// Dump the matrix to stderr in a human-readable format for debugging.
-void dumpMatrix(uint64_t *m, int numRows, int numCols) {
-  assert(numCols <= 64);
-  for (int r = 0; r < numRows; r++) {
-    llvm::errs() << "0b";
-    for (int c = 0; c < numCols; c++) {
-      llvm::errs() << ((m[r] & (1 << c)) != 0 ? "1" : "0");
-    }
-    llvm::errs() << "\n";
-  }
+// Number of words in a column that packs `numBits` bits.  Every column has at
+// least one word, even if all of its out-dims have size 1.
+int32_t getNumWords(int32_t numBits) {
+  return std::max<int32_t>(1, llvm::divideCeil(numBits, 64));
 }
 
-// Build a matrix of size sum(outDimSizeLog2) x sum(inDimSizeLog2) representing
-// the bases of the given layout.  This can then be used by f2reduce.
-//
-// This function is called from the constructor of LinearLayout, so be careful
-// not to use any functions that create LLs in here.
-std::unique_ptr<uint64_t[]> getMatrix(const LinearLayout &layout) {
-  int numRows = layout.getTotalOutDimSizeLog2();
-  int numCols = layout.getTotalInDimSizeLog2();
-
-  // Don't handle giant LLs.  This makes some things easier; for example, each
-  // row can be a single uint64_t.
-  assert(numCols <= 64 && "LinearLayout too large");
-  assert(numRows <= 64 && "LinearLayout too large");
-
-  // Suppose we have a layout specified by the following values.
-  //
-  //   L(0,1) = (0b01, 0b1)
-  //   L(0,2) = (0b10, 0b0)
-  //   L(1,0) = (0b10, 0b0)
-  //   L(2,0) = (0b11, 0b0)
-  //
-  // We will create one column per entry above.  The max bit width of the
-  // codomain is (2,1), so our matrix will have 2+1=3 rows.  The final matrix
-  // will be
-  //
-  //  | L(0,1)[0] L(0,2)[0] L(1,0)[0] L(2,0)[0] |   | 0b1001 |
-  //  |    ↓         ↓         ↓         ↓      |   | 0b0111 |
-  //  | L(0,1)[1] L(0,2)[1] L(1,0)[1] L(2,0)[1] | = | 0b1000 |
-  //  |    ↓         ↓         ↓         ↓      |
-  //
-  // Note `new uint64_t[n]()` is zero-initialized, but `new uint64_t[n]` is not.
-  std::unique_ptr<uint64_t[]> m(new uint64_t[numRows]());
-  int r = 0;
-  for (StringAttr outDim : layout.getOutDimNames()) {
-    int c = 0;
-    for (StringAttr inDim : layout.getInDimNames()) {
-      for (int i = 0; i < layout.getInDimSizeLog2(inDim); i++) {
-        uint64_t basis = layout.getBasis(inDim, i, outDim);
-        for (int j = 0; j < layout.getOutDimSizeLog2(outDim); j++) {
-          m[r + j] |= ((basis >> j) & 1) << c;
-        }
-        c++;
+// Returns the `numBits` bits of `column` that start at bit `pos`.  A field is
+// at most 31 bits wide, since out-dim sizes are int32_t, but it may straddle
+// two words.
+int32_t getBits(const uint64_t *column, int32_t pos, int32_t numBits) {
+  if (numBits == 0)
+    return 0;
+  int32_t word = pos / 64;
+  int32_t bit = pos % 64;
+  uint64_t bits = column[word] >> bit;
+  if (bit + numBits > 64)
+    bits |= column[word + 1] << (64 - bit);
+  return static_cast<int32_t>(bits & ((uint64_t(1) << numBits) - 1));
+}
+
+// XORs `bits` into `column`, starting at bit `pos`.
+void xorBits(uint64_t *column, int32_t pos, uint64_t bits) {
+  if (bits == 0)
+    return;
+  int32_t word = pos / 64;
+  int32_t bit = pos % 64;
+  column[word] ^= bits << bit;
+  if (bit != 0 && (bits >> (64 - bit)) != 0)
+    column[word + 1] ^= bits >> (64 - bit);
+}
+
+void xorColumn(uint64_t *dst, const uint64_t *src, int32_t numWords) {
+  for (int32_t w = 0; w < numWords; w++)
+    dst[w] ^= src[w];
+}
+
+bool isZeroColumn(const uint64_t *column, int32_t numWords) {
+  return std::all_of(column, column + numWords,
+                     [](uint64_t word) { return word == 0; });
+}
+
+SmallVector<int32_t> getOutDimSizesLog2(const LinearLayout &layout) {
+  SmallVector<int32_t> sizesLog2;
+  for (int32_t size : layout.getOutDimSizes())
+    sizesLog2.push_back(llvm::Log2_32(size));
+  return sizesLog2;
+}
+
+// Split a packed column back into one coordinate per out-dim.
+std::vector<int32_t> unpackColumn(const uint64_t *column,
+                                  ArrayRef<int32_t> outDimSizesLog2) {
+  std::vector<int32_t> basis;
+  basis.reserve(outDimSizesLog2.size());
+  int32_t pos = 0;
+  for (int32_t sizeLog2 : outDimSizesLog2) {
+    basis.push_back(getBits(column, pos, sizeLog2));
+    pos += sizeLog2;
+  }
+  return basis;
+}
+
+// A coordinate to move from one packing of the out-dims to another: the
+// `numBits` bits at `from` in the source column go to `to` in the new one.
+struct Field {
+  int32_t from;
+  int32_t numBits;
+  int32_t to;
+};
+
+// XORs the fields of `column` into `newColumn`.
+void repackColumn(const uint64_t *column, ArrayRef<Field> fields,
+                  uint64_t *newColumn) {
+  for (const Field &field : fields)
+    xorBits(newColumn, field.to, getBits(column, field.from, field.numBits));
+}
+
+// Gaussian elimination on the columns of a GF(2) matrix, one column at a time.
+// Every vector kept has a different lowest set bit, its pivot, so a column is
+// reduced in a single pass over its bits.  Each vector also carries a tag of
+// `numTagWords` words that is XORed along with it.  Tagging the i'th inserted
+// column with bit i makes the tag of a reduced column the set of inserted
+// columns it was reduced by.
+class ColumnEchelon {
+public:
+  ColumnEchelon(int32_t numWords, int32_t numTagWords)
+      : numWords(numWords), numTagWords(numTagWords),
+        pivots(numWords * 64, -1) {}
+
+  // Reduces `column` and `tag` in place.  Returns true if `column` is in the
+  // span of the vectors kept so far, i.e. if it is reduced to zero.
+  bool reduce(uint64_t *column, uint64_t *tag) {
+    return reduceToPivot(column, tag) < 0;
+  }
+
+  // Same as reduce, but keeps the reduced column if it is not zero.
+  bool reduceOrInsert(uint64_t *column, uint64_t *tag) {
+    int32_t pivot = reduceToPivot(column, tag);
+    if (pivot < 0)
+      return true;
+    pivots[pivot] = numVectors++;
+    vectors.append(column, column + numWords);
+    if (numTagWords != 0)
+      tags.append(tag, tag + numTagWords);
+    return false;
+  }
+
+  int32_t getRank() const { return numVectors; }
+
+private:
+  // Returns the lowest set bit of the reduced column, or -1 if it is zero.
+  int32_t reduceToPivot(uint64_t *column, uint64_t *tag) {
+    for (int32_t w = 0; w < numWords; w++) {
+      // A vector's bits below its pivot are zero, so XORing it never sets a
+      // bit in a word that was already reduced.
+      while (column[w] != 0) {
+        int32_t pivot = w * 64 + __builtin_ctzll(column[w]);
+        int32_t v = pivots[pivot];
+        if (v < 0)
+          return pivot;
+        xorColumn(column, &vectors[v * numWords], numWords);
+        if (numTagWords != 0)
+          xorColumn(tag, &tags[v * numTagWords], numTagWords);
       }
     }
-    r += layout.getOutDimSizeLog2(outDim);
+    return -1;
+  }
+
+  int32_t numWords;
+  int32_t numTagWords;
+  int32_t numVectors = 0;
+  SmallVector<int32_t, 64> pivots;
+  SmallVector<uint64_t> vectors;
+  SmallVector<uint64_t> tags;
+};
+
+// Computes the number of linearly-independent columns.
+int32_t getColumnRank(ArrayRef<uint64_t> columns, int32_t numWords) {
+  ColumnEchelon echelon(numWords, /*numTagWords=*/0);
+  SmallVector<uint64_t> column(numWords);
+  for (size_t c = 0; c < columns.size(); c += numWords) {
+    std::copy_n(&columns[c], numWords, column.begin());
+    echelon.reduceOrInsert(column.data(), /*tag=*/nullptr);
+  }
+  return echelon.getRank();
+}
+
+std::string
+layoutToString(const BasesT &bases,
+               const llvm::MapVector<StringAttr, int32_t> &outDims) {
+  // Start with a newline because we print out a bulleted list; it doesn't
+  // make sense for the first line of this list to be on the same line as
+  // any previous text.
+  std::string ret = "\n";
+  std::string outDimsStr =
+      "[" +
+      join(outDims, ", ",
+           [](auto dimAndSize) {
+             auto [outDim, size] = dimAndSize;
+             return outDim.str() + " (size " + std::to_string(size) + ")";
+           }) +
+      "]";
+
+  if (bases.empty()) {
+    if (outDims.empty()) {
+      return "\n(empty layout)";
+    } else {
+      return "\n(empty layout with out-dims " + outDimsStr + ")";
+    }
   }
 
-  return m;
-}
+  // TODO: Add spaces for alignment.
+  for (const auto &[inDim, inDimBases] : bases) {
+    if (inDimBases.empty()) {
+      ret += " - " + inDim.str() + " is a size 1 dimension\n";
+      continue;
+    }
 
-// Compute the rank of the matrix formed by taking the bases for the given
-// outDim as columns.  In other words, finds the number of linearly-independent
-// bases for this output dimension.
-int getMatrixRank(std::unique_ptr<uint64_t[]> m, int numRows, int numCols) {
-  // stride is specified in number of 64-bit words per row, and we pack our
-  // matrix so that there's only one uint64_t per row.
-  assert(numCols <= 64);
-  f2reduce::inplace_rref_strided(m.get(), numRows, numCols, /*stride=*/1);
-
-  // The rank of the reduced matrix is simply the number of nonzero rows.
-  int rank = 0;
-  for (int i = 0; i < numRows; i++) {
-    if (m[i] != 0)
-      rank++;
-  }
-  return rank;
+    ret += " - " +
+           join(llvm::seq(inDimBases.size()), "\n   ",
+                [&, &inDim = inDim, &inDimBases = inDimBases](int i) {
+                  return inDim.str() + "=" + std::to_string(1 << i) + " -> (" +
+                         join(inDimBases[i], ", ") + ")";
+                }) +
+           "\n";
+  }
+  ret += "where out dims are: " + outDimsStr;
+  return ret;
 }
 
 template <typename T, typename U>
@@ -162,30 +269,24 @@ void assertDimsSubsetIgnoringOrder(T &&small, U &&big) {
 LinearLayout::tryCreate(BasesT bases,
                         ArrayRef<std::pair<StringAttr, int32_t>> outDims,
                         bool requireSurjective) {
-  LinearLayout ll(std::move(bases), std::move(outDims), NoCheckInvariants{});
-  std::optional<std::string> error = ll.checkInvariants(requireSurjective);
+  LinearLayout ll;
+  for (auto [outDim, size] : outDims) {
+    ll.outDims[outDim] = size;
+  }
+  std::optional<std::string> error =
+      ll.initialize(std::move(bases), requireSurjective);
   if (error) {
     return std::nullopt;
   }
   return ll;
 }
 
-LinearLayout::LinearLayout(BasesT bases,
-                           ArrayRef<std::pair<StringAttr, int32_t>> outDims,
-                           NoCheckInvariants)
-    : bases(std::move(bases)) {
-  for (auto [outDim, size] : outDims) {
-    this->outDims[outDim] = size;
-  }
-}
-
-LinearLayout::LinearLayout(BasesT bases, ArrayRef<StringAttr> outDimNames)
-    : bases(std::move(bases)) {
+LinearLayout::LinearLayout(BasesT bases, ArrayRef<StringAttr> outDimNames) {
   // Infer out-dim sizes.
   for (StringAttr outDim : outDimNames) {
     outDims[outDim] = 1;
   }
-  for (const auto &[inDim, inDimBases] : this->bases) {
+  for (const auto &[inDim, inDimBases] : bases) {
     for (const auto &basis : inDimBases) {
       for (int i = 0; i < basis.size(); i++) {
         int32_t &size = outDims[outDimNames[i]];
@@ -195,7 +296,7 @@ LinearLayout::LinearLayout(BasesT bases, ArrayRef<StringAttr> outDimNames)
   }
 
   std::optional<std::string> error =
-      checkInvariants(/*requireSurjective=*/true);
+      initialize(std::move(bases), /*requireSurjective=*/true);
   if (error.has_value()) {
     llvm::report_fatal_error(StringRef(*error));
   }
@@ -203,17 +304,41 @@ LinearLayout::LinearLayout(BasesT bases, ArrayRef<StringAttr> outDimNames)
 
 LinearLayout::LinearLayout(BasesT bases,
                            ArrayRef<std::pair<StringAttr, int32_t>> outDims,
-                           bool requireSurjective)
-    : LinearLayout(std::move(bases), std::move(outDims), NoCheckInvariants{}) {
-  std::optional<std::string> error = checkInvariants(requireSurjective);
+                           bool requireSurjective) {
+  for (auto [outDim, size] : outDims) {
+    this->outDims[outDim] = size;
+  }
+  std::optional<std::string> error =
+      initialize(std::move(bases), requireSurjective);
   if (error.has_value()) {
     llvm::report_fatal_error(StringRef(*error));
   }
 }
 
+LinearLayout::LinearLayout(llvm::MapVector<StringAttr, int32_t> inDimSizesLog2,
+                           ArrayRef<std::pair<StringAttr, int32_t>> outDims,
+                           SmallVector<uint64_t> flatBases,
+                           bool requireSurjective)
+    : inDims(std::move(inDimSizesLog2)), flatBases(std::move(flatBases)) {
+  for (auto [outDim, size] : outDims) {
+    assert(llvm::isPowerOf2_32(size));
+    this->outDims[outDim] = size;
+  }
+  int32_t numWords = getNumBasisWords();
+  assert(this->flatBases.size() == getTotalInDimSizeLog2() * numWords);
+  this->rank = getColumnRank(this->flatBases, numWords);
+  unpackBases();
+  if (requireSurjective && !isSurjective()) {
+    llvm::report_fatal_error(
+        "Layout is expected to be surjective, i.e. every `out` coordinate "
+        "can be reached by some `in` coordinate, but was not:" +
+        Twine(toString()));
+  }
+}
+
 std::optional<std::string>
-LinearLayout::checkInvariants(bool requireSurjective) {
-  LDBG("checkInvariants: " << toString());
+LinearLayout::initialize(BasesT bases, bool requireSurjective) {
+  LDBG("initialize: " << layoutToString(bases, outDims));
   // Check that basis values are non-negative.
   for (const auto &[inDim, inDimBases] : bases) {
     for (const auto &basis : inDimBases) {
@@ -221,7 +346,9 @@ LinearLayout::checkInvariants(bool requireSurjective) {
         return "Invalid bases passed to LinearLayout.  Expected all basis "
                "values to be non-negative, but found a negative value for "
                "in dimension '" +
-               inDim.str() + "'.  Full list of bases:" + toString() + "\n";
+               inDim.str() +
+               "'.  Full list of bases:" + layoutToString(bases, outDims) +
+               "\n";
       }
     }
   }
@@ -234,7 +361,8 @@ LinearLayout::checkInvariants(bool requireSurjective) {
                "have the same size, equal to outDimNames.size() (" +
                std::to_string(outDims.size()) +
                ").  But this failed for in dimension '" + inDim.str() +
-               "'.  Full list of bases:" + toString() + "\n";
+               "'.  Full list of bases:" + layoutToString(bases, outDims) +
+               "\n";
       }
     }
   }
@@ -249,7 +377,7 @@ LinearLayout::checkInvariants(bool requireSurjective) {
 
   // Check that the bases are smaller than the out-dim sizes.
   SmallVector<StringAttr> outDimNames = llvm::to_vector(getOutDimNames());
-  for (const auto &[inDim, inDimBases] : this->bases) {
+  for (const auto &[inDim, inDimBases] : bases) {
     for (const auto &basis : inDimBases) {
       for (int i = 0; i < basis.size(); i++) {
         if (basis[i] >= outDims[outDimNames[i]]) {
@@ -261,6 +389,27 @@ LinearLayout::checkInvariants(bool requireSurjective) {
     }
   }
 
+  // Pack the bases into the columns of `flatBases`.
+  int32_t numWords = getNumBasisWords();
+  SmallVector<int32_t> offsets;
+  int32_t offset = 0;
+  for (int32_t sizeLog2 : getOutDimSizesLog2(*this)) {
+    offsets.push_back(offset);
+    offset += sizeLog2;
+  }
+  inDims.clear();
+  flatBases.clear();
+  for (const auto &[inDim, inDimBases] : bases) {
+    inDims[inDim] = inDimBases.size();
+    for (const auto &basis : inDimBases) {
+      size_t c = flatBases.size();
+      flatBases.resize(c + numWords, 0);
+      for (auto [b, pos] : llvm::zip(basis, offsets))
+        xorBits(&flatBases[c], pos, b);
+    }
+  }
+  this->bases = std::move(bases);
+
   // Determine whether the this layout is surjective, i.e. that every `out`
   // coordinate can be reached by some `in` coordinate.
   //
@@ -271,9 +420,7 @@ LinearLayout::checkInvariants(bool requireSurjective) {
   // the rank of our matrix using Gaussian elimination, which runs in O(n^3)
   // for an n x n matrix.  Our matrix size is sum(inDimSizeLog2) x
   // sum(outDimSizeLog2), so this should be plenty fast.
-  this->rank =
-      getMatrixRank(getMatrix(*this), /*numRows=*/getTotalOutDimSizeLog2(),
-                    /*numCols=*/getTotalInDimSizeLog2());
+  this->rank = getColumnRank(flatBases, numWords);
 
   if (requireSurjective && !isSurjective()) {
     return "Layout is expected to be surjective, i.e. every `out` coordinate "
@@ -326,6 +473,55 @@ LinearLayout::LinearLayout(
                       /*requiresSurjective=*/outDimSize == 1);
 }
 
+void LinearLayout::unpackBases() {
+  int32_t numWords = getNumBasisWords();
+  SmallVector<int32_t> outDimSizesLog2 = getOutDimSizesLog2(*this);
+  bases.clear();
+  const uint64_t *column = flatBases.data();
+  for (auto [inDim, sizeLog2] : inDims) {
+    auto &inDimBases = bases[inDim];
+    inDimBases.reserve(sizeLog2);
+    for (int32_t i = 0; i < sizeLog2; i++, column += numWords)
+      inDimBases.push_back(unpackColumn(column, outDimSizesLog2));
+  }
+}
+
+int32_t LinearLayout::getNumBasisWords() const {
+  return getNumWords(getTotalOutDimSizeLog2());
+}
+
+int32_t LinearLayout::getBasis(StringAttr inDim, int32_t pos,
+                               StringAttr outDim) const {
+  assert(pos >= 0 && pos < getInDimSizeLog2(inDim));
+  int32_t numWords = getNumBasisWords();
+  return getBits(&flatBases[(getFirstColumn(inDim) + pos) * numWords],
+                 getOutDimOffset(outDim), getOutDimSizeLog2(outDim));
+}
+
+int32_t LinearLayout::getFirstColumn(StringAttr inDim) const {
+  int32_t firstCol = 0;
+  for (auto [name, sizeLog2] : inDims) {
+    if (name == inDim) {
+      return firstCol;
+    }
+    firstCol += sizeLog2;
+  }
+  llvm::report_fatal_error("inDim " + Twine(inDim) + " is not in layout" +
+                           toString());
+}
+
+int32_t LinearLayout::getOutDimOffset(StringAttr outDim) const {
+  int32_t offset = 0;
+  for (auto [name, size] : outDims) {
+    if (name == outDim) {
+      return offset;
+    }
+    offset += llvm::Log2_32(size);
+  }
+  llvm::report_fatal_error("outDim " + Twine(outDim) + " is not in layout" +
+                           toString());
+}
+
 int32_t LinearLayout::getOutDimIndex(StringAttr outDim) const {
   int i = 0;
   for (auto [name, _] : outDims) {
@@ -339,9 +535,9 @@ int32_t LinearLayout::getOutDimIndex(StringAttr outDim) const {
 }
 
 int32_t LinearLayout::getInDimSizeLog2(StringAttr inDim) const {
-  auto it = bases.find(inDim);
-  assert(it != bases.end());
-  return it->second.size();
+  auto it = inDims.find(inDim);
+  assert(it != inDims.end());
+  return it->second;
 }
 
 int32_t LinearLayout::getTotalInDimSizeLog2() const {
@@ -365,30 +561,28 @@ int32_t LinearLayout::getTotalOutDimSizeLog2() const {
 }
 
 int32_t LinearLayout::getNumConsecutiveInOut() const {
-  if (bases.empty() || getNumOutDims() == 0)
+  if (inDims.empty() || getNumOutDims() == 0)
     return 1;
 
   // Count how many of the initial bases for the first in-dim are
-  // (2^i, 0, ..., 0).
-  const auto &firstInDimBases = bases.begin()->second;
+  // (2^i, 0, ..., 0), i.e. have the single bit i set.
+  int32_t numWords = getNumBasisWords();
+  int32_t firstOutDimSizeLog2 = llvm::Log2_32(outDims.begin()->second);
+  int32_t numFirstInDimBases =
+      std::min(inDims.begin()->second, firstOutDimSizeLog2);
   int consec = 0;
-  for (; consec < firstInDimBases.size(); consec++) {
-    const auto &basis = firstInDimBases[consec];
-    if (basis[0] != (1 << consec) ||
-        !std::all_of(basis.begin() + 1, basis.end(),
-                     [](int32_t x) { return x == 0; })) {
+  for (; consec < numFirstInDimBases; consec++) {
+    const uint64_t *column = &flatBases[consec * numWords];
+    if (column[0] != (uint64_t(1) << consec) ||
+        !isZeroColumn(column + 1, numWords - 1)) {
       break;
     }
   }
 
   // `or` together all other bases' first out-dim.
   int32_t otherBits = 0;
-  for (const auto &[inDim, inDimBases] : bases) {
-    for (int i = 0; i < inDimBases.size(); i++) {
-      if (inDim != bases.begin()->first || i >= consec) {
-        otherBits |= inDimBases[i][0];
-      }
-    }
+  for (size_t c = consec * numWords; c < flatBases.size(); c += numWords) {
+    otherBits |= getBits(&flatBases[c], 0, firstOutDimSizeLog2);
   }
   int32_t trailingZeros = otherBits != 0 ? __builtin_ctz(otherBits) : 31;
 
@@ -398,40 +592,40 @@ int32_t LinearLayout::getNumConsecutiveInOut() const {
 LinearLayout LinearLayout::transposeIns(ArrayRef<StringAttr> newInDims) const {
   assertDimsEqualIgnoringOrder(newInDims, getInDimNames());
 
-  BasesT newBases;
+  int32_t numWords = getNumBasisWords();
+  llvm::MapVector<StringAttr, int32_t> newInDimSizesLog2;
+  SmallVector<uint64_t> newFlatBases;
+  newFlatBases.reserve(flatBases.size());
   for (const auto &inDim : newInDims) {
-    newBases[inDim] = bases.find(inDim)->second;
+    int32_t sizeLog2 = getInDimSizeLog2(inDim);
+    newInDimSizesLog2[inDim] = sizeLog2;
+    auto first = flatBases.begin() + getFirstColumn(inDim) * numWords;
+    newFlatBases.append(first, first + sizeLog2 * numWords);
   }
-  return LinearLayout(std::move(newBases), llvm::to_vector(outDims),
-                      isSurjective());
+  return LinearLayout(std::move(newInDimSizesLog2), llvm::to_vector(outDims),
+                      std::move(newFlatBases), isSurjective());
 }
 
 LinearLayout
 LinearLayout::transposeOuts(ArrayRef<StringAttr> newOutDims) const {
   assertDimsEqualIgnoringOrder(newOutDims, getOutDimNames());
 
-  std::vector<int32_t> permutation;
-  for (const auto &outDim : newOutDims) {
-    permutation.push_back(getOutDimIndex(outDim));
-  }
-
-  BasesT newBases;
-  for (const auto &[inDim, inDimBases] : bases) {
-    auto &newInDimBases = newBases[inDim];
-    for (const auto &basis : inDimBases) {
-      std::vector<int32_t> newBasis;
-      for (int32_t i : permutation) {
-        newBasis.push_back(basis[i]);
-      }
-      newInDimBases.push_back(std::move(newBasis));
-    }
-  }
-
+  SmallVector<Field> fields;
   SmallVector<std::pair<StringAttr, int32_t>> newOutDimSizes;
+  int32_t pos = 0;
   for (auto outDim : newOutDims) {
+    int32_t sizeLog2 = getOutDimSizeLog2(outDim);
+    fields.push_back({getOutDimOffset(outDim), sizeLog2, pos});
+    pos += sizeLog2;
     newOutDimSizes.push_back({outDim, getOutDimSize(outDim)});
   }
-  return LinearLayout(std::move(newBases), newOutDimSizes, isSurjective());
+
+  int32_t numWords = getNumBasisWords();
+  SmallVector<uint64_t> newFlatBases(flatBases.size(), 0);
+  for (size_t c = 0; c < flatBases.size(); c += numWords)
+    repackColumn(&flatBases[c], fields, &newFlatBases[c]);
+  return LinearLayout(inDims, newOutDimSizes, std::move(newFlatBases),
+                      isSurjective());
 }
 
 LinearLayout LinearLayout::reshapeIns(
@@ -445,25 +639,14 @@ LinearLayout LinearLayout::reshapeIns(
                                                   return acc * inDim.second;
                                                 }));
 
-  // First flatten into a single in-dimension.  Then split it up according
-  // to `newInDims`.
-  SmallVector<std::vector<int32_t>> flatBases;
-  for (const auto &[inDim, inDimBases] : bases) {
-    for (const auto &basis : inDimBases) {
-      flatBases.push_back(basis);
-    }
-  }
-
-  BasesT newBases;
-  int i = 0;
+  // The columns are already flattened across the in-dimensions, so all that
+  // changes is how they are split up.
+  llvm::MapVector<StringAttr, int32_t> newInDimSizesLog2;
   for (const auto &[inDim, inDimSize] : newInDims) {
-    auto &newInDimBases = newBases[inDim];
-    for (int j = 1; j < inDimSize; j *= 2) {
-      newInDimBases.push_back(flatBases[i++]);
-    }
+    newInDimSizesLog2[inDim] += llvm::Log2_32(inDimSize);
   }
-  return LinearLayout(std::move(newBases), llvm::to_vector(outDims),
-                      isSurjective());
+  return LinearLayout(std::move(newInDimSizesLog2), llvm::to_vector(outDims),
+                      flatBases, isSurjective());
 }
 
 LinearLayout LinearLayout::reshapeOuts(
@@ -476,40 +659,10 @@ LinearLayout LinearLayout::reshapeOuts(
              newOutDims.begin(), newOutDims.end(), 1,
              [&](int32_t acc, auto &outDim) { return acc * outDim.second; }));
 
-  SmallVector<int32_t> shifts;
-  shifts.push_back(0);
-  for (StringAttr outDim : getOutDimNames()) {
-    shifts.push_back(shifts.back() + getOutDimSizeLog2(outDim));
-  }
-
-  // Flatten into a single out-dimension.  Then split it up according to
-  // `newOutDims`.
-  llvm::MapVector<StringAttr, std::vector<int32_t>> flatBases;
-  for (const auto &[inDim, inDimBases] : bases) {
-    auto &flatInBases = flatBases[inDim];
-    for (const auto &basis : inDimBases) {
-      int b = 0;
-      for (int i = 0; i < basis.size(); i++) {
-        b += basis[i] << shifts[i];
-      }
-      flatInBases.push_back(b);
-    }
-  }
-
-  BasesT newBases;
-  for (const auto &[inDim, flatInBases] : flatBases) {
-    std::vector<std::vector<int32_t>> &newInDimBases = newBases[inDim];
-    for (int32_t b : flatInBases) {
-      std::vector<int32_t> multiDimBasis;
-      for (int32_t newSize : llvm::make_second_range(newOutDims)) {
-        multiDimBasis.push_back(b % newSize);
-        b /= newSize;
-      }
-      newInDimBases.push_back(std::move(multiDimBasis));
-    }
-  }
-
-  return LinearLayout(std::move(newBases), newOutDims, isSurjective());
+  // A column is the flattened out-coordinate, the first out-dim being the
+  // least significant, so splitting it up according to `newOutDims` leaves it
+  // unchanged.
+  return LinearLayout(inDims, newOutDims, flatBases, isSurjective());
 }
 
 LinearLayout LinearLayout::concatIns(const LinearLayout &other) const {
@@ -521,13 +674,19 @@ LinearLayout LinearLayout::concatIns(const LinearLayout &other) const {
            "layouts must have the same output dimension sizes");
   }
 
-  LinearLayout::BasesT resultBases = getBases();
-  for (auto &bases : other.getBases())
-    resultBases.insert(bases);
-  SmallVector<std::pair<StringAttr, int32_t>> newOutDims;
-  for (auto &[outDim, outDimSize] : outDims)
-    newOutDims.emplace_back(outDim, outDimSize);
-  return LinearLayout(std::move(resultBases), newOutDims,
+  // Both layouts pack their columns the same way.
+  int32_t numWords = getNumBasisWords();
+  llvm::MapVector<StringAttr, int32_t> newInDimSizesLog2 = inDims;
+  SmallVector<uint64_t> newFlatBases = flatBases;
+  for (auto [inDim, sizeLog2] : other.inDims) {
+    if (!newInDimSizesLog2.insert({inDim, sizeLog2}).second)
+      continue;
+    auto first =
+        other.flatBases.begin() + other.getFirstColumn(inDim) * numWords;
+    newFlatBases.append(first, first + sizeLog2 * numWords);
+  }
+  return LinearLayout(std::move(newInDimSizesLog2), llvm::to_vector(outDims),
+                      std::move(newFlatBases),
                       /*requiresSurjective=*/false);
 }
 
@@ -540,24 +699,26 @@ LinearLayout LinearLayout::concatOuts(const LinearLayout &other) const {
            "layouts must have the same input dimension sizes");
   }
 
-  LinearLayout::BasesT result;
-  for (auto [lhsBases, rhsBases] : llvm::zip(getBases(), other.getBases())) {
-    auto &resultBases = result[lhsBases.first];
-    assert(lhsBases.first == rhsBases.first);
-    for (auto [lhsBasis, rhsBasis] :
-         llvm::zip(lhsBases.second, rhsBases.second)) {
-      std::vector<int32_t> resultBasis;
-      llvm::append_range(resultBasis, lhsBasis);
-      llvm::append_range(resultBasis, rhsBasis);
-      resultBases.push_back(std::move(resultBasis));
-    }
-  }
   SmallVector<std::pair<StringAttr, int32_t>> newOutDims;
   for (auto &[outDim, outDimSize] : outDims)
     newOutDims.emplace_back(outDim, outDimSize);
   for (auto &[outDim, outDimSize] : other.outDims)
     newOutDims.emplace_back(outDim, outDimSize);
-  return LinearLayout(std::move(result), newOutDims,
+
+  // Other's coordinates go right above ours.
+  int32_t numBits = getTotalOutDimSizeLog2();
+  int32_t numWords = getNumBasisWords();
+  int32_t otherWords = other.getNumBasisWords();
+  int32_t newWords = getNumWords(numBits + other.getTotalOutDimSizeLog2());
+  int32_t numCols = getTotalInDimSizeLog2();
+  SmallVector<uint64_t> newFlatBases(numCols * newWords, 0);
+  for (int32_t c = 0; c < numCols; c++) {
+    uint64_t *newColumn = &newFlatBases[c * newWords];
+    xorColumn(newColumn, &flatBases[c * numWords], numWords);
+    for (int32_t w = 0; w < otherWords; w++)
+      xorBits(newColumn, numBits + 64 * w, other.flatBases[c * otherWords + w]);
+  }
+  return LinearLayout(inDims, newOutDims, std::move(newFlatBases),
                       /*requiresSurjective=*/false);
 }
 
@@ -742,41 +903,53 @@ LinearLayout operator*(LinearLayout inner, LinearLayout outer) {
     }
   }
 
-  BasesT allBases;
-  for (auto [inDimName, inDimSizeLog2] : inDimSizesLog2) {
-    std::vector<std::vector<int32_t>> &inDimBases = allBases[inDimName];
-
-    // Fill with zeros.
-    inDimBases = std::vector<std::vector<int32_t>>(
-        inDimSizeLog2, std::vector<int32_t>(outDimSizesLog2.size(), 0));
-
-    for (auto [outDimIdx, outDimNameAndSize] :
-         llvm::enumerate(outDimSizesLog2)) {
-      auto [outDimName, outDimSize] = outDimNameAndSize;
-      if (inner.hasInDim(inDimName) && inner.hasOutDim(outDimName)) {
-        for (int i = 0; i < inner.getInDimSizeLog2(inDimName); i++) {
-          inDimBases[i][outDimIdx] = inner.getBasis(inDimName, i, outDimName);
-        }
-      }
-      if (outer.hasInDim(inDimName) && outer.hasOutDim(outDimName)) {
-        int offset =
-            inner.hasInDim(inDimName) ? inner.getInDimSizeLog2(inDimName) : 0;
-        int shift = inner.hasOutDim(outDimName)
-                        ? inner.getOutDimSizeLog2(outDimName)
-                        : 0;
-        for (int i = 0; i < outer.getInDimSizeLog2(inDimName); i++) {
-          inDimBases[offset + i][outDimIdx] =
-              outer.getBasis(inDimName, i, outDimName) << shift;
-        }
-      }
+  // Within each out-dim, inner's coordinate takes the low bits and outer's is
+  // shifted above it.
+  SmallVector<Field> innerFields;
+  SmallVector<Field> outerFields;
+  int32_t pos = 0;
+  for (auto [outDim, sizeLog2] : outDimSizesLog2) {
+    int32_t innerSizeLog2 = 0;
+    if (inner.hasOutDim(outDim)) {
+      innerSizeLog2 = inner.getOutDimSizeLog2(outDim);
+      innerFields.push_back(
+          {inner.getOutDimOffset(outDim), innerSizeLog2, pos});
     }
+    if (outer.hasOutDim(outDim)) {
+      outerFields.push_back({outer.getOutDimOffset(outDim),
+                             outer.getOutDimSizeLog2(outDim),
+                             pos + innerSizeLog2});
+    }
+    pos += sizeLog2;
+  }
+
+  // Within each in-dim, inner's bases come before outer's.
+  int32_t numWords = getNumWords(pos);
+  SmallVector<uint64_t> flatBases;
+  auto appendColumns = [&](const LinearLayout &layout, ArrayRef<Field> fields,
+                           StringAttr inDim) {
+    if (!layout.hasInDim(inDim))
+      return;
+    int32_t layoutWords = layout.getNumBasisWords();
+    const uint64_t *column =
+        layout.flatBases.data() + layout.getFirstColumn(inDim) * layoutWords;
+    for (int32_t i = 0; i < layout.getInDimSizeLog2(inDim); i++) {
+      size_t c = flatBases.size();
+      flatBases.resize(c + numWords, 0);
+      repackColumn(column + i * layoutWords, fields, &flatBases[c]);
+    }
+  };
+  for (StringAttr inDim : inDims) {
+    appendColumns(inner, innerFields, inDim);
+    appendColumns(outer, outerFields, inDim);
   }
 
   llvm::SmallVector<std::pair<StringAttr, int32_t>> outDimSizes;
   for (auto [outDim, sizeLog2] : outDimSizesLog2) {
     outDimSizes.push_back({outDim, 1 << sizeLog2});
   }
-  return LinearLayout(std::move(allBases), outDimSizes,
+  return LinearLayout(std::move(inDimSizesLog2), outDimSizes,
+                      std::move(flatBases),
                       inner.isSurjective() && outer.isSurjective());
 }
 
@@ -845,63 +1018,70 @@ LinearLayout LinearLayout::sublayout(ArrayRef<StringAttr> inDimNames,
   SmallDenseSet<StringAttr> inDimSet(inDimNames.begin(), inDimNames.end());
   SmallDenseSet<StringAttr> outDimSet(outDimNames.begin(), outDimNames.end());
 
-  SmallVector<int> outDimIndicesToKeep;
-  for (auto [i, outDim] : llvm::enumerate(getOutDimNames())) {
+  SmallVector<Field> fields;
+  SmallVector<std::pair<StringAttr, int32_t>> newOutDims;
+  int32_t offset = 0;
+  int32_t pos = 0;
+  for (auto [outDim, outDimSize] : outDims) {
+    int32_t sizeLog2 = llvm::Log2_32(outDimSize);
     if (outDimSet.contains(outDim)) {
-      outDimIndicesToKeep.push_back(i);
+      fields.push_back({offset, sizeLog2, pos});
+      newOutDims.push_back({outDim, outDimSize});
+      pos += sizeLog2;
     }
+    offset += sizeLog2;
   }
-  BasesT newBases;
-  for (auto [inDim, inDimBases] : bases) {
+
+  int32_t numWords = getNumBasisWords();
+  int32_t newWords = getNumWords(pos);
+  llvm::MapVector<StringAttr, int32_t> newInDims;
+  SmallVector<uint64_t> newFlatBases;
+  const uint64_t *column = flatBases.data();
+  for (auto [inDim, sizeLog2] : inDims) {
     if (!inDimSet.contains(inDim)) {
+      column += sizeLog2 * numWords;
       continue;
     }
-    auto &newInDimBases = newBases[inDim];
-    for (auto &basis : inDimBases) {
-      auto &newBasis = newInDimBases.emplace_back();
-      for (int i : outDimIndicesToKeep) {
-        newBasis.push_back(basis[i]);
-      }
+    newInDims[inDim] = sizeLog2;
+    for (int32_t i = 0; i < sizeLog2; i++, column += numWords) {
+      size_t c = newFlatBases.size();
+      newFlatBases.resize(c + newWords, 0);
+      repackColumn(column, fields, &newFlatBases[c]);
     }
   }
-
-  SmallVector<std::pair<StringAttr, int32_t>> newOutDims;
-  for (auto [outDim, outDimSize] : outDims) {
-    if (outDimSet.contains(outDim)) {
-      newOutDims.push_back({outDim, outDimSize});
-    }
-  }
-  return LinearLayout(std::move(newBases), std::move(newOutDims),
+  return LinearLayout(std::move(newInDims), newOutDims,
+                      std::move(newFlatBases),
                       /*requireSurjective=*/false);
 }
 
 bool LinearLayout::sublayoutIsZero(ArrayRef<StringAttr> inDimNames,
                                    ArrayRef<StringAttr> outDimNames) const {
   LinearLayout ss = sublayout(inDimNames, outDimNames);
-  for (auto [inDim, inDimBases] : ss.bases) {
-    for (auto basis : inDimBases) {
-      if (!llvm::all_of(basis, [](int32_t b) { return b == 0; })) {
-        return false;
-      }
-    }
-  }
-  return true;
+  return llvm::all_of(ss.flatBases, [](uint64_t word) { return word == 0; });
 }
 
 SmallVector<std::pair<StringAttr, int32_t>>
 LinearLayout::apply(ArrayRef<std::pair<StringAttr, int32_t>> ins) const {
   assertDimsEqualIgnoringOrder(llvm::make_first_range(ins), getInDimNames());
 
-  SmallVector<std::pair<StringAttr, int32_t>> ret;
-  for (StringAttr outDim : getOutDimNames()) {
-    int32_t outVal = 0;
-    for (auto &[inDim, val] : ins) {
-      for (int i = 0; i < getInDimSizeLog2(inDim); i++) {
-        if (val & (1 << i))
-          outVal ^= getBasis(inDim, i, outDim);
-      }
+  int32_t numWords = getNumBasisWords();
+  SmallVector<uint64_t, 1> outVal(numWords, 0);
+  for (auto &[inDim, val] : ins) {
+    const uint64_t *columns =
+        flatBases.data() + getFirstColumn(inDim) * numWords;
+    uint64_t inBits = val & ((uint64_t(1) << getInDimSizeLog2(inDim)) - 1);
+    for (; inBits != 0; inBits &= inBits - 1) {
+      xorColumn(outVal.data(), columns + __builtin_ctzll(inBits) * numWords,
+                numWords);
     }
-    ret.push_back({outDim, outVal});
+  }
+
+  SmallVector<std::pair<StringAttr, int32_t>> ret;
+  int32_t pos = 0;
+  for (auto [outDim, size] : outDims) {
+    int32_t sizeLog2 = llvm::Log2_32(size);
+    ret.push_back({outDim, getBits(outVal.data(), pos, sizeLog2)});
+    pos += sizeLog2;
   }
   return ret;
 }
@@ -912,18 +1092,35 @@ LinearLayout LinearLayout::compose(const LinearLayout &outer) const {
     assert(getOutDimSize(outDim) <= outer.getInDimSize(outDim));
   }
 
-  BasesT newBases;
-  for (const auto &[inDim, inDimBases] : bases) {
-    auto &newInDimBases = newBases[inDim];
-    for (const auto &basis : inDimBases) {
-      SmallVector<std::pair<StringAttr, int32_t>> bases;
-      for (auto [outDim, b] : llvm::zip(getOutDimNames(), basis)) {
-        bases.push_back({outDim, b});
+  // Our out-dim j is read from the bits starting at offsets[j], and feeds
+  // outer's columns starting at outerColumns[j].
+  int32_t numWords = getNumBasisWords();
+  int32_t outerWords = outer.getNumBasisWords();
+  SmallVector<int32_t> offsets;
+  SmallVector<int32_t> sizesLog2;
+  SmallVector<const uint64_t *> outerColumns;
+  int32_t offset = 0;
+  for (auto [outDim, size] : outDims) {
+    offsets.push_back(offset);
+    sizesLog2.push_back(llvm::Log2_32(size));
+    offset += sizesLog2.back();
+    outerColumns.push_back(outer.flatBases.data() +
+                           outer.getFirstColumn(outDim) * outerWords);
+  }
+
+  // Each of our bases selects a set of outer's columns, and the composed basis
+  // is their XOR.
+  int32_t numCols = getTotalInDimSizeLog2();
+  SmallVector<uint64_t> newFlatBases(numCols * outerWords, 0);
+  for (int32_t c = 0; c < numCols; c++) {
+    const uint64_t *column = &flatBases[c * numWords];
+    uint64_t *newColumn = &newFlatBases[c * outerWords];
+    for (auto [j, outerColumn] : llvm::enumerate(outerColumns)) {
+      uint64_t bits = getBits(column, offsets[j], sizesLog2[j]);
+      for (; bits != 0; bits &= bits - 1) {
+        xorColumn(newColumn, outerColumn + __builtin_ctzll(bits) * outerWords,
+                  outerWords);
       }
-      auto newBases = outer.apply(bases);
-      auto newBasesRange = llvm::make_second_range(newBases);
-      newInDimBases.push_back(
-          std::vector<int32_t>(newBasesRange.begin(), newBasesRange.end()));
     }
   }
 
@@ -932,110 +1129,68 @@ LinearLayout LinearLayout::compose(const LinearLayout &outer) const {
       llvm::all_of(getOutDimNames(), [&](StringAttr outDim) {
         return getOutDimSize(outDim) == outer.getInDimSize(outDim);
       });
-  return LinearLayout(std::move(newBases), llvm::to_vector(outer.outDims),
-                      compositionIsSurjective);
-}
-
-namespace {
-std::unique_ptr<uint64_t[]> concatMatrices(const LinearLayout &A,
-                                           const LinearLayout &B) {
-  // conv
-  assert(A.getTotalOutDimSizeLog2() >= B.getTotalOutDimSizeLog2() &&
-         "A must have at least as many output bits as B");
-  int numColsA = A.getTotalInDimSizeLog2();
-
-  // rref expects the lower bits to be the lower indices of the matrix
-  auto concat = getMatrix(A);
-  auto BMat = getMatrix(B);
-  int rowA = 0;
-  int rowB = 0;
-  for (auto [outDim, outDimSize] : A.getOutDims()) {
-    for (int r = 0; r < llvm::Log2_32(outDimSize); r++) {
-      if (r < llvm::Log2_32(B.getOutDimSize(outDim))) {
-        concat[rowA] |= BMat[rowB] << numColsA;
-        rowB++;
-      }
-      rowA++;
-    }
-  }
-  return concat;
+  return LinearLayout(inDims, llvm::to_vector(outer.outDims),
+                      std::move(newFlatBases), compositionIsSurjective);
 }
 
-LinearLayout lstsq(const LinearLayout &A, const LinearLayout &B) {
+/*static*/ LinearLayout LinearLayout::lstsq(const LinearLayout &A,
+                                            const LinearLayout &B) {
   // Solve the least square system AX = B
-  // and return the least square solution X by computing RREF and setting
-  // the free variables to zero.
+  // and return the least square solution X by setting the free variables to
+  // zero.
   // A and B may not be surjective, but we assume that Im(B) \subset Im(A)
-  // Sketch of the algorithm:
-  // https://github.com/triton-lang/triton/pull/5309#discussion_r1869084111
-  int numRows = A.getTotalOutDimSizeLog2();
-  assert(numRows >= B.getTotalOutDimSizeLog2() &&
+  //
+  // The columns of A that are not in the span of the columns before them are
+  // the pivot columns of its reduced row echelon form, and they are a basis
+  // of Im(A).  So each column of B is a unique sum of pivot columns, which
+  // we find by reducing it against them.  The tag of each column records
+  // which of A's columns it was reduced by, and that is the column of X.
+  assert(A.getTotalOutDimSizeLog2() >= B.getTotalOutDimSizeLog2() &&
          "A.lstsq(B) called with incompatible output shapes");
-  int numColsA = A.getTotalInDimSizeLog2();
-  int numColsB = B.getTotalInDimSizeLog2();
-  int numCols = numColsA + numColsB;
-  std::unique_ptr<uint64_t[]> combinedMat = concatMatrices(A, B);
-  f2reduce::inplace_rref_strided(combinedMat.get(), numRows, numCols,
-                                 /*stride=*/1);
-
-  // Compute the pivot columns
-  // Since A and B have the same image, each row will either have a pivot
-  // or will be all zeros
-  SmallVector<int32_t> pivotRowOfCol(numColsA, -1);
-  for (int r = 0; r < numRows; r++) {
-    auto row = combinedMat[r];
-    if (row == 0) {
-      continue;
-    }
-    int c = __builtin_ctzll(row);
-    assert(c < numColsA && "Precondition broken. Im(B) not contained in Im(A)");
-    assert(pivotRowOfCol[c] == -1 &&
-           "duplicate pivot => matrix not in RREF or A not injective");
-    pivotRowOfCol[c] = r;
-  }
-
-  // Extract A^{-1}B and complete the matrix using zeros
-  std::unique_ptr<uint64_t[]> retMat(new uint64_t[numColsA]());
-  for (int c = 0; c < numColsA; ++c) {
-    int row = pivotRowOfCol[c];
-    retMat[c] = (row == -1) ? 0 : (combinedMat[row] >> numColsA);
-  }
-
-  // We need names for the in/out dim of the flattened layout we're going to
-  // read off from `m`.  These could be anything, doesn't matter.
-  assert(!A.getInDimNames().empty() &&
-         "attempt to solve lstsq for empty layout");
-  StringAttr inDim1D = *A.getInDimNames().begin();
-  StringAttr outDim1D = *A.getOutDimNames().begin();
-
-  // Read off the new bases.  These are for a flattened 1D -> 1D
-  LinearLayout::BasesT retBases;
-  auto &bs = retBases[inDim1D];
-  for (int c = 0; c < numColsB; c++) {
-    int32_t basis = 0;
-    for (int r = 0; r < numColsA; r++) {
-      basis |= (retMat[r] >> c & 1) << r;
-    }
-    bs.push_back({basis});
+  int32_t numColsA = A.getTotalInDimSizeLog2();
+  int32_t numWords = A.getNumBasisWords();
+  int32_t numTagWords = getNumWords(numColsA);
+  ColumnEchelon echelon(numWords, numTagWords);
+  SmallVector<uint64_t> column(numWords);
+  SmallVector<uint64_t> tag(numTagWords);
+  for (int32_t c = 0; c < numColsA; c++) {
+    std::copy_n(&A.flatBases[c * numWords], numWords, column.begin());
+    std::fill(tag.begin(), tag.end(), 0);
+    xorBits(tag.data(), c, 1);
+    echelon.reduceOrInsert(column.data(), tag.data());
+  }
+
+  // B's out-dims are a prefix of each of A's.
+  SmallVector<Field> fields;
+  for (auto [outDim, size] : B.outDims) {
+    assert(A.getOutDimSize(outDim) >= size);
+    fields.push_back({B.getOutDimOffset(outDim), llvm::Log2_32(size),
+                      A.getOutDimOffset(outDim)});
+  }
+
+  // X packs A's in-dims as its out-dims, so its c'th bit is A's c'th column.
+  int32_t numColsB = B.getTotalInDimSizeLog2();
+  int32_t wordsB = B.getNumBasisWords();
+  SmallVector<uint64_t> retFlatBases;
+  retFlatBases.reserve(numColsB * numTagWords);
+  for (int32_t c = 0; c < numColsB; c++) {
+    std::fill(column.begin(), column.end(), 0);
+    std::fill(tag.begin(), tag.end(), 0);
+    repackColumn(&B.flatBases[c * wordsB], fields, column.data());
+    bool inSpan = echelon.reduce(column.data(), tag.data());
+    assert(inSpan && "Precondition broken. Im(B) not contained in Im(A)");
+    (void)inSpan;
+    retFlatBases.append(tag.begin(), tag.end());
   }
 
-  LinearLayout retFlattened(std::move(retBases),
-                            {{outDim1D, A.getTotalInDimSize()}},
-                            /*requireSurjective=*/false);
-
-  SmallVector<std::pair<StringAttr, int32_t>> retInDims;
   SmallVector<std::pair<StringAttr, int32_t>> retOutDims;
-  for (StringAttr dim : B.getInDimNames()) {
-    retInDims.push_back({dim, B.getInDimSize(dim)});
-  }
   for (StringAttr dim : A.getInDimNames()) {
     retOutDims.push_back({dim, A.getInDimSize(dim)});
   }
-  return retFlattened.reshapeIns(retInDims).reshapeOuts(retOutDims);
+  return LinearLayout(B.inDims, retOutDims, std::move(retFlatBases),
+                      /*requireSurjective=*/false);
 }
 
-} // namespace
-
 LinearLayout LinearLayout::invertAndCompose(const LinearLayout &outer) const {
   // TODO(Lezcano) Make friend and perhaps rename to `convertFrom` or `lstsq`
   // For this, we need to implement our LLVM lowerings by inverting the "outer"
@@ -1131,31 +1286,18 @@ LinearLayout LinearLayout::pseudoinvert() const {
 
 llvm::MapVector<StringAttr, int32_t>
 LinearLayout::getFreeVariableMasks() const {
-  std::unique_ptr<uint64_t[]> mat = getMatrix(*this);
-  int numRows = getTotalOutDimSizeLog2();
-  int numCols = getTotalInDimSizeLog2();
-
-  // stride is specified in number of 64-bit words per row, and we pack our
-  // matrix so that there's only one uint64_t per row.
-  assert(numCols <= 64);
-  f2reduce::inplace_rref_strided(mat.get(), numRows, numCols, /*stride=*/1);
-
-  // For each row in the RREF matrix, identify the column with the first "1".
-  // These columns correspond to the basic (i.e. non-free) variables.
-  std::set<int32_t> basicVars;
-  for (int r = 0; r < numRows; r++) {
-    if (mat[r] == 0) {
-      continue;
-    }
-    basicVars.insert(__builtin_ctzll(mat[r]));
-  }
-
+  // A variable is free iff its column is in the span of the columns before
+  // it, i.e. iff it is not a pivot column of the reduced row echelon form.
+  int32_t numWords = getNumBasisWords();
+  ColumnEchelon echelon(numWords, /*numTagWords=*/0);
+  SmallVector<uint64_t> column(numWords);
   llvm::MapVector<StringAttr, int32_t> ret;
-  int c = 0;
-  for (StringAttr dim : getInDimNames()) {
+  const uint64_t *src = flatBases.data();
+  for (auto [dim, sizeLog2] : inDims) {
     int32_t mask = 0;
-    for (int i = 0; i < getInDimSizeLog2(dim); i++, c++) {
-      if (basicVars.count(c) == 0) {
+    for (int i = 0; i < sizeLog2; i++, src += numWords) {
+      std::copy_n(src, numWords, column.begin());
+      if (echelon.reduceOrInsert(column.data(), /*tag=*/nullptr)) {
         mask |= (1 << i);
       }
     }
@@ -1165,44 +1307,37 @@ LinearLayout::getFreeVariableMasks() const {
 }
 
 LinearLayout LinearLayout::removeZeroBasesAlongDim(StringAttr stripDim) const {
-  LinearLayout::BasesT result;
-  for (auto &[inDim, inDimBases] : getBases()) {
-    auto &newInDimBases = result[inDim];
-    if (inDim != stripDim) {
-      newInDimBases = inDimBases;
-      continue;
-    }
-    for (auto &basis : inDimBases) {
-      if (llvm::any_of(basis, [](int32_t val) { return val != 0; })) {
-        newInDimBases.push_back(basis);
+  int32_t numWords = getNumBasisWords();
+  llvm::MapVector<StringAttr, int32_t> newInDims;
+  SmallVector<uint64_t> newFlatBases;
+  const uint64_t *column = flatBases.data();
+  for (auto [inDim, sizeLog2] : inDims) {
+    int32_t newSizeLog2 = 0;
+    for (int32_t i = 0; i < sizeLog2; i++, column += numWords) {
+      if (inDim != stripDim || !isZeroColumn(column, numWords)) {
+        newFlatBases.append(column, column + numWords);
+        newSizeLog2++;
       }
     }
+    newInDims[inDim] = newSizeLog2;
   }
-  SmallVector<std::pair<StringAttr, int32_t>> newOutDimSizes;
-  for (auto outDim : getOutDimNames()) {
-    newOutDimSizes.push_back({outDim, getOutDimSize(outDim)});
-  }
-  auto newLayout = LinearLayout(std::move(result), ArrayRef(newOutDimSizes),
-                                this->isSurjective());
-  return newLayout;
+  return LinearLayout(std::move(newInDims), llvm::to_vector(outDims),
+                      std::move(newFlatBases), this->isSurjective());
 }
 
 size_t hash_value(const LinearLayout &layout) {
   size_t seed = 0;
 
-  // Hash the bases
-  for (const auto &base : layout.getBases()) {
-    // Hash the input dimension name
-    seed = llvm::hash_combine(seed, base.first);
-
-    // Hash the vectors in bases
-    for (const auto &vec : base.second) {
-      for (int32_t val : vec) {
-        seed = llvm::hash_combine(seed, val);
-      }
-    }
+  // Hash the input dimensions and their sizes
+  for (auto [inDim, sizeLog2] : layout.inDims) {
+    seed = llvm::hash_combine(seed, inDim, sizeLog2);
   }
 
+  // Hash the bases
+  seed = llvm::hash_combine(seed, llvm::hash_combine_range(
+                                      layout.flatBases.begin(),
+                                      layout.flatBases.end()));
+
   // Hash the output dimensions and their sizes
   for (const auto &outDim : layout.getOutDimNames()) {
     seed = llvm::hash_combine(seed, outDim, layout.getOutDimSize(outDim));
@@ -1212,15 +1347,9 @@ size_t hash_value(const LinearLayout &layout) {
 }
 
 bool operator==(const LinearLayout &lhs, const LinearLayout &rhs) {
-  if (!lhs.equalIgnoringOutDimSizes(rhs))
-    return false;
-
-  for (const auto &[lhsOutDimAndSize, rhsOutDimAndSize] :
-       llvm::zip(lhs.outDims, rhs.outDims)) {
-    if (lhsOutDimAndSize.second != rhsOutDimAndSize.second)
-      return false;
-  }
-  return true;
+  return llvm::equal(lhs.inDims, rhs.inDims) &&
+         llvm::equal(lhs.outDims, rhs.outDims) &&
+         llvm::equal(lhs.flatBases, rhs.flatBases);
 }
 
 bool LinearLayout::equalIgnoringOutDimSizes(const LinearLayout &other) const {
@@ -1228,55 +1357,16 @@ bool LinearLayout::equalIgnoringOutDimSizes(const LinearLayout &other) const {
   if (llvm::to_vector(this->getOutDimNames()) !=
       llvm::to_vector(other.getOutDimNames()))
     return false;
-  if (this->bases.size() != other.bases.size())
+  if (!llvm::equal(this->inDims, other.inDims))
     return false;
-  for (auto it1 = this->bases.begin(), it2 = other.bases.begin();
-       it1 != this->bases.end(); ++it1, ++it2) {
-    if (*it1 != *it2)
-      return false;
-  }
-  return true;
+  // The columns are only packed the same way if the sizes match.
+  if (llvm::equal(this->outDims, other.outDims))
+    return llvm::equal(this->flatBases, other.flatBases);
+  return llvm::equal(this->getBases(), other.getBases());
 }
 
 std::string LinearLayout::toString() const {
-  // Start with a newline because we print out a bulleted list; it doesn't
-  // make sense for the first line of this list to be on the same line as
-  // any previous text.
-  std::string ret = "\n";
-  std::string outDimsStr =
-      "[" +
-      join(outDims, ", ",
-           [](auto dimAndSize) {
-             auto [outDim, size] = dimAndSize;
-             return outDim.str() + " (size " + std::to_string(size) + ")";
-           }) +
-      "]";
-
-  if (bases.empty()) {
-    if (outDims.empty()) {
-      return "\n(empty layout)";
-    } else {
-      return "\n(empty layout with out-dims " + outDimsStr + ")";
-    }
-  }
-
-  // TODO: Add spaces for alignment.
-  for (const auto &[inDim, inDimBases] : bases) {
-    if (inDimBases.empty()) {
-      ret += " - " + inDim.str() + " is a size 1 dimension\n";
-      continue;
-    }
-
-    ret += " - " +
-           join(llvm::seq(inDimBases.size()), "\n   ",
-                [&, &inDim = inDim, &inDimBases = inDimBases](int i) {
-                  return inDim.str() + "=" + std::to_string(1 << i) + " -> (" +
-                         join(inDimBases[i], ", ") + ")";
-                }) +
-           "\n";
-  }
-  ret += "where out dims are: " + outDimsStr;
-  return ret;
+  return layoutToString(getBases(), outDims);
 }
 
 LinearLayout ColumnAction::apply(const LinearLayout &layout) const {
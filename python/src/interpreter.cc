@@ -607,6 +607,78 @@ makeAtomicRMWOp(pybind11::dtype dtype, const uint64_t *ptr, const void *val,
   return atomic_op;
 }
 
+// Calls `fn` with the element size as a compile-time constant for the common
+// sizes, so the per-element copies below become a single load and store.  Any
+// other size is passed as 0 and handled at runtime.
+template <typename Fn> void dispatchItemSize(size_t itemsize, Fn &&fn) {
+  switch (itemsize) {
+  case 1:
+    return fn(std::integral_constant<size_t, 1>{});
+  case 2:
+    return fn(std::integral_constant<size_t, 2>{});
+  case 4:
+    return fn(std::integral_constant<size_t, 4>{});
+  case 8:
+    return fn(std::integral_constant<size_t, 8>{});
+  default:
+    return fn(std::integral_constant<size_t, 0>{});
+  }
+}
+
+// Length of the run of unmasked elements starting at `i` whose addresses are
+// consecutive, so that they can be moved with a single memcpy.
+inline size_t contiguousRun(const uint64_t *ptrs, const bool *mask, size_t i,
+                            size_t numel, size_t itemsize) {
+  size_t end = i + 1;
+  while (end < numel && mask[end] && ptrs[end] == ptrs[end - 1] + itemsize)
+    ++end;
+  return end - i;
+}
+
+// Gathers the unmasked elements addressed by `ptrs` into the dense buffer
+// `dst`, taking masked-off elements from `other`.  A fully contiguous block
+// ends up as one memcpy.
+template <size_t ItemSize>
+void gatherLoad(const uint64_t *ptrs, const bool *mask, const char *other,
+                ptrdiff_t other_stride, char *dst, size_t numel,
+                size_t itemsize) {
+  const size_t size = ItemSize ? ItemSize : itemsize;
+  for (size_t i = 0; i < numel;) {
+    if (!mask[i]) {
+      memcpy(dst + i * size, other + i * other_stride, size);
+      ++i;
+      continue;
+    }
+    size_t run = contiguousRun(ptrs, mask, i, numel, size);
+    if (run == 1)
+      memcpy(dst + i * size, reinterpret_cast<const void *>(ptrs[i]), size);
+    else
+      memcpy(dst + i * size, reinterpret_cast<const void *>(ptrs[i]),
+             run * size);
+    i += run;
+  }
+}
+
+// Scatters the dense buffer `src` to the unmasked addresses in `ptrs`, in
+// order, so that the last of several stores to the same address wins.
+template <size_t ItemSize>
+void scatterStore(const uint64_t *ptrs, const bool *mask, const char *src,
+                  size_t numel, size_t itemsize) {
+  const size_t size = ItemSize ? ItemSize : itemsize;
+  for (size_t i = 0; i < numel;) {
+    if (!mask[i]) {
+      ++i;
+      continue;
+    }
+    size_t run = contiguousRun(ptrs, mask, i, numel, size);
+    if (run == 1)
+      memcpy(reinterpret_cast<void *>(ptrs[i]), src + i * size, size);
+    else
+      memcpy(reinterpret_cast<void *>(ptrs[i]), src + i * size, run * size);
+    i += run;
+  }
+}
+
 } // namespace
 
 void init_triton_interpreter(py::module &&m) {
@@ -633,39 +705,49 @@ void init_triton_interpreter(py::module &&m) {
       .export_values();
 
   m.def("load",
-        [](py::array_t<uint64_t> ptr, py::array_t<bool> mask, py::array other,
-           py::dtype ret_dtype) -> py::array {
+        [](py::array_t<uint64_t, py::array::c_style | py::array::forcecast> ptr,
+           py::array_t<bool, py::array::c_style | py::array::forcecast> mask,
+           py::array other, py::dtype ret_dtype) -> py::array {
           int numel = ptr.size();
           auto shape =
               std::vector<ptrdiff_t>(ptr.shape(), ptr.shape() + ptr.ndim());
           py::array ret(ret_dtype, py::array::ShapeContainer{numel});
-          py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
-          py::array_t<bool> reshaped_mask = mask.reshape({numel});
           py::array reshaped_others = other.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i))
-              memcpy(ret.mutable_data(i),
-                     reinterpret_cast<void *>(reshaped_ptr.at(i)),
-                     ret_dtype.itemsize());
-            else
-              memcpy(ret.mutable_data(i), reshaped_others.data(i),
-                     ret_dtype.itemsize());
+          auto *ptrs = ptr.data();
+          auto *masks = mask.data();
+          auto *others = static_cast<const char *>(reshaped_others.data());
+          auto others_stride = reshaped_others.strides(0);
+          auto *ret_data = static_cast<char *>(ret.mutable_data());
+          auto itemsize = ret_dtype.itemsize();
+          {
+            // The copy doesn't touch Python objects, so other interpreter
+            // threads can run while it's in progress.
+            py::gil_scoped_release release;
+            dispatchItemSize(itemsize, [&](auto size) {
+              gatherLoad<decltype(size)::value>(ptrs, masks, others,
+                                                others_stride, ret_data, numel,
+                                                itemsize);
+            });
           }
           return ret.reshape(shape);
         });
 
   m.def("store",
-        [](py::array_t<uint64_t> ptr, py::array value, py::array_t<bool> mask) {
+        [](py::array_t<uint64_t, py::array::c_style | py::array::forcecast> ptr,
+           py::array value,
+           py::array_t<bool, py::array::c_style | py::array::forcecast> mask) {
           int numel = ptr.size();
-          py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
-          py::array_t<int8_t> reshaped_mask = mask.reshape({numel});
-          py::array reshaped_value = value.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i)) {
-              memcpy(reinterpret_cast<void *>(reshaped_ptr.mutable_at(i)),
-                     reshaped_value.data(i), value.dtype().itemsize());
-            }
-          }
+          py::array dense_value =
+              py::array::ensure(value.reshape({numel}), py::array::c_style);
+          auto *ptrs = ptr.data();
+          auto *masks = mask.data();
+          auto *values = static_cast<const char *>(dense_value.data());
+          auto itemsize = value.dtype().itemsize();
+          py::gil_scoped_release release;
+          dispatchItemSize(itemsize, [&](auto size) {
+            scatterStore<decltype(size)::value>(ptrs, masks, values, numel,
+                                                itemsize);
+          });
         });
 
   m.def("atomic_rmw",
@@ -711,7 +793,10 @@ void init_triton_interpreter(py::module &&m) {
 
 #undef MAKE_ATOMIC_RMW_OP
 
-          atomic_op->apply();
+          {
+            py::gil_scoped_release release;
+            atomic_op->apply();
+          }
           return ret.reshape(shape);
         });
 
@@ -731,10 +816,13 @@ void init_triton_interpreter(py::module &&m) {
           memcpy(static_cast<void *>(ret.mutable_data()),
                  static_cast<const void *>(reshaped_cmp.data()),
                  itemsize * numel);
-          AtomicCASOp(reshaped_ptr.data(), ret.mutable_data(),
-                      static_cast<const void *>(reshaped_val.data()), itemsize,
-                      numel, order)
-              .apply();
+          AtomicCASOp cas_op(reshaped_ptr.data(), ret.mutable_data(),
+                             static_cast<const void *>(reshaped_val.data()),
+                             itemsize, numel, order);
+          {
+            py::gil_scoped_release release;
+            cas_op.apply();
+          }
           return ret.reshape(shape);
         });
 }
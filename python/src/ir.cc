@@ -1,5 +1,7 @@
 #include "ir.h"
 
+#include <chrono>
+#include <mutex>
 #include <optional>
 #include <pybind11/cast.h>
 #include <pybind11/functional.h>
@@ -19,6 +21,7 @@
 #include "mlir/IR/Verifier.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LLVM.h"
@@ -26,6 +29,7 @@
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Transforms/LocationSnapshot.h"
 
+#include "triton/Analysis/AxisInfo.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "triton/Dialect/Gluon/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
@@ -36,6 +40,7 @@
 #include "triton/Dialect/TritonNvidiaGPU/Transforms/TMAUtilities.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/SourceMgr.h"
 
 #include "third_party/proton/dialect/include/Dialect/Proton/IR/Dialect.h"
@@ -156,6 +161,192 @@ OpPrintingFlags getOpPrintingFlags() {
   return printingFlags;
 }
 
+// Cost of a single pass execution, as seen by PassTelemetry.
+struct PassRecord {
+  std::string pass;
+  std::string anchor;
+  int64_t timeUs = 0;
+  int64_t opsBefore = 0;
+  int64_t opsAfter = 0;
+  int64_t convertLayoutsBefore = 0;
+  int64_t convertLayoutsAfter = 0;
+  uint64_t linearLayoutHits = 0;
+  uint64_t linearLayoutMisses = 0;
+  uint64_t linearEncodingHits = 0;
+  uint64_t linearEncodingMisses = 0;
+  uint64_t axisInfoSolverRuns = 0;
+  size_t mallocBytes = 0;
+  bool failed = false;
+};
+
+// Set per thread by `ir.enable_pass_telemetry`, so that the passes a compile
+// runs are measured without threading a flag through every backend stage.
+thread_local bool passTelemetryEnabled = false;
+thread_local std::vector<PassRecord> passTelemetryBuffer;
+
+// Records the wall time, IR size and layout cache activity of every pass a
+// pass manager runs. Nested pass managers run passes on several threads, so
+// in-flight passes are keyed by the pass and the operation they run on.
+//
+// It is installed once, when a pass manager is created with telemetry
+// enabled, and registered under that pass manager so that `run` can take the
+// records of each run.
+class PassTelemetry : public PassInstrumentation {
+public:
+  explicit PassTelemetry(PassManager *pm) : pm(pm) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry[pm] = this;
+  }
+
+  ~PassTelemetry() override {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.erase(pm);
+  }
+
+  // Returns the telemetry installed on `pm`, if any.
+  static PassTelemetry *lookup(PassManager *pm) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return registry.lookup(pm);
+  }
+
+  // Returns the records of the last run and starts an empty sink for the
+  // next one.
+  std::vector<PassRecord> takeRecords() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::exchange(records, {});
+  }
+
+  void runBeforePass(Pass *pass, Operation *op) override {
+    if (!isMeasured(pass))
+      return;
+    InFlight inFlight;
+    std::tie(inFlight.record.opsBefore,
+             inFlight.record.convertLayoutsBefore) = countOps(op);
+    inFlight.cacheStats = getCacheStats(op->getContext());
+    inFlight.axisInfoSolverRuns =
+        triton::ModuleAxisInfoAnalysis::getNumSolverRuns();
+    inFlight.start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    inFlights[{pass, op}] = std::move(inFlight);
+  }
+
+  void runAfterPass(Pass *pass, Operation *op) override {
+    finish(pass, op, /*failed=*/false);
+  }
+
+  void runAfterPassFailed(Pass *pass, Operation *op) override {
+    finish(pass, op, /*failed=*/true);
+  }
+
+private:
+  using CacheStats =
+      std::pair<triton::gpu::CacheStats, triton::gpu::CacheStats>;
+
+  struct InFlight {
+    PassRecord record;
+    CacheStats cacheStats;
+    uint64_t axisInfoSolverRuns = 0;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  // Pass adaptors only run the nested pass managers, whose passes are
+  // measured on their own.
+  static bool isMeasured(Pass *pass) { return !pass->getArgument().empty(); }
+
+  static std::pair<int64_t, int64_t> countOps(Operation *op) {
+    int64_t numOps = 0, numConvertLayouts = 0;
+    op->walk([&](Operation *nested) {
+      ++numOps;
+      if (isa<triton::gpu::ConvertLayoutOp>(nested))
+        ++numConvertLayouts;
+    });
+    return {numOps, numConvertLayouts};
+  }
+
+  static CacheStats getCacheStats(MLIRContext *context) {
+    auto *dialect = context->getLoadedDialect<triton::gpu::TritonGPUDialect>();
+    if (!dialect)
+      return {};
+    return {dialect->getLinearLayoutCache().getStats(),
+            dialect->getLinearEncodingCache().getStats()};
+  }
+
+  void finish(Pass *pass, Operation *op, bool failed) {
+    if (!isMeasured(pass))
+      return;
+    auto end = std::chrono::steady_clock::now();
+    InFlight inFlight;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = inFlights.find({pass, op});
+      if (it == inFlights.end())
+        return;
+      inFlight = std::move(it->second);
+      inFlights.erase(it);
+    }
+    PassRecord &record = inFlight.record;
+    record.pass = pass->getArgument().str();
+    record.anchor = op->getName().getStringRef().str();
+    record.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                        end - inFlight.start)
+                        .count();
+    std::tie(record.opsAfter, record.convertLayoutsAfter) = countOps(op);
+    // The caches are shared by the whole context, so passes that run
+    // concurrently on different functions see each other's lookups.
+    auto [linearLayout, linearEncoding] = getCacheStats(op->getContext());
+    record.linearLayoutHits =
+        linearLayout.hits - inFlight.cacheStats.first.hits;
+    record.linearLayoutMisses =
+        linearLayout.misses - inFlight.cacheStats.first.misses;
+    record.linearEncodingHits =
+        linearEncoding.hits - inFlight.cacheStats.second.hits;
+    record.linearEncodingMisses =
+        linearEncoding.misses - inFlight.cacheStats.second.misses;
+    // The counter is process wide, like the caches above.
+    record.axisInfoSolverRuns =
+        triton::ModuleAxisInfoAnalysis::getNumSolverRuns() -
+        inFlight.axisInfoSolverRuns;
+    record.mallocBytes = llvm::sys::Process::GetMallocUsage();
+    record.failed = failed;
+    std::lock_guard<std::mutex> lock(mutex);
+    records.push_back(std::move(record));
+  }
+
+  static inline std::mutex registryMutex;
+  static inline llvm::DenseMap<PassManager *, PassTelemetry *> registry;
+
+  PassManager *pm;
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<Pass *, Operation *>, InFlight> inFlights;
+  std::vector<PassRecord> records;
+};
+
+py::dict passRecordToDict(const PassRecord &record) {
+  py::dict dict;
+  dict["pass"] = record.pass;
+  dict["anchor"] = record.anchor;
+  dict["time_us"] = record.timeUs;
+  dict["ops_before"] = record.opsBefore;
+  dict["ops_after"] = record.opsAfter;
+  dict["convert_layouts_before"] = record.convertLayoutsBefore;
+  dict["convert_layouts_after"] = record.convertLayoutsAfter;
+  dict["linear_layout_hits"] = record.linearLayoutHits;
+  dict["linear_layout_misses"] = record.linearLayoutMisses;
+  dict["linear_encoding_hits"] = record.linearEncodingHits;
+  dict["linear_encoding_misses"] = record.linearEncodingMisses;
+  dict["axis_info_solver_runs"] = record.axisInfoSolverRuns;
+  dict["malloc_bytes"] = record.mallocBytes;
+  dict["failed"] = record.failed;
+  return dict;
+}
+
+py::list passRecordsToList(const std::vector<PassRecord> &records) {
+  py::list list;
+  for (const auto &record : records)
+    list.append(passRecordToDict(record));
+  return list;
+}
+
 py::list getTensorDescMetadata(ModuleOp &mod) {
   py::list result;
   triton::FuncOp kernelFunc;
@@ -293,12 +484,59 @@ void init_triton_ir(py::module &&m) {
              self.printStackTraceOnDiagnostic(v);
            })
       .def("disable_multithreading",
-           [](MLIRContext &self) { self.disableMultithreading(); });
+           [](MLIRContext &self) { self.disableMultithreading(); })
+      .def("enable_multithreading",
+           [](MLIRContext &self) { self.enableMultithreading(); })
+      .def("is_multithreading_enabled",
+           [](MLIRContext &self) { return self.isMultithreadingEnabled(); })
+      .def("get_layout_cache_stats",
+           [](MLIRContext &self) {
+             py::dict result;
+             auto *dialect = self.getLoadedDialect<
+                 ::mlir::triton::gpu::TritonGPUDialect>();
+             if (!dialect)
+               return result;
+             auto toDict = [](const ::mlir::triton::gpu::CacheStats &stats) {
+               py::dict dict;
+               dict["hits"] = stats.hits;
+               dict["misses"] = stats.misses;
+               dict["evictions"] = stats.evictions;
+               dict["size"] = stats.size;
+               return dict;
+             };
+             result["linear_layout"] =
+                 toDict(dialect->getLinearLayoutCache().getStats());
+             result["linear_encoding"] =
+                 toDict(dialect->getLinearEncodingCache().getStats());
+             result["convert_layout_plan"] =
+                 toDict(dialect->getConvertLayoutPlanCache().getStats());
+             return result;
+           })
+      .def("set_layout_cache_capacity",
+           [](MLIRContext &self, size_t capacity) {
+             auto *dialect = self.getLoadedDialect<
+                 ::mlir::triton::gpu::TritonGPUDialect>();
+             if (!dialect)
+               throw std::runtime_error("TritonGPU dialect is not loaded");
+             dialect->getLinearLayoutCache().setCapacity(capacity);
+             dialect->getLinearEncodingCache().setCapacity(capacity);
+             dialect->getConvertLayoutPlanCache().setCapacity(capacity);
+           });
 
   py::class_<SourceMgrDiagnosticHandler>(m, "source_mgr_diag",
                                          py::module_local())
       .def(py::init<llvm::SourceMgr &, MLIRContext *>());
 
+  m.def("enable_pass_telemetry", [](bool enable) {
+    passTelemetryEnabled = enable;
+    passTelemetryBuffer.clear();
+  });
+  m.def("take_pass_telemetry", []() {
+    auto list = passRecordsToList(passTelemetryBuffer);
+    passTelemetryBuffer.clear();
+    return list;
+  });
+
   m.def("load_dialects", [](MLIRContext &context) {
     DialectRegistry registry;
     registry.insert<TritonDialect, ::mlir::triton::gpu::TritonGPUDialect,
@@ -586,6 +824,18 @@ void init_triton_ir(py::module &&m) {
              self.print(os, printingFlags);
              return str;
            })
+      .def("bytecode",
+           [](ModuleOp &self) -> py::bytes {
+             // Keeps the same locations as `str`, and is read back by
+             // parse_mlir_module without going through the textual parser.
+             std::string str;
+             llvm::raw_string_ostream os(str);
+             BytecodeWriterConfig config("Triton");
+             if (failed(writeBytecodeToFile(self, os, config)))
+               throw std::runtime_error("Failed to write MLIR bytecode");
+             os.flush();
+             return py::bytes(str);
+           })
       .def("push_back",
            [](ModuleOp &self, FuncOp &funcOp) -> void {
              self.push_back(funcOp);
@@ -676,7 +926,7 @@ void init_triton_ir(py::module &&m) {
   m.def(
       "parse_mlir_module",
       [](const std::string &inputFilename, MLIRContext &context) {
-        // parse module
+        // parse module, either textual IR or bytecode
         OwningOpRef<ModuleOp> module =
             parseSourceFile<ModuleOp>(inputFilename, &context);
         if (!module)
@@ -1757,7 +2007,12 @@ void init_triton_ir(py::module &&m) {
            });
 
   py::class_<PassManager>(m, "pass_manager", py::module_local())
-      .def(py::init<MLIRContext *>())
+      .def(py::init([](MLIRContext *context) {
+        auto pm = std::make_unique<PassManager>(context);
+        if (passTelemetryEnabled)
+          pm->addInstrumentation(std::make_unique<PassTelemetry>(pm.get()));
+        return pm;
+      }))
       .def("enable_debug",
            [](PassManager &self) -> bool {
              auto *context = self.getContext();
@@ -1805,9 +2060,10 @@ void init_triton_ir(py::module &&m) {
            })
       .def(
           "run",
-          [](PassManager &self, ModuleOp &mod) {
+          [](PassManager &self, ModuleOp &mod) -> py::object {
             // TODO: maybe dump module to file and print error for better
             // diagnostics
+            py::gil_scoped_release release;
 
             auto *context = mod.getContext();
             if (::triton::tools::getBoolEnv("MLIR_DISABLE_MULTITHREADING"))
@@ -1887,10 +2143,22 @@ void init_triton_ir(py::module &&m) {
             if (showStacktraces) {
               context->disableMultithreading();
             }
-            if (failed(self.run(mod.getOperation())))
+
+            PassTelemetry *telemetry = PassTelemetry::lookup(&self);
+            LogicalResult result = self.run(mod.getOperation());
+            std::vector<PassRecord> records;
+            if (telemetry) {
+              records = telemetry->takeRecords();
+              passTelemetryBuffer.insert(passTelemetryBuffer.end(),
+                                         records.begin(), records.end());
+            }
+            if (failed(result))
               throw std::runtime_error("PassManager::run failed");
-          },
-          py::call_guard<py::gil_scoped_release>());
+            py::gil_scoped_acquire acquire;
+            if (!telemetry)
+              return py::none();
+            return passRecordsToList(records);
+          });
 }
 
 void init_triton_env_vars(py::module &m) {
@@ -3,6 +3,10 @@
 #include "mlir/Target/LLVMIR/ModuleTranslation.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -17,6 +21,9 @@
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
@@ -26,7 +33,9 @@
 #include "llvm/Transforms/Instrumentation/AddressSanitizer.h"
 #include "llvm/Transforms/Instrumentation/AddressSanitizerOptions.h"
 #include <csignal>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <pybind11/gil.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -67,6 +76,22 @@ createTargetMachine(llvm::Module *module, std::string proc,
   return machine;
 }
 
+// Target machines only depend on the options above and are costly to build,
+// so each compiling thread keeps the ones it has used.
+TargetMachine &getTargetMachine(llvm::Module *module, std::string proc,
+                                bool enable_fp_fusion,
+                                const std::string &features) {
+  thread_local llvm::StringMap<std::unique_ptr<TargetMachine>> machines;
+  bool disableLLVMOpt = mlir::triton::tools::getBoolEnv("DISABLE_LLVM_OPT");
+  std::string key = module->getTargetTriple().str() + ";" + proc + ";" +
+                    features + ";" + std::to_string(enable_fp_fusion) + ";" +
+                    std::to_string(disableLLVMOpt);
+  auto &machine = machines[key];
+  if (!machine)
+    machine = createTargetMachine(module, proc, enable_fp_fusion, features);
+  return *machine;
+}
+
 std::string translateLLVMIRToASM(llvm::Module &module,
                                  const std::string &triple,
                                  const std::string &proc,
@@ -134,9 +159,9 @@ std::string translateLLVMIRToASM(llvm::Module &module,
 
   // create machine
   module.setTargetTriple(Triple(triple));
-  auto machine = createTargetMachine(&module, proc, enable_fp_fusion, features);
+  auto &machine = getTargetMachine(&module, proc, enable_fp_fusion, features);
   // set data layout
-  module.setDataLayout(machine->createDataLayout());
+  module.setDataLayout(machine.createDataLayout());
   // emit machine code
   std::string result;
   {
@@ -146,7 +171,7 @@ std::string translateLLVMIRToASM(llvm::Module &module,
     // emit
     auto fileType = isObject ? llvm::CodeGenFileType::ObjectFile
                              : llvm::CodeGenFileType::AssemblyFile;
-    machine->addPassesToEmitFile(pass, pstream, nullptr, fileType);
+    machine.addPassesToEmitFile(pass, pstream, nullptr, fileType);
     pass.run(module);
 
     if (enabledTiming) {
@@ -158,6 +183,103 @@ std::string translateLLVMIRToASM(llvm::Module &module,
   return result;
 }
 
+namespace {
+
+// Hashes whatever is written to it, so that a module can be fingerprinted
+// without keeping its serialized form in memory.
+class raw_sha256_ostream : public llvm::raw_ostream {
+public:
+  std::string hexDigest() {
+    flush();
+    return llvm::toHex(sha256.final(), /*LowerCase=*/true);
+  }
+
+private:
+  void write_impl(const char *ptr, size_t size) override {
+    sha256.update(llvm::StringRef(ptr, size));
+    pos += size;
+  }
+
+  uint64_t current_pos() const override { return pos; }
+
+  llvm::SHA256 sha256;
+  uint64_t pos = 0;
+};
+
+// An extern library (libdevice, ocml, ...) shared by every compile of the
+// process. Modules belong to an LLVMContext, so only the file contents and the
+// symbols it defines are cached; each compile loads the module lazily into its
+// own context and materializes just the functions it links.
+struct ExternLib {
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  llvm::sys::TimePoint<> mtime;
+  uint64_t size;
+  llvm::StringSet<> definedFns;
+  // Appending globals such as llvm.used are always linked
+  bool hasAppendingGlobals = false;
+  // Module flags such as libdevice's nvvm-reflect-ftz are merged into the
+  // destination by the linker even when no function is needed
+  bool hasModuleFlags = false;
+};
+
+struct ExternLibCacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t skipped = 0;
+};
+
+std::mutex externLibCacheMutex;
+llvm::StringMap<std::shared_ptr<const ExternLib>> externLibCache;
+ExternLibCacheStats externLibCacheStats;
+
+std::shared_ptr<const ExternLib> getExternLib(const std::string &path) {
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path, status))
+    throw std::invalid_argument("Failed to parse library at " + path);
+
+  std::lock_guard<std::mutex> lock(externLibCacheMutex);
+  auto it = externLibCache.find(path);
+  // Reload a library that was rebuilt in place
+  if (it != externLibCache.end() &&
+      it->second->mtime == status.getLastModificationTime() &&
+      it->second->size == status.getSize()) {
+    ++externLibCacheStats.hits;
+    return it->second;
+  }
+  ++externLibCacheStats.misses;
+
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    throw std::invalid_argument("Failed to parse library at " + path);
+  auto lib = std::make_shared<ExternLib>();
+  lib->buffer = std::move(*buffer);
+  lib->mtime = status.getLastModificationTime();
+  lib->size = status.getSize();
+
+  // Function bodies of a lazily loaded module are not parsed, but they are
+  // still reported as definitions.
+  LLVMContext ctx;
+  llvm::SMDiagnostic err;
+  std::unique_ptr<llvm::Module> libMod = llvm::getLazyIRModule(
+      llvm::MemoryBuffer::getMemBuffer(lib->buffer->getMemBufferRef()), err,
+      ctx);
+  if (!libMod)
+    throw std::invalid_argument("Failed to parse library at " + path);
+  for (llvm::Function &fn : libMod->functions()) {
+    if (!fn.isDeclaration())
+      lib->definedFns.insert(fn.getName());
+  }
+  lib->hasAppendingGlobals =
+      llvm::any_of(libMod->globals(), [](llvm::GlobalVariable &gv) {
+        return gv.hasAppendingLinkage();
+      });
+  lib->hasModuleFlags = libMod->getModuleFlagsMetadata() != nullptr;
+  externLibCache[path] = lib;
+  return lib;
+}
+
+} // namespace
+
 using ret = py::return_value_policy;
 
 void init_triton_llvm(py::module &&m) {
@@ -208,6 +330,14 @@ void init_triton_llvm(py::module &&m) {
             return mod->getFunctionList();
           },
           ret::reference_internal)
+      .def("hash",
+           [](llvm::Module *self) {
+             // Bitcode is cheaper to produce than the textual IR, and equal
+             // bitcode implies equal modules.
+             raw_sha256_ostream os;
+             llvm::WriteBitcodeToFile(*self, os);
+             return os.hexDigest();
+           })
       .def("add_flag",
            [](llvm::Module *mod, llvm::Module::ModFlagBehavior behavior,
               std::string &key, uint32_t value) {
@@ -367,11 +497,11 @@ void init_triton_llvm(py::module &&m) {
         // pass) setting the targetMachine value here can can cause a mismatch
         // in the target machine between the MLIR and Clang generated kernels
         // and break the lowering of some target specific intrinsics.
-        std::unique_ptr<TargetMachine> targetMachine = nullptr;
+        TargetMachine *targetMachine = nullptr;
         if (!arch.empty() && pluginFile.empty())
           targetMachine =
-              createTargetMachine(mod, arch, enable_fp_fusion, features);
-        PassBuilder pb(/*targetMachine=*/targetMachine.get(), tuningOptions,
+              &getTargetMachine(mod, arch, enable_fp_fusion, features);
+        PassBuilder pb(/*targetMachine=*/targetMachine, tuningOptions,
                        std::nullopt, instrCbPtr);
 
         if (!pluginFile.empty()) {
@@ -451,6 +581,28 @@ void init_triton_llvm(py::module &&m) {
       },
       ret::take_ownership);
 
+  // Translates a module handed over by make_llir without printing and
+  // re-parsing it. Code generation rewrites the module in place, so it must
+  // not be used afterwards.
+  m.def(
+      "translate_to_asm",
+      [](llvm::Module *module, std::string triple, std::string proc,
+         std::string features, std::vector<std::string> flags,
+         bool enable_fp_fusion, bool isObject) -> py::object {
+        std::string obj;
+        {
+          // when allow_threads goes out of scope, gil will be released
+          py::gil_scoped_release allow_threads;
+          obj = translateLLVMIRToASM(*module, triple, proc, features, flags,
+                                     enable_fp_fusion, isObject);
+        }
+        if (isObject)
+          return py::bytes(obj);
+        else
+          return py::str(obj);
+      },
+      ret::take_ownership);
+
   m.def("init_targets", []() {
     static std::once_flag init_flag;
     std::call_once(init_flag, []() {
@@ -470,8 +622,27 @@ void init_triton_llvm(py::module &&m) {
     LLVMContext &ctx = dstMod->getContext();
     llvm::Linker linker(*dstMod);
     for (const std::string &path : paths) {
+      std::shared_ptr<const ExternLib> lib = getExternLib(path);
+      const llvm::StringSet<> &externalFns = lib->definedFns;
+
+      // Only functions the module calls are linked, so a library that defines
+      // none of them does not need to be loaded at all, unless linking it still
+      // changes the module through its appending globals or module flags.
+      bool needed = lib->hasAppendingGlobals || lib->hasModuleFlags ||
+                    llvm::any_of(dstMod->functions(), [&](llvm::Function &fn) {
+                      return fn.isDeclaration() &&
+                             externalFns.contains(fn.getName());
+                    });
+      if (!needed) {
+        std::lock_guard<std::mutex> lock(externLibCacheMutex);
+        ++externLibCacheStats.skipped;
+        continue;
+      }
+
       llvm::SMDiagnostic err;
-      std::unique_ptr<llvm::Module> libMod = llvm::parseIRFile(path, err, ctx);
+      std::unique_ptr<llvm::Module> libMod = llvm::getLazyIRModule(
+          llvm::MemoryBuffer::getMemBuffer(lib->buffer->getMemBufferRef()),
+          err, ctx);
       if (!libMod) {
         std::string message = "Failed to parse library at " + path;
         throw std::invalid_argument(message);
@@ -479,12 +650,6 @@ void init_triton_llvm(py::module &&m) {
       libMod->setTargetTriple(Triple(dstMod->getTargetTriple()));
       libMod->setDataLayout(dstMod->getDataLayout());
 
-      std::unordered_set<std::string> externalFns;
-      for (llvm::Function &fn : libMod->functions()) {
-        if (!fn.isDeclaration())
-          externalFns.insert(fn.getName().str());
-      }
-
       if (linker.linkInModule(std::move(libMod),
                               llvm::Linker::Flags::LinkOnlyNeeded)) {
         std::string message = "Failed to link library at " + path;
@@ -494,12 +659,27 @@ void init_triton_llvm(py::module &&m) {
       // Mark linked-in functions as internal because backends use external
       // linkage as a signifier of kernel functions.
       for (llvm::Function &fn : dstMod->functions()) {
-        if (externalFns.count(fn.getName().str())) {
+        if (externalFns.contains(fn.getName())) {
           fn.setLinkage(llvm::GlobalValue::InternalLinkage);
         }
       }
     }
   });
+
+  m.def("get_extern_lib_cache_stats", []() {
+    std::lock_guard<std::mutex> lock(externLibCacheMutex);
+    return std::map<std::string, size_t>{
+        {"size", externLibCache.size()},
+        {"hits", externLibCacheStats.hits},
+        {"misses", externLibCacheStats.misses},
+        {"skipped", externLibCacheStats.skipped}};
+  });
+
+  m.def("clear_extern_lib_cache", []() {
+    std::lock_guard<std::mutex> lock(externLibCacheMutex);
+    externLibCache.clear();
+    externLibCacheStats = {};
+  });
 }
 
 void triton_stacktrace_signal_handler(void *) {
@@ -0,0 +1,90 @@
+"""
+Times the interpreter on a vector-add and a softmax grid, serially and with
+the programs spread over a thread pool.
+
+    python python/test/microbenchmark/bench_interpreter_grid.py --threads 1 4 8
+"""
+import argparse
+import os
+import time
+
+os.environ["TRITON_INTERPRET"] = "1"
+
+import torch  # noqa: E402
+
+import triton  # noqa: E402
+import triton.language as tl  # noqa: E402
+
+
+@triton.jit
+def add_kernel(x_ptr, y_ptr, out_ptr, n_elements, BLOCK_SIZE: tl.constexpr):
+    offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+    mask = offsets < n_elements
+    x = tl.load(x_ptr + offsets, mask=mask)
+    y = tl.load(y_ptr + offsets, mask=mask)
+    tl.store(out_ptr + offsets, x + y, mask=mask)
+
+
+@triton.jit
+def softmax_kernel(x_ptr, out_ptr, n_cols, BLOCK_SIZE: tl.constexpr):
+    row = tl.program_id(0)
+    offsets = tl.arange(0, BLOCK_SIZE)
+    mask = offsets < n_cols
+    x = tl.load(x_ptr + row * n_cols + offsets, mask=mask, other=-float("inf"))
+    x = x - tl.max(x, axis=0)
+    num = tl.exp(x)
+    tl.store(out_ptr + row * n_cols + offsets, num / tl.sum(num, axis=0), mask=mask)
+
+
+def vector_add(n_elements=1 << 20, block_size=1024):
+    x = torch.rand(n_elements)
+    y = torch.rand(n_elements)
+    out = torch.empty_like(x)
+
+    def run():
+        add_kernel[(triton.cdiv(n_elements, block_size), )](x, y, out, n_elements, BLOCK_SIZE=block_size)
+
+    return run, lambda: torch.testing.assert_close(out, x + y)
+
+
+def softmax(n_rows=4096, n_cols=1000):
+    x = torch.randn(n_rows, n_cols)
+    out = torch.empty_like(x)
+
+    def run():
+        softmax_kernel[(n_rows, )](x, out, n_cols, BLOCK_SIZE=triton.next_power_of_2(n_cols))
+
+    return run, lambda: torch.testing.assert_close(out, torch.softmax(x, dim=1))
+
+
+def bench(run, num_threads, reps):
+    best = float("inf")
+    with triton.knobs.runtime.scope():
+        triton.knobs.runtime.interpret_num_threads = num_threads
+        run()  # warm up
+        for _ in range(reps):
+            start = time.perf_counter()
+            run()
+            best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    parser.add_argument("--reps", type=int, default=3)
+    args = parser.parse_args()
+
+    for name, make in (("vector_add", vector_add), ("softmax", softmax)):
+        run, check = make()
+        # Speedups are relative to the first thread count, serial by default.
+        serial = None
+        for num_threads in args.threads:
+            t = bench(run, num_threads, args.reps)
+            check()
+            serial = serial or t
+            print(f"{name:>10} {num_threads:>3} threads: {t * 1e3:9.1f} ms ({serial / t:5.2f}x)")
+
+
+if __name__ == "__main__":
+    main()
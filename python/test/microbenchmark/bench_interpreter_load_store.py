@@ -0,0 +1,64 @@
+"""
+Times the interpreter's native load and store over the block sizes kernels
+typically use, for contiguous, masked, strided and gathered pointers.
+
+    python python/test/microbenchmark/bench_interpreter_load_store.py
+"""
+import argparse
+import time
+
+import numpy as np
+
+from triton._C.libtriton import interpreter as _interpreter
+
+DTYPES = [np.int8, np.float16, np.float32, np.float64]
+PATTERNS = ["contiguous", "masked", "strided", "gather"]
+SIZES = [128, 512, 1024, 4096, 16384]
+
+
+def make_inputs(dtype, pattern, numel, rng):
+    src = rng.integers(0, 100, size=4 * numel).astype(dtype)
+    dst = np.zeros_like(src)
+    if pattern == "strided":
+        offsets = np.arange(numel) * 3
+    elif pattern == "gather":
+        offsets = rng.permutation(4 * numel)[:numel]
+    else:
+        offsets = np.arange(numel)
+    mask = np.ones(numel, dtype=bool)
+    if pattern == "masked":
+        mask[numel // 3::5] = False
+    other = np.full(numel, 7, dtype=dtype)
+    itemsize = np.dtype(dtype).itemsize
+    src_ptrs = (src.ctypes.data + offsets * itemsize).astype(np.uint64)
+    dst_ptrs = (dst.ctypes.data + offsets * itemsize).astype(np.uint64)
+    return src, dst, src_ptrs, dst_ptrs, mask, other
+
+
+def time_us(fn, iters):
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--iters", type=int, default=200)
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(0)
+    for dtype in DTYPES:
+        for pattern in PATTERNS:
+            for numel in SIZES:
+                # `src` and `dst` own the memory the pointers refer to.
+                src, dst, src_ptrs, dst_ptrs, mask, other = make_inputs(dtype, pattern, numel, rng)
+                loaded = _interpreter.load(src_ptrs, mask, other, src.dtype)
+                load_us = time_us(lambda: _interpreter.load(src_ptrs, mask, other, src.dtype), args.iters)
+                store_us = time_us(lambda: _interpreter.store(dst_ptrs, loaded, mask), args.iters)
+                print(f"{np.dtype(dtype).name:>8} {pattern:>10} {numel:>6}: "
+                      f"load {load_us:8.2f} us, store {store_us:8.2f} us")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,126 @@
+"""
+Compares how long parse_mlir_module takes to read the ttir and ttgir stages of
+a flash attention kernel cached as textual IR and as MLIR bytecode.
+
+The stages are produced for the given target without a GPU.
+
+    python python/test/microbenchmark/bench_ir_bytecode.py --backend cuda --arch 90 --head-dim 64 128
+"""
+import argparse
+import os
+import tempfile
+import time
+
+import triton
+import triton.language as tl
+from triton._C.libtriton import ir
+from triton.backends.compiler import GPUTarget
+from triton.compiler import ASTSource, make_backend
+
+
+@triton.jit
+def attention_kernel(Q, K, V, Out, sm_scale, N_CTX, stride_m, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr,
+                     HEAD_DIM: tl.constexpr, NUM_STAGES: tl.constexpr):
+    start_m = tl.program_id(0)
+    off_hz = tl.program_id(1)
+    base = off_hz * N_CTX * stride_m
+    offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_n = tl.arange(0, BLOCK_N)
+    offs_d = tl.arange(0, HEAD_DIM)
+    q = tl.load(Q + base + offs_m[:, None] * stride_m + offs_d[None, :])
+    m_i = tl.full([BLOCK_M], float("-inf"), tl.float32)
+    l_i = tl.full([BLOCK_M], 1.0, tl.float32)
+    acc = tl.zeros([BLOCK_M, HEAD_DIM], tl.float32)
+    qk_scale = sm_scale * 1.44269504
+    for start_n in tl.range(0, N_CTX, BLOCK_N, num_stages=NUM_STAGES):
+        cols = start_n + offs_n
+        k = tl.load(K + base + cols[None, :] * stride_m + offs_d[:, None])
+        qk = tl.dot(q, k) * qk_scale
+        qk = tl.where(offs_m[:, None] >= cols[None, :], qk, float("-inf"))
+        m_ij = tl.maximum(m_i, tl.max(qk, 1))
+        p = tl.math.exp2(qk - m_ij[:, None])
+        alpha = tl.math.exp2(m_i - m_ij)
+        l_i = l_i * alpha + tl.sum(p, 1)
+        v = tl.load(V + base + cols[:, None] * stride_m + offs_d[None, :])
+        acc = acc * alpha[:, None] + tl.dot(p.to(tl.float16), v)
+        m_i = m_ij
+    acc = acc / l_i[:, None]
+    tl.store(Out + base + offs_m[:, None] * stride_m + offs_d[None, :], acc.to(tl.float16))
+
+
+SIGNATURE = {
+    "Q": "*fp16", "K": "*fp16", "V": "*fp16", "Out": "*fp16", "sm_scale": "fp32", "N_CTX": "i32", "stride_m": "i32"
+}
+
+
+def write_stages(target, head_dim, num_stages, directory):
+    """
+    Writes each of the ttir and ttgir stages as text and as bytecode, and
+    returns the paths of both files per stage.
+    """
+    backend = make_backend(target)
+    constexprs = {"BLOCK_M": 128, "BLOCK_N": 64, "HEAD_DIM": head_dim, "NUM_STAGES": num_stages}
+    src = ASTSource(fn=attention_kernel, signature=SIGNATURE, constexprs=constexprs)
+    options = backend.parse_options({"num_warps": 8})
+    stages = dict()
+    backend.add_stages(stages, options, src.language)
+    context = ir.context()
+    ir.load_dialects(context)
+    backend.load_dialects(context)
+    module = src.make_ir(options, backend.get_codegen_implementation(options), backend.get_module_map(), context)
+    metadata = {}
+    paths = {}
+    for ext in ("ttir", "ttgir"):
+        # Stages may rewrite the module in place, so it is written out before
+        # the next one runs
+        module = stages[ext](module, metadata)
+        text_path = os.path.join(directory, f"attention_{head_dim}.{ext}")
+        bytecode_path = text_path + ".mlirbc"
+        with open(text_path, "w") as f:
+            f.write(str(module))
+        with open(bytecode_path, "wb") as f:
+            f.write(module.bytecode())
+        paths[ext] = (text_path, bytecode_path)
+    return backend, paths
+
+
+def parse_ms(backend, path, repeats):
+    best = float("inf")
+    for _ in range(repeats):
+        # A fresh context, so that nothing uniqued by an earlier parse is reused
+        context = ir.context()
+        ir.load_dialects(context)
+        backend.load_dialects(context)
+        start = time.perf_counter()
+        ir.parse_mlir_module(path, context)
+        best = min(best, time.perf_counter() - start)
+    return best * 1e3
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--backend", default="cuda", choices=["cuda", "hip"])
+    parser.add_argument("--arch", default=None, help="90 for cuda and gfx942 for hip by default")
+    parser.add_argument("--head-dim", type=int, nargs="+", default=[64, 128])
+    parser.add_argument("--num-stages", type=int, default=3)
+    parser.add_argument("--repeats", type=int, default=10)
+    args = parser.parse_args()
+
+    if args.backend == "cuda":
+        target = GPUTarget("cuda", int(args.arch or 90), 32)
+    else:
+        target = GPUTarget("hip", args.arch or "gfx942", 64)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        for head_dim in args.head_dim:
+            backend, paths = write_stages(target, head_dim, args.num_stages, tmp)
+            for ext, (text_path, bytecode_path) in paths.items():
+                text_ms = parse_ms(backend, text_path, args.repeats)
+                bytecode_ms = parse_ms(backend, bytecode_path, args.repeats)
+                print(f"head_dim {head_dim:4} {ext:>6}: text {text_ms:8.2f} ms ({os.path.getsize(text_path):9} bytes), "
+                      f"bytecode {bytecode_ms:8.2f} ms ({os.path.getsize(bytecode_path):9} bytes), "
+                      f"speedup {text_ms / bytecode_ms:5.2f}x")
+
+
+if __name__ == "__main__":
+    main()
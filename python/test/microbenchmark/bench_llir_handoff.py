@@ -0,0 +1,91 @@
+"""
+Compares the llir -> ptx/amdgcn stage times, as reported through
+CompileTimes, when make_llir hands the LLVM module to codegen in memory and
+when it hands it over as text that codegen has to re-parse.
+
+    python python/test/microbenchmark/bench_llir_handoff.py --unroll 256 1024 --repeats 3
+"""
+import argparse
+import inspect
+import statistics
+import tempfile
+
+import torch
+
+import triton
+import triton.language as tl
+from triton.compiler.compiler import make_backend
+
+
+def make_unrolled_kernel(unroll):
+
+    @triton.jit
+    def unrolled_kernel(ptr, SEED: tl.constexpr, UNROLL: tl.constexpr):
+        offsets = tl.arange(0, 128)
+        x = tl.load(ptr + offsets)
+        for i in tl.static_range(UNROLL):
+            x = x * (SEED + i) + tl.sin(x)
+        tl.store(ptr + offsets, x)
+
+    return unrolled_kernel
+
+
+def patch_make_llir(backend, make_llir, wrap):
+    if isinstance(make_llir, staticmethod):
+        backend.make_llir = staticmethod(lambda *args: wrap(make_llir.__func__(*args)))
+    else:
+        backend.make_llir = lambda self, *args: wrap(make_llir(self, *args))
+
+
+def stage_times(kernel, unroll, repeats, asm_stage):
+    x = torch.randn(128, device="cuda")
+    times = []
+
+    def listener(src, metadata, metadata_group, compile_times, cache_hit):
+        assert not cache_hit
+        stages = dict(compile_times.lowering_stages)
+        times.append((stages["llir"], stages[asm_stage]))
+
+    triton.knobs.compilation.listener = listener
+    try:
+        for i in range(repeats):
+            kernel.device_caches.clear()
+            kernel[(1, )](x, SEED=i, UNROLL=unroll)
+    finally:
+        triton.knobs.compilation.listener = None
+    return [statistics.median(stage) / 1e3 for stage in zip(*times)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--unroll", type=int, nargs="+", default=[256, 1024])
+    parser.add_argument("--repeats", type=int, default=3)
+    args = parser.parse_args()
+
+    backend = type(make_backend(triton.runtime.driver.active.get_current_target()))
+    asm_stage = "ptx" if hasattr(backend, "make_ptx") else "amdgcn"
+    make_llir = inspect.getattr_static(backend, "make_llir")
+
+    with tempfile.TemporaryDirectory() as cache_dir:
+        triton.knobs.cache.dir = cache_dir
+        triton.knobs.compilation.always_compile = True
+        # The first compile of the process pays for the backend setup
+        stage_times(make_unrolled_kernel(1), 1, 1, asm_stage)
+        for unroll in args.unroll:
+            kernel = make_unrolled_kernel(unroll)
+            results = {}
+            for mode, wrap in (("handoff", lambda mod: mod), ("text", str)):
+                patch_make_llir(backend, make_llir, wrap)
+                try:
+                    results[mode] = stage_times(kernel, unroll, args.repeats, asm_stage)
+                finally:
+                    setattr(backend, "make_llir", make_llir)
+            for mode, (llir, asm) in results.items():
+                print(f"unroll {unroll:5}, {mode:>7}: llir {llir:9.2f} ms, {asm_stage} {asm:9.2f} ms, "
+                      f"total {llir + asm:9.2f} ms")
+            saved = sum(results["text"]) - sum(results["handoff"])
+            print(f"unroll {unroll:5}, saved by the handoff: {saved:9.2f} ms")
+
+
+if __name__ == "__main__":
+    main()
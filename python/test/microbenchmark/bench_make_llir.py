@@ -0,0 +1,69 @@
+"""
+Times the llir stage (make_llir, which links the extern libraries) over
+repeated compiles of a libdevice-heavy kernel, with the process-wide extern
+library cache kept warm and with it cleared before every compile.
+
+    python python/test/microbenchmark/bench_make_llir.py --compiles 16
+"""
+import argparse
+import statistics
+import tempfile
+
+import torch
+
+import triton
+import triton.language as tl
+from triton.language.extra import libdevice
+
+
+@triton.jit
+def libdevice_kernel(ptr, SCALE: tl.constexpr):
+    offsets = tl.arange(0, 1024)
+    x = tl.load(ptr + offsets) * SCALE
+    y = libdevice.tanh(x) + libdevice.erf(x) + libdevice.log1p(tl.abs(x)) + libdevice.atan(x)
+    tl.store(ptr + offsets, y)
+
+
+def llir_stage_times(num_compiles, clear_cache):
+    llvm = triton._C.libtriton.llvm
+    x = torch.randn(1024, device="cuda")
+    times = []
+
+    def listener(src, metadata, metadata_group, compile_times, cache_hit):
+        assert not cache_hit
+        times.append(dict(compile_times.lowering_stages)["llir"])
+
+    triton.knobs.compilation.listener = listener
+    libdevice_kernel.device_caches.clear()
+    llvm.clear_extern_lib_cache()
+    try:
+        # Every scale is a new specialization, like an autotuner sweep
+        for i in range(num_compiles):
+            if clear_cache:
+                llvm.clear_extern_lib_cache()
+            libdevice_kernel[(1, )](x, SCALE=1.0 + i)
+    finally:
+        triton.knobs.compilation.listener = None
+    return times, llvm.get_extern_lib_cache_stats()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compiles", type=int, default=16)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as cache_dir:
+        triton.knobs.cache.dir = cache_dir
+        triton.knobs.compilation.always_compile = True
+        # The first compile of the process pays for the backend setup
+        llir_stage_times(1, clear_cache=True)
+        for name, clear_cache in (("cold", True), ("cached", False)):
+            times, stats = llir_stage_times(args.compiles, clear_cache)
+            # Skip the first compile so both runs report steady-state times
+            steady = times[1:]
+            print(f"{name:>6}: llir median {statistics.median(steady) / 1e3:8.2f} ms, "
+                  f"min {min(steady) / 1e3:8.2f} ms, library hits {stats['hits']}, misses {stats['misses']}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+import numpy as np
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+from triton._internal_testing import is_interpreter
+from triton.runtime.errors import InterpreterError
+
+pytestmark = pytest.mark.skipif(not is_interpreter(), reason="requires the interpreter")
+
+
+@triton.jit
+def add_kernel(x_ptr, y_ptr, out_ptr, n_elements, BLOCK_SIZE: tl.constexpr):
+    offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+    mask = offsets < n_elements
+    x = tl.load(x_ptr + offsets, mask=mask)
+    y = tl.load(y_ptr + offsets, mask=mask)
+    tl.store(out_ptr + offsets, x + y, mask=mask)
+
+
+@triton.jit
+def softmax_kernel(x_ptr, out_ptr, n_cols, BLOCK_SIZE: tl.constexpr):
+    row = tl.program_id(0)
+    offsets = tl.arange(0, BLOCK_SIZE)
+    mask = offsets < n_cols
+    x = tl.load(x_ptr + row * n_cols + offsets, mask=mask, other=-float("inf"))
+    x = x - tl.max(x, axis=0)
+    num = tl.exp(x)
+    tl.store(out_ptr + row * n_cols + offsets, num / tl.sum(num, axis=0), mask=mask)
+
+
+@triton.jit
+def counter_kernel(counter_ptr, sum_ptr):
+    pid = tl.program_id(0) * tl.num_programs(1) + tl.program_id(1)
+    tl.atomic_add(counter_ptr, 1)
+    tl.atomic_add(sum_ptr, pid)
+
+
+def run_vector_add(device, n_elements=1 << 16, block_size=128):
+    x = torch.rand(n_elements, device=device)
+    y = torch.rand(n_elements, device=device)
+    out = torch.empty_like(x)
+    add_kernel[(triton.cdiv(n_elements, block_size), )](x, y, out, n_elements, BLOCK_SIZE=block_size)
+    return out, x + y
+
+
+def run_softmax(device, n_rows=512, n_cols=250):
+    x = torch.randn(n_rows, n_cols, device=device)
+    out = torch.empty_like(x)
+    softmax_kernel[(n_rows, )](x, out, n_cols, BLOCK_SIZE=triton.next_power_of_2(n_cols))
+    return out, torch.softmax(x, dim=1)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("run", [run_vector_add, run_softmax])
+def test_parallel_grid(run, device):
+    with triton.knobs.runtime.scope():
+        triton.knobs.runtime.interpret_num_threads = 4
+        out, ref = run(device)
+    torch.testing.assert_close(out, ref)
+
+
+@pytest.mark.interpreter
+def test_parallel_grid_atomics(device):
+    counter = torch.zeros(1, dtype=torch.int32, device=device)
+    total = torch.zeros(1, dtype=torch.int32, device=device)
+    grid = (32, 16)
+    with triton.knobs.runtime.scope():
+        triton.knobs.runtime.interpret_num_threads = 8
+        counter_kernel[grid](counter, total)
+    num_programs = grid[0] * grid[1]
+    assert counter.item() == num_programs
+    assert total.item() == num_programs * (num_programs - 1) // 2
+
+
+@pytest.mark.interpreter
+def test_parallel_grid_error(device):
+    x = torch.zeros(4, device=device)
+    with triton.knobs.runtime.scope():
+        triton.knobs.runtime.interpret_num_threads = 4
+        with pytest.raises(InterpreterError):
+            # tl.arange needs a power-of-two range, so every program fails.
+            add_kernel[(64, )](x, x, x, 4, BLOCK_SIZE=3)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("run", [run_vector_add, run_softmax])
+def test_parallel_grid_matches_serial(run, device):
+    outs = {}
+    for num_threads in (1, 8):
+        torch.manual_seed(0)
+        with triton.knobs.runtime.scope():
+            triton.knobs.runtime.interpret_num_threads = num_threads
+            outs[num_threads], _ = run(device)
+    # Every program runs the same code on its own block, so the thread count
+    # must not change a single bit of the result.
+    assert torch.equal(outs[1], outs[8])
+
+
+@triton.jit
+def program_id_kernel(out_ptr):
+    pid = tl.program_id(0) * tl.num_programs(1) + tl.program_id(1)
+    tl.store(out_ptr + pid, pid)
+
+
+@pytest.mark.interpreter
+def test_parallel_grid_program_ids(device):
+    grid = (16, 8)
+    out = torch.full((grid[0] * grid[1], ), -1, dtype=torch.int32, device=device)
+    with triton.knobs.runtime.scope():
+        triton.knobs.runtime.interpret_num_threads = 8
+        program_id_kernel[grid](out)
+    # Each thread must see the id of the program it is running.
+    assert torch.equal(out, torch.arange(out.numel(), dtype=torch.int32, device=device))
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("dtype", [np.int8, np.float16, np.float32, np.float64])
+@pytest.mark.parametrize("pattern", ["contiguous", "masked", "strided", "gather"])
+def test_native_load_store(dtype, pattern):
+    from triton._C.libtriton import interpreter as _interpreter
+
+    itemsize = np.dtype(dtype).itemsize
+    rng = np.random.default_rng(0)
+    for numel in (128, 1024, 16384):
+        src = rng.integers(0, 100, size=4 * numel).astype(dtype)
+        dst = np.zeros_like(src)
+        if pattern == "strided":
+            offsets = np.arange(numel) * 3
+        elif pattern == "gather":
+            offsets = rng.permutation(4 * numel)[:numel]
+        else:
+            offsets = np.arange(numel)
+        mask = np.ones(numel, dtype=bool)
+        if pattern == "masked":
+            mask[numel // 3::5] = False
+        other = np.full(numel, 7, dtype=dtype)
+
+        src_ptrs = (src.ctypes.data + offsets * itemsize).astype(np.uint64)
+        dst_ptrs = (dst.ctypes.data + offsets * itemsize).astype(np.uint64)
+        loaded = _interpreter.load(src_ptrs, mask, other, src.dtype)
+        np.testing.assert_array_equal(loaded, np.where(mask, src[offsets], other))
+        _interpreter.store(dst_ptrs, loaded, mask)
+        np.testing.assert_array_equal(dst[offsets[mask]], src[offsets[mask]])
+        # Masked-off lanes and elements outside the offsets are left alone.
+        untouched = np.ones_like(dst, dtype=bool)
+        untouched[offsets[mask]] = False
+        assert not dst[untouched].any()
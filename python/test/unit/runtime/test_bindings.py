@@ -102,3 +102,43 @@ def test_python_func_in_visit_call(device):
     x = torch.randn(4, device=device)
     out = torch.zeros_like(x)
     test_py_call_const_kernel[(4, )](x, out, 4, 4)
+
+
+def test_layout_cache_stats(tmp_path):
+    ir = triton._C.libtriton.ir
+    passes = triton._C.libtriton.passes
+    ttgir = tmp_path / "kernel.ttgir"
+    ttgir.write_text(r"""
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #ttg.blocked<{sizePerThread = [4, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [0, 1]}>
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  tt.func public @kernel(%arg0: !tt.ptr<f32>) {
+    %cst = arith.constant dense<1.000000e+00> : tensor<64x64xf32, #blocked>
+    %0 = ttg.convert_layout %cst : tensor<64x64xf32, #blocked> -> tensor<64x64xf32, #blocked1>
+    %1 = ttg.convert_layout %0 : tensor<64x64xf32, #blocked1> -> tensor<64x64xf32, #blocked>
+    %2 = ttg.convert_layout %1 : tensor<64x64xf32, #blocked> -> tensor<64x64xf32, #blocked1>
+    tt.return
+  }
+}
+""")
+    context = ir.context()
+    ir.load_dialects(context)
+    context.set_layout_cache_capacity(2)
+    mod = ir.parse_mlir_module(str(ttgir), context)
+    mod.context = context
+    pm = ir.pass_manager(context)
+    passes.ttgpuir.add_allocate_shared_memory(pm)
+    pm.run(mod)
+
+    stats = context.get_layout_cache_stats()
+    assert set(stats) == {"linear_layout", "linear_encoding", "convert_layout_plan"}
+    ll_stats = stats["linear_layout"]
+    assert ll_stats["misses"] > 0
+    # The capacity bounds the whole cache.
+    assert ll_stats["size"] <= 2
+    # Every miss inserts an entry, which either is still cached or was evicted.
+    assert ll_stats["size"] + ll_stats["evictions"] == ll_stats["misses"]
+    # The conversions are planned once per pair of layouts and reused.
+    plan_stats = stats["convert_layout_plan"]
+    assert plan_stats["hits"] > 0
+    assert plan_stats["size"] + plan_stats["evictions"] == plan_stats["misses"]
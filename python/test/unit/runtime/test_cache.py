@@ -167,6 +167,98 @@ def test_reuse(device, fresh_triton_cache):
     assert counter == 1
 
 
+def test_codegen_cache(device, fresh_triton_cache):
+    from triton.runtime.cache import get_codegen_cache_stats, reset_codegen_cache_stats
+
+    asm_stage, object_stage = ("amdgcn", "hsaco") if is_hip() else ("ptx", "cubin")
+    reset_codegen_cache_stats()
+    x = torch.empty(1, dtype=torch.int32, device=device)
+    # BLOCK is unused, so both specializations lower to the same LLVM IR
+    kernel[(1, )](x, 1, BLOCK=512)
+    kernel[(1, )](x, 1, BLOCK=1024)
+    assert x.item() == 4
+    stats = get_codegen_cache_stats()
+    assert stats[asm_stage] == {"hits": 1, "misses": 1}
+    assert stats[object_stage] == {"hits": 1, "misses": 1}
+
+    # A different kernel does not hit
+    kernel[(1, )](x, 2, BLOCK=1024)
+    assert get_codegen_cache_stats()[asm_stage] == {"hits": 1, "misses": 2}
+
+    with triton.knobs.cache.scope():
+        triton.knobs.cache.codegen = False
+        kernel[(1, )](x, 1, BLOCK=2048)
+    assert get_codegen_cache_stats()[asm_stage] == {"hits": 1, "misses": 2}
+
+
+@triton.jit
+def attention_kernel(Q, K, V, Out, N_CTX, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, HEAD_DIM: tl.constexpr):
+    offs_m = tl.program_id(0) * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_n = tl.arange(0, BLOCK_N)
+    offs_d = tl.arange(0, HEAD_DIM)
+    q = tl.load(Q + offs_m[:, None] * HEAD_DIM + offs_d[None, :])
+    m_i = tl.full([BLOCK_M], float("-inf"), tl.float32)
+    l_i = tl.zeros([BLOCK_M], tl.float32)
+    acc = tl.zeros([BLOCK_M, HEAD_DIM], tl.float32)
+    for start_n in range(0, N_CTX, BLOCK_N):
+        k = tl.load(K + (start_n + offs_n)[None, :] * HEAD_DIM + offs_d[:, None])
+        qk = tl.dot(q, k)
+        m_ij = tl.maximum(m_i, tl.max(qk, 1))
+        p = tl.math.exp2(qk - m_ij[:, None])
+        alpha = tl.math.exp2(m_i - m_ij)
+        l_i = l_i * alpha + tl.sum(p, 1)
+        v = tl.load(V + (start_n + offs_n)[:, None] * HEAD_DIM + offs_d[None, :])
+        acc = acc * alpha[:, None] + tl.dot(p.to(v.dtype), v)
+        m_i = m_ij
+    tl.store(Out + offs_m[:, None] * HEAD_DIM + offs_d[None, :], (acc / l_i[:, None]).to(Out.dtype.element_ty))
+
+
+def test_ir_bytecode_cache(device, fresh_triton_cache, tmp_path):
+    from triton._C.libtriton import ir
+    from triton.compiler.compiler import is_mlir_bytecode, make_backend
+
+    q, k, v = (torch.randn((256, 64), dtype=torch.float16, device=device) for _ in range(3))
+    out = torch.empty_like(q)
+
+    # Stages are stored as text by default
+    h = attention_kernel[(2, )](q, k, v, out, 256, BLOCK_M=128, BLOCK_N=32, HEAD_DIM=64)
+    assert h.asm.bytecode_files == {}
+    assert "tt.func public @attention_kernel" in h.asm["ttgir"]
+
+    with triton.knobs.cache.scope():
+        triton.knobs.cache.ir_bytecode = True
+        h = attention_kernel[(2, )](q, k, v, out, 256, BLOCK_M=128, BLOCK_N=64, HEAD_DIM=64)
+    bytecode_path = h.asm.bytecode_files["ttgir"]
+    assert is_mlir_bytecode(bytecode_path.read_bytes())
+
+    # Bytecode stages are listed like the textual ones before they are printed
+    for stage in ("ttir", "ttgir"):
+        assert stage in h.asm
+        assert stage in h.asm.keys()
+        assert stage in list(h.asm)
+    assert len(h.asm) == len(list(h.asm.keys()))
+
+    # and are printed on demand
+    text = h.asm.get("ttgir")
+    assert "tt.func public @attention_kernel" in text
+    assert h.asm["ttgir"] is text
+    assert dict(h.asm.items())["ttir"] == h.asm["ttir"]
+    assert h.asm.get("missing") is None
+
+    # Both formats parse to the same module
+    text_path = tmp_path / "attention.ttgir"
+    text_path.write_text(text)
+    context = ir.context()
+    ir.load_dialects(context)
+    make_backend(h.metadata.target).load_dialects(context)
+    for path in (text_path, bytecode_path):
+        assert str(ir.parse_mlir_module(str(path), context)) == text
+
+    # Compilation resumes from a bytecode stage
+    resumed = triton.compile(str(bytecode_path), target=h.metadata.target)
+    assert resumed.asm[make_backend(h.metadata.target).binary_ext]
+
+
 @pytest.mark.parametrize('mode', ['enable', 'disable', 'disable_on_alignment'])
 def test_specialize(mode, device, fresh_triton_cache):
     counter = 0
@@ -1,9 +1,13 @@
+import inspect
+import re
+
 import triton
 import triton.language as tl
+from triton.language.extra import libdevice
 
 from triton.backends.compiler import GPUTarget
 from triton.knobs import CompileTimes
-from triton.compiler.compiler import ASTSource, IRSource
+from triton.compiler.compiler import ASTSource, IRSource, make_backend
 
 from typing import Any, Union
 
@@ -64,3 +68,223 @@ def test_compile_stats(device: str, fresh_knobs_except_libraries: Any, fresh_tri
     assert captured[3].total_lowering == 0
     assert captured[3].store_results == 0
     assert captured[3].total > 0
+
+
+@triton.jit
+def tanh_kernel(ptr, SCALE: tl.constexpr):
+    block = ptr + tl.arange(0, 128)
+    tl.store(block, libdevice.tanh(tl.load(block) * SCALE))
+
+
+def test_extern_lib_cache(device: str, fresh_knobs_except_libraries: Any, fresh_triton_cache: str) -> None:
+    llvm = triton._C.libtriton.llvm
+    x = torch.randn(128, device=device)
+    llvm.clear_extern_lib_cache()
+
+    # Every configuration is a new compile, like an autotuner sweep
+    hits = 0
+    for i in range(4):
+        scale = 1.0 + i
+        y = x.clone()
+        tanh_kernel[(1, )](y, SCALE=scale)
+        torch.testing.assert_close(y, torch.tanh(x * scale))
+        stats = llvm.get_extern_lib_cache_stats()
+        # Only the first compile parses the libraries, the others reuse them
+        assert stats["size"] > 0
+        assert stats["misses"] == stats["size"]
+        if i == 0:
+            assert stats["hits"] == 0
+        else:
+            assert stats["hits"] > hits
+        hits = stats["hits"]
+
+    llvm.clear_extern_lib_cache()
+    stats = llvm.get_extern_lib_cache_stats()
+    assert stats["size"] == stats["hits"] == stats["misses"] == 0
+
+
+def module_flags(llir: str) -> set[str]:
+    nodes = dict(re.findall(r"^(![0-9]+) = !\{(.*)\}$", llir, re.MULTILINE))
+    flags = re.search(r"^!llvm\.module\.flags = !\{(.*)\}$", llir, re.MULTILINE)
+    assert flags is not None
+    return {nodes[ref.strip()] for ref in flags.group(1).split(",")}
+
+
+def test_extern_lib_module_flags(device: str, fresh_knobs_except_libraries: Any, fresh_triton_cache: str) -> None:
+    # A kernel that calls no library function still gets the module flags of
+    # the libraries it is linked against, like one that does.
+    x = torch.randn(128, device=device)
+    plain = cumsum_kernel[(1, )](x.clone()).asm["llir"]
+    extern = tanh_kernel[(1, )](x.clone(), SCALE=1.0).asm["llir"]
+    assert "tanh" not in plain
+    assert module_flags(plain) == module_flags(extern)
+
+
+@triton.jit
+def unrolled_kernel(ptr, SEED: tl.constexpr):
+    offsets = tl.arange(0, 128)
+    x = tl.load(ptr + offsets)
+    for i in tl.static_range(512):
+        x = x * (SEED + i) + tl.sin(x)
+    tl.store(ptr + offsets, x)
+
+
+def test_llir_module_handoff(device: str, fresh_knobs_except_libraries: Any, fresh_triton_cache: str,
+                             monkeypatch: Any) -> None:
+    x = torch.randn(128, device=device)
+    backend = type(make_backend(triton.runtime.driver.active.get_current_target()))
+    asm_stage = "ptx" if hasattr(backend, "make_ptx") else "amdgcn"
+    make_llir = inspect.getattr_static(backend, "make_llir")
+    handed_off: list[type] = []
+
+    def patch_make_llir(wrap: Any) -> None:
+        if isinstance(make_llir, staticmethod):
+            monkeypatch.setattr(backend, "make_llir", staticmethod(lambda *args: wrap(make_llir.__func__(*args))))
+        else:
+            monkeypatch.setattr(backend, "make_llir", lambda self, *args: wrap(make_llir(self, *args)))
+
+    def record(mod: Any) -> Any:
+        handed_off.append(type(mod))
+        return mod
+
+    def run() -> tuple[torch.Tensor, Any]:
+        y = x.clone()
+        pgm = unrolled_kernel[(1, )](y, SEED=1)
+        return y, pgm
+
+    # The llir stage hands an in-memory module to the next stage
+    patch_make_llir(record)
+    handoff_out, handoff_pgm = run()
+    assert handed_off and all(t is not str for t in handed_off)
+
+    # Handing the module over as text, which prints and re-parses it, must
+    # produce the same code
+    fresh_knobs_except_libraries.compilation.always_compile = True
+    unrolled_kernel.device_caches.clear()
+    patch_make_llir(str)
+    text_out, text_pgm = run()
+
+    assert handoff_pgm.asm["llir"] == text_pgm.asm["llir"]
+    assert handoff_pgm.asm[asm_stage] == text_pgm.asm[asm_stage]
+    torch.testing.assert_close(handoff_out, text_out, equal_nan=True)
+
+
+def test_pass_telemetry(device: str, fresh_knobs_except_libraries: Any, fresh_triton_cache: str) -> None:
+    captured: list[CompileTimes] = []
+
+    def compile_listener(src: Union[ASTSource, IRSource], metadata: dict[str, str], metadata_group: dict[str, Any],
+                         times: CompileTimes, cache_hit: bool) -> None:
+        captured.append(times)
+
+    fresh_knobs_except_libraries.compilation.listener = compile_listener
+    x = torch.randn(4, device=device)
+    cumsum_kernel[(1, )](x)
+
+    # Telemetry is opt-in
+    assert len(captured) == 1
+    assert captured[0].pass_telemetry == []
+
+    captured.clear()
+    fresh_knobs_except_libraries.compilation.pass_telemetry = True
+    fresh_knobs_except_libraries.compilation.always_compile = True
+    cumsum_kernel.device_caches.clear()
+    cumsum_kernel[(1, )](x)
+
+    assert len(captured) == 1
+    telemetry = dict(captured[0].pass_telemetry)
+    assert [stage for stage, _ in captured[0].lowering_stages] == list(telemetry)
+    ttgir = telemetry["ttgir"]
+    assert len(ttgir) > 0
+    for record in ttgir:
+        assert record["pass"]
+        assert record["time_us"] >= 0
+        assert record["ops_before"] > 0 and record["ops_after"] > 0
+        assert record["malloc_bytes"] >= 0
+        assert not record["failed"]
+    passes = {record["pass"] for record in ttgir}
+    assert "convert-triton-to-tritongpu" in passes
+    assert "tritongpu-remove-layout-conversions" in passes
+    # Binary stages don't run MLIR passes
+    assert telemetry[list(telemetry)[-1]] == []
+
+    # Telemetry is only collected while a compile is being listened to
+    fresh_knobs_except_libraries.compilation.listener = None
+    assert triton._C.libtriton.ir.take_pass_telemetry() == []
+
+
+def test_pass_telemetry_per_run(device: str, fresh_knobs_except_libraries: Any, fresh_triton_cache: str,
+                                tmp_path: Any) -> None:
+    ir = triton._C.libtriton.ir
+    passes = triton._C.libtriton.passes
+    ttir = tmp_path / "cumsum.ttir"
+    ttir.write_text(cumsum_kernel[(1, )](torch.randn(4, device=device)).asm["ttir"])
+    context = ir.context()
+    ir.load_dialects(context)
+    mod = ir.parse_mlir_module(str(ttir), context)
+
+    # A pass manager is instrumented once, and each run only reports its own
+    # passes
+    ir.enable_pass_telemetry(True)
+    try:
+        pm = ir.pass_manager(context)
+        passes.common.add_canonicalizer(pm)
+        passes.common.add_cse(pm)
+        runs = [pm.run(mod) for _ in range(3)]
+    finally:
+        ir.enable_pass_telemetry(False)
+    for records in runs:
+        assert [record["pass"] for record in records] == ["canonicalize", "cse"]
+
+    # Pass managers created without telemetry report nothing
+    pm = ir.pass_manager(context)
+    passes.common.add_cse(pm)
+    assert pm.run(mod) is None
+
+
+@triton.jit
+def two_loop_kernel(ptr, out, N: tl.constexpr):
+    offs = tl.arange(0, 128)
+    acc = tl.zeros((128, ), tl.float32)
+    for i in range(N):
+        acc += tl.load(ptr + i * 128 + offs)
+    for i in range(N):
+        acc *= tl.load(ptr + i * 128 + offs)
+    tl.store(out + offs, acc)
+
+
+def test_axis_info_solver_runs(device: str, fresh_knobs_except_libraries: Any, fresh_triton_cache: str) -> None:
+    captured: list[CompileTimes] = []
+
+    def compile_listener(src: Union[ASTSource, IRSource], metadata: dict[str, str], metadata_group: dict[str, Any],
+                         times: CompileTimes, cache_hit: bool) -> None:
+        captured.append(times)
+
+    fresh_knobs_except_libraries.compilation.listener = compile_listener
+    fresh_knobs_except_libraries.compilation.pass_telemetry = True
+    x = torch.randn(8 * 128, device=device)
+    out = torch.empty(128, device=device)
+    two_loop_kernel[(1, )](x, out, 8)
+
+    assert len(captured) == 1
+    records = [record for _, stage in captured[0].pass_telemetry for record in stage]
+    runs = {}
+    for record in records:
+        runs[record["pass"]] = runs.get(record["pass"], 0) + record["axis_info_solver_runs"]
+    assert runs["tritongpu-coalesce"] == 1
+    names = [record["pass"] for record in records]
+    if "tritongpu-assign-latencies" in names:
+        # The analysis is computed once for the module, not once per loop.
+        assert runs["tritongpu-assign-latencies"] == 1
+        # The loop scheduler only annotates loops without long loop-carried
+        # distances, so the pipeliner reuses the axis info computed for the
+        # latencies.
+        pipeline = names.index("tritongpu-pipeline")
+        if names[pipeline - 1] == "tritongpu-schedule-loops":
+            assert runs["tritongpu-pipeline"] == 0
+    # Every other consumer either reuses a preserved result or runs the solver
+    # once. The AMD stream pipeliner runs it again after each loop it pipelines.
+    for record in records:
+        max_runs = 2 if record["pass"] == "tritonamdgpu-stream-pipeline" else 1
+        assert record["axis_info_solver_runs"] <= max_runs, record["pass"]
+    # Most passes never look at the axis info.
+    assert 0 < sum(runs.values()) < len(records)
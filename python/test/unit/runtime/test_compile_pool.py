@@ -0,0 +1,109 @@
+from concurrent.futures import ThreadPoolExecutor
+import threading
+
+import pytest
+
+import triton
+import triton.language as tl
+from triton.backends import backends
+from triton.backends.compiler import GPUTarget
+from triton.compiler import ASTSource, CompilePool
+from triton.compiler.compiler import _ContextPool, make_backend
+
+TARGETS = [GPUTarget("cuda", 90, 32), GPUTarget("hip", "gfx942", 64)]
+
+
+@triton.jit
+def matmul_kernel(a_ptr, b_ptr, c_ptr, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+    offs_m = tl.arange(0, BLOCK_M)
+    offs_n = tl.arange(0, BLOCK_N)
+    offs_k = tl.arange(0, BLOCK_K)
+    a = tl.load(a_ptr + offs_m[:, None] * BLOCK_K + offs_k[None, :])
+    b = tl.load(b_ptr + offs_k[:, None] * BLOCK_N + offs_n[None, :])
+    c = tl.dot(a, b)
+    tl.store(c_ptr + offs_m[:, None] * BLOCK_N + offs_n[None, :], c)
+
+
+def make_sources():
+    return [
+        ASTSource(fn=matmul_kernel, signature={"a_ptr": "*fp16", "b_ptr": "*fp16", "c_ptr": "*fp32"},
+                  constexprs={"BLOCK_M": m, "BLOCK_N": n, "BLOCK_K": k})
+        for m in (32, 64, 128)
+        for n in (32, 64, 128)
+        for k in (32, 64)
+    ]
+
+
+def skip_if_unavailable(target):
+    if target.backend not in backends:
+        pytest.skip(f"the {target.backend} backend is not available")
+
+
+@pytest.mark.parametrize("target", TARGETS, ids=lambda target: target.backend)
+def test_compile_pool(target, fresh_triton_cache):
+    skip_if_unavailable(target)
+    srcs = make_sources()
+    asm = "ptx" if target.backend == "cuda" else "amdgcn"
+    threads = set()
+
+    def compile_listener(src, metadata, metadata_group, times, cache_hit):
+        threads.add(threading.current_thread().name)
+
+    with triton.knobs.compilation.scope():
+        triton.knobs.compilation.always_compile = True
+        triton.knobs.compilation.listener = compile_listener
+        serial = [triton.compile(src, target=target) for src in srcs]
+        assert threads == {threading.current_thread().name}
+
+        threads.clear()
+        with CompilePool(max_workers=8, targets=[target]) as pool:
+            pooled = pool.compile_all(srcs, target=target)
+
+    # Every kernel was compiled by a worker, in the order of the sources
+    assert len(threads) > 0
+    assert all(name.startswith("triton-compile") for name in threads)
+    assert [kernel.hash for kernel in pooled] == [kernel.hash for kernel in serial]
+    assert [kernel.asm[asm] for kernel in pooled] == [kernel.asm[asm] for kernel in serial]
+
+
+@pytest.mark.parametrize("target", TARGETS, ids=lambda target: target.backend)
+def test_context_pool(target, monkeypatch):
+    skip_if_unavailable(target)
+    monkeypatch.setattr(_ContextPool, "max_uses", 3)
+    pool = _ContextPool()
+    backend = make_backend(target)
+
+    # A context is reused until it has served max_uses compiles
+    context = pool.get(backend)
+    assert pool.get(backend) is context
+    assert pool.get(backend) is context
+    assert pool.get(backend) is not context
+
+    # Each thread has its own contexts
+    other = []
+    thread = threading.Thread(target=lambda: other.append(pool.get(backend)))
+    thread.start()
+    thread.join()
+    assert other[0] is not context and other[0] is not pool.get(backend)
+
+
+@pytest.mark.parametrize("target", TARGETS, ids=lambda target: target.backend)
+def test_context_pool_multithreading(target):
+    skip_if_unavailable(target)
+    pool = _ContextPool()
+    backend = make_backend(target)
+
+    # Pooled contexts keep the threading default of a fresh context, even
+    # after a compile disabled it on completion
+    context = pool.get(backend)
+    assert context.is_multithreading_enabled()
+    context.disable_multithreading()
+    assert pool.get(backend).is_multithreading_enabled()
+
+    # CompilePool workers run single-threaded contexts
+    def worker():
+        pool.multithreading = False
+        return pool.get(backend).is_multithreading_enabled()
+
+    with ThreadPoolExecutor(max_workers=1) as executor:
+        assert not executor.submit(worker).result()
@@ -1,7 +1,7 @@
-from .compiler import CompiledKernel, ASTSource, IRSource, compile, make_backend, LazyDict, get_cache_key
+from .compiler import CompiledKernel, ASTSource, IRSource, CompilePool, compile, make_backend, LazyDict, get_cache_key
 from .errors import CompilationError
 
 __all__ = [
-    "compile", "make_backend", "ASTSource", "IRSource", "CompiledKernel", "CompilationError", "LazyDict",
-    "get_cache_key"
+    "compile", "make_backend", "ASTSource", "IRSource", "CompiledKernel", "CompilePool", "CompilationError",
+    "LazyDict", "get_cache_key"
 ]
@@ -10,11 +10,16 @@ from ..runtime.autotuner import OutOfResources
 from ..runtime.cache import get_cache_manager, get_dump_manager, get_override_manager, get_cache_key
 from ..runtime.driver import driver
 from ..tools.disasm import get_sass
+from collections.abc import ItemsView, KeysView, ValuesView
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 import re
 import functools
+import itertools
 import os
+import threading
 import time
+from typing import Any
 
 # - ^\s*tt\.func\s+ : match the start of the string, any leading whitespace, the keyword func,
 #    and any following whitespace
@@ -86,6 +91,25 @@ class ASTSource:
         return dict()
 
 
+# Leading bytes of an MLIR bytecode file
+MLIR_BYTECODE_MAGIC = b"ML\xefR"
+
+
+def is_mlir_bytecode(data: bytes) -> bool:
+    return data.startswith(MLIR_BYTECODE_MAGIC)
+
+
+def serialize_ir(module):
+    """
+    Returns what is stored in the cache for a stage's output. MLIR modules
+    are stored as bytecode, which is much cheaper to parse than textual IR
+    when a cached stage is reused.
+    """
+    if knobs.cache.ir_bytecode and isinstance(module, ir.module):
+        return module.bytecode()
+    return module
+
+
 class IRSource:
 
     def __init__(self, path, context, backend):
@@ -93,7 +117,9 @@ class IRSource:
         path = Path(path)
         self.ext = path.suffix[1:]
         self.language = Language.TRITON
-        self.src = path.read_text()
+        src = path.read_bytes()
+        # Bytecode is kept as is: it is only hashed, the module is parsed below
+        self.src = src if is_mlir_bytecode(src) else src.decode("utf-8")
         ir.load_dialects(context)
         backend.load_dialects(context)
 
@@ -114,7 +140,8 @@ class IRSource:
             self.signature = {k: ty for k, ty in enumerate(func_ty)}
 
     def hash(self):
-        return hashlib.sha256(self.src.encode("utf-8")).hexdigest()
+        src = self.src if isinstance(self.src, bytes) else self.src.encode("utf-8")
+        return hashlib.sha256(src).hexdigest()
 
     def make_ir(self, options, codegen_fns, module_map, context):
         self.module.context = context
@@ -189,15 +216,23 @@ class CompileTimer:
         self.ir_initialization_end: float | None = None
         self.lowering_stage_ends: list[tuple[str, float]] = []
         self.store_results_end: float | None = None
+        self.pass_telemetry: list[tuple[str, list[dict[str, Any]]]] = []
+        self.collect_pass_telemetry = knobs.compilation.pass_telemetry
 
     def finished_ir_initialization(self) -> None:
         self.ir_initialization_end = time.time()
+        # Passes run by make_ir are not attributed to a lowering stage
+        if self.collect_pass_telemetry:
+            ir.enable_pass_telemetry(True)
 
     def stage_finished(self, stage_name: str) -> None:
         self.lowering_stage_ends.append((stage_name, time.time()))
+        if self.collect_pass_telemetry:
+            self.pass_telemetry.append((stage_name, ir.take_pass_telemetry()))
 
     def end(self) -> knobs.CompileTimes:
         timestamp = time.time()
+        ir.enable_pass_telemetry(False)
         if self.ir_initialization_end is None:
             self.ir_initialization_end = timestamp
         else:
@@ -218,13 +253,54 @@ class CompileTimer:
             ir_initialization=delta(self.start, self.ir_initialization_end),
             lowering_stages=lowering_stage_durations,
             store_results=delta(stage_start, self.store_results_end),
+            pass_telemetry=self.pass_telemetry,
         )
 
 
+class _ContextPool(threading.local):
+    """
+    Warm MLIR contexts with the dialects of a backend loaded, owned by the
+    current thread so that concurrent compiles never share one.
+    """
+
+    # A context keeps every type and attribute it has uniqued, so it is
+    # replaced after this many compiles.
+    max_uses = 64
+
+    def __init__(self):
+        self.contexts = {}
+        # Workers of a CompilePool already run in parallel, so their contexts
+        # do not start threads of their own.
+        self.multithreading = True
+
+    def get(self, backend):
+        key = type(backend)
+        context, uses = self.contexts.get(key, (None, self.max_uses))
+        if uses >= self.max_uses:
+            context = ir.context()
+            ir.load_dialects(context)
+            backend.load_dialects(context)
+            uses = 0
+        # A compile disables multithreading when it completes so that the
+        # process can fork, see `compile`
+        if self.multithreading:
+            context.enable_multithreading()
+        else:
+            context.disable_multithreading()
+        self.contexts[key] = (context, uses + 1)
+        return context
+
+
+_context_pool = _ContextPool()
+
+
 def compile(src, target=None, options=None, _env_vars=None):
     compilation_listener = knobs.compilation.listener
     if compilation_listener:
         timer = CompileTimer()
+    else:
+        # A listened compile that raised may have left pass telemetry on
+        ir.enable_pass_telemetry(False)
 
     if target is None:
         target = driver.active.get_current_target()
@@ -292,9 +368,13 @@ def compile(src, target=None, options=None, _env_vars=None):
     # For IRSource, we have already grabbed the context + called both
     # ir.load_dialects and backend.load_dialects.
     if not isinstance(src, IRSource):
-        context = ir.context()
-        ir.load_dialects(context)
-        backend.load_dialects(context)
+        if knobs.compilation.enable_asan:
+            # Contexts without threads hang with the ASAN pass, see below
+            context = ir.context()
+            ir.load_dialects(context)
+            backend.load_dialects(context)
+        else:
+            context = _context_pool.get(backend)
 
     codegen_fns = backend.get_codegen_implementation(options)
     module_map = backend.get_module_map()
@@ -306,10 +386,10 @@ def compile(src, target=None, options=None, _env_vars=None):
 
     if ir_source:
         ir_filename = f"{file_name}.{src.ext}"
-        metadata_group[ir_filename] = fn_cache_manager.put(module, ir_filename)
+        metadata_group[ir_filename] = fn_cache_manager.put(serialize_ir(module), ir_filename)
     else:
         ir_filename = f"{file_name}.source"
-        metadata_group[ir_filename] = fn_cache_manager.put(module, ir_filename)
+        metadata_group[ir_filename] = fn_cache_manager.put(serialize_ir(module), ir_filename)
 
     use_ir_loc = knobs.compilation.use_ir_loc
     if ir_source and use_ir_loc:
@@ -331,7 +411,7 @@ def compile(src, target=None, options=None, _env_vars=None):
             next_module = parse(full_name, ext, context)
         # If TRITON_STORE_BINARY_ONLY is 1, only store cubin/hsaco/json
         if (not store_only_binary) or (ext in ("cubin", "hsaco", "json")):
-            metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
+            metadata_group[ir_filename] = fn_cache_manager.put(serialize_ir(next_module), ir_filename)
         if fn_dump_manager is not None:
             fn_dump_manager.put(next_module, ir_filename)
             if ext == "cubin":
@@ -369,6 +449,32 @@ def compile(src, target=None, options=None, _env_vars=None):
     return CompiledKernel(src, metadata_group, hash)
 
 
+def _warm_up(targets):
+    _context_pool.multithreading = False
+    for target in targets:
+        _context_pool.get(make_backend(target))
+
+
+class CompilePool(ThreadPoolExecutor):
+    """
+    Compiles many kernels in parallel, e.g. every configuration of an
+    autotuner before the first launch.
+
+    Passes, LLVM optimizations and code generation release the GIL, and each
+    worker keeps warm contexts for the backends it compiles for. The contexts
+    of `targets` are created when a worker starts. A pool can also be used as
+    the executor of an `AsyncCompileMode`.
+    """
+
+    def __init__(self, max_workers=None, targets=()):
+        super().__init__(max_workers=max_workers, thread_name_prefix="triton-compile", initializer=_warm_up,
+                         initargs=(tuple(targets), ))
+
+    def compile_all(self, srcs, target=None, options=None):
+        futures = [self.submit(compile, src, target, options) for src in srcs]
+        return [future.result() for future in futures]
+
+
 def make_backend(target: GPUTarget) -> BaseBackend:
     actives = [x.compiler for x in backends.values() if x.compiler.supports_target(target)]
     if len(actives) != 1:
@@ -395,16 +501,52 @@ class LazyDict:
 
 class AsmDict(dict):
 
+    def __init__(self, *args, backend=None, bytecode_files=None, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.backend = backend
+        # Stages cached as MLIR bytecode are listed like the others, but only
+        # printed when their value is asked for
+        self.bytecode_files = bytecode_files or {}
+
     def __missing__(self, key):
 
         if key == "sass":
             value = get_sass(self["cubin"])
+        elif key in self.bytecode_files:
+            context = ir.context()
+            ir.load_dialects(context)
+            self.backend.load_dialects(context)
+            value = str(ir.parse_mlir_module(str(self.bytecode_files[key]), context))
         else:
             raise KeyError("Unknown key: '%s'" % key)
 
         self[key] = value
         return value
 
+    def _unprinted(self):
+        return [key for key in self.bytecode_files if not dict.__contains__(self, key)]
+
+    def __contains__(self, key):
+        return dict.__contains__(self, key) or key in self.bytecode_files
+
+    def __iter__(self):
+        return itertools.chain(dict.__iter__(self), self._unprinted())
+
+    def __len__(self):
+        return dict.__len__(self) + len(self._unprinted())
+
+    def get(self, key, default=None):
+        return self[key] if key in self else default
+
+    def keys(self):
+        return KeysView(self)
+
+    def values(self):
+        return ValuesView(self)
+
+    def items(self):
+        return ItemsView(self)
+
 
 class CompiledKernel:
 
@@ -426,10 +568,18 @@ class CompiledKernel:
         # stores the text of each level of IR that was generated during compilation
         asm_files = [Path(p) for c, p in metadata_group.items() if not c.endswith(".json")]
         binary_ext = backend.binary_ext
-        self.asm = AsmDict({
-            file.suffix[1:]: file.read_bytes() if file.suffix[1:] == binary_ext else file.read_text()
-            for file in asm_files
-        })
+        asm = {}
+        bytecode_files = {}
+        for file in asm_files:
+            ext = file.suffix[1:]
+            data = file.read_bytes()
+            if ext == binary_ext:
+                asm[ext] = data
+            elif is_mlir_bytecode(data):
+                bytecode_files[ext] = file
+            else:
+                asm[ext] = data.decode("utf-8")
+        self.asm = AsmDict(asm, backend=backend, bytecode_files=bytecode_files)
         self.kernel = self.asm[binary_ext]
         # binaries are lazily initialized
         # because it involves doing runtime things
@@ -468,6 +618,14 @@ class CompiledKernel:
         if knobs.runtime.launch_enter_hook is None:
             return None
         ret = LazyDict({"name": self.name, "function": self.function, "stream": stream})
+        if getattr(self.metadata, "profile_buffer_size", None):
+            # Where proton.record ops wrote in the global scratch memory of each program
+            ret.data["profile_buffer"] = {
+                "offset": self.metadata.profile_buffer_offset,
+                "size": self.metadata.profile_buffer_size,
+                "slots": self.metadata.profile_buffer_slots,
+                "scratch_size": self.metadata.global_scratch_size,
+            }
         if not isinstance(self.src, ASTSource) or self.src.fn.launch_metadata is None:
             return ret
         arg_dict = {}
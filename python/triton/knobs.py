@@ -7,7 +7,7 @@ import re
 import subprocess
 import sysconfig
 
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 from contextlib import contextmanager
 from typing import cast, Any, Callable, Generator, Generic, Optional, Protocol, Type, TypeVar, TypedDict, TYPE_CHECKING, Union
 
@@ -244,6 +244,13 @@ class CompileTimes:
     # Duration of saving artifacts/metadata to cache
     store_results: int
 
+    # Ordered mapping from lowering stage to the passes it ran, one dict per
+    # pass execution as returned by `ir.pass_manager.run` with telemetry on
+    # (`knobs.compilation.pass_telemetry`, empty otherwise):
+    # pass, anchor, time_us, ops_before/after, convert_layouts_before/after,
+    # linear_layout/linear_encoding_hits/misses, malloc_bytes and failed.
+    pass_telemetry: list[tuple[str, list[dict[str, Any]]]] = field(default_factory=list)
+
     @property
     def total_lowering(self) -> int:
         return sum((stage[1] for stage in self.lowering_stages))
@@ -344,6 +351,10 @@ class cache_knobs(base_knobs):
 
     manager_class: env_class[CacheManager] = env_class("TRITON_CACHE_MANAGER", "CacheManager")
     remote_manager_class: env_class[RemoteCacheBackend] = env_class("TRITON_REMOTE_CACHE_BACKEND", "RemoteCacheBackend")
+    # Share code generation results between kernels whose optimized LLVM IR is identical
+    codegen: env_bool = env_bool("TRITON_CODEGEN_CACHE", True)
+    # Store MLIR stages (ttir, ttgir) as bytecode rather than textual IR. Dumps stay textual.
+    ir_bytecode: env_bool = env_bool("TRITON_CACHE_IR_BYTECODE")
 
     def get_triton_dir(self, dirname: str) -> str:
         return os.path.join(self.home_dir, ".triton", dirname)
@@ -361,6 +372,11 @@ class compilation_knobs(base_knobs):
     front_end_debugging: env_bool = env_bool("TRITON_FRONT_END_DEBUGGING")
     allow_non_constexpr_globals: env_bool = env_bool("TRITON_ALLOW_NON_CONSTEXPR_GLOBALS")
     enable_experimental_consan: env_bool = env_bool("TRITON_ENABLE_EXPERIMENTAL_CONSAN")
+    smem_best_fit: env_bool = env_bool("TRITON_SMEM_BEST_FIT")
+    layout_cost_model: env_bool = env_bool("TRITON_LAYOUT_COST_MODEL")
+    modulo_schedule: env_bool = env_bool("TRITON_MODULO_SCHEDULE")
+    # Collect CompileTimes.pass_telemetry for the listener. It instruments every pass, so it is opt-in.
+    pass_telemetry: env_bool = env_bool("TRITON_PASS_TELEMETRY")
     listener: Union[CompilationListener, None] = None
 
 
@@ -405,6 +421,7 @@ class JITHook(Protocol):
 
 class runtime_knobs(base_knobs):
     interpret: env_bool = env_bool("TRITON_INTERPRET")
+    interpret_num_threads: env_int = env_int("TRITON_INTERPRET_NUM_THREADS", 1)
     debug: env_bool = env_bool("TRITON_DEBUG")
     override_arch: env_opt_str = env_opt_str("TRITON_OVERRIDE_ARCH")
 
@@ -457,6 +474,7 @@ class amd_knobs(base_knobs):
 
 class proton_knobs(base_knobs):
     cupti_dir: env_opt_str = env_opt_str("TRITON_CUPTI_LIB_PATH")
+    record_slots_per_warp: env_int = env_int("TRITON_PROTON_RECORD_SLOTS", 256)
 
 
 build = build_knobs()
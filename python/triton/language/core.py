@@ -3229,6 +3229,10 @@ class range:
         kernel argument.  The kernel argument only pipelines loads that feed
         into :code:`dot` operations, while this attribute tries to pipeline most
         (though not all) loads in this loop.
+
+        On a loop that contains other loops, the nested loops run in the last
+        stage, so the loads feeding them are issued for the next iterations of
+        the outer loop while the nested loops of the current one run.
     :param loop_unroll_factor: Tells the Triton IR level loop unroller how many
         times to unroll a for loop that this range is used with. Less than 2 for
         this value implies no unrolling.
@@ -1,4 +1,4 @@
-from typing import Optional, Protocol
+from typing import Callable, Optional, Protocol
 
 
 class Buffer(Protocol):
@@ -20,7 +20,9 @@ class NullAllocator:
                            "Use triton.set_allocator to specify an allocator.")
 
 
-_allocator: Allocator = NullAllocator()
+_user_allocator: Allocator = NullAllocator()
+_allocator_wrapper: Optional[Callable[[Allocator], Allocator]] = None
+_allocator: Allocator = _user_allocator
 
 
 def set_allocator(allocator: Allocator):
@@ -28,5 +30,16 @@ def set_allocator(allocator: Allocator):
     The allocator function is called during kernel launch for kernels that
     require additional global memory workspace.
     """
-    global _allocator
-    _allocator = allocator
+    global _user_allocator, _allocator
+    _user_allocator = allocator
+    _allocator = allocator if _allocator_wrapper is None else _allocator_wrapper(allocator)
+
+
+def set_allocator_wrapper(wrapper: Optional[Callable[[Allocator], Allocator]]):
+    """
+    Wraps the allocator, and every allocator set after it, with `wrapper`, e.g.
+    to observe the workspace of each launch.  Pass None to remove it.
+    """
+    global _allocator_wrapper, _allocator
+    _allocator_wrapper = wrapper
+    _allocator = _user_allocator if wrapper is None else wrapper(_user_allocator)
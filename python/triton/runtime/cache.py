@@ -1,8 +1,9 @@
 import json
 import os
+import threading
 import uuid
 from abc import ABC, abstractmethod
-from typing import Dict, List, Optional
+from typing import Callable, Dict, List, Optional, Union
 import base64
 import hashlib
 import functools
@@ -258,6 +259,62 @@ def get_dump_manager(key) -> CacheManager:
     return cls(_base32(key), dump=True)
 
 
+_codegen_stats: Dict[str, Dict[str, int]] = {}
+_codegen_stats_lock = threading.Lock()
+
+
+def _codegen_input_hash(value) -> str:
+    if isinstance(value, str):
+        value = value.encode("utf-8")
+    if isinstance(value, bytes):
+        return hashlib.sha256(value).hexdigest()
+    if hasattr(value, "hash"):
+        # e.g. an LLVM module, hashed without printing it
+        return value.hash()
+    return str(value)
+
+
+def cached_codegen(stage: str, inputs: List, generate: Callable[[], Union[str, bytes]],
+                   binary: bool = False) -> Union[str, bytes]:
+    """
+    Returns the output of a code generation stage (ptx, cubin, amdgcn, ...)
+    from a content-addressed cache shared by every kernel, or `generate()`.
+
+    The compile cache keys kernels by their source and options, so two
+    specializations whose optimized LLVM IR is identical would otherwise run
+    the same code generation twice. `inputs` must determine the output; the
+    IR is hashed by content.
+    """
+    if not knobs.cache.codegen or knobs.compilation.always_compile:
+        return generate()
+    parts = [triton_key(), stage] + [_codegen_input_hash(value) for value in inputs]
+    key = hashlib.sha256("-".join(parts).encode("utf-8")).hexdigest()
+    cache_manager = get_cache_manager(key)
+    filename = f"codegen.{stage}"
+    path = cache_manager.get_file(filename)
+    with _codegen_stats_lock:
+        stats = _codegen_stats.setdefault(stage, {"hits": 0, "misses": 0})
+        stats["hits" if path is not None else "misses"] += 1
+    if path is not None:
+        with open(path, "rb") as f:
+            data = f.read()
+        return data if binary else data.decode("utf-8")
+    data = generate()
+    cache_manager.put(data, filename, binary=binary)
+    return data
+
+
+def get_codegen_cache_stats() -> Dict[str, Dict[str, int]]:
+    """Hits and misses of the code generation cache per stage, in this process."""
+    with _codegen_stats_lock:
+        return {stage: dict(stats) for stage, stats in _codegen_stats.items()}
+
+
+def reset_codegen_cache_stats():
+    with _codegen_stats_lock:
+        _codegen_stats.clear()
+
+
 def make_so_cache_key(version_hash, signature, constants, ids, **kwargs):
     # Get unique key for the compiled code
     signature = {k: 'ptr' if v[0] == '*' else v for k, v in signature.items()}
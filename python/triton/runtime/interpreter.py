@@ -1,10 +1,12 @@
 from __future__ import annotations
 import ast
+import concurrent.futures
 import textwrap
 import inspect
 from typing import Tuple, List, Dict
 
 import math
+import threading
 import numpy as np
 
 import triton
@@ -284,6 +286,16 @@ class InterpreterBuilder:
         self.codegen_fns = {}
         self.codegen_fns["convert_custom_types"] = ExtraFunctions._convert_custom_types
         self.codegen_fns["min_dot_size"] = lambda lhsType, rhsType: (1, 1, 1)
+        # Each thread of a parallel grid runs its own program
+        self._program = threading.local()
+
+    @property
+    def grid_idx(self):
+        return getattr(self._program, "grid_idx", None)
+
+    @grid_idx.setter
+    def grid_idx(self, idx):
+        self._program.grid_idx = idx
 
     def set_grid_idx(self, x, y, z):
         if not x < self.grid_dim[0]:
@@ -1249,6 +1261,37 @@ class GridExecutor:
         for (arg_dev, arg_hst) in storages.values():
             arg_dev.copy_(arg_hst)
 
+    def _run_parallel(self, args, grid, num_threads):
+        # Programs only communicate through atomics, which the native helpers
+        # apply atomically, so they can run on a pool of threads. The threads
+        # overlap wherever numpy or the native helpers release the GIL.
+        num_programs = grid[0] * grid[1] * grid[2]
+        next_program = 0
+        lock = threading.Lock()
+        failed = threading.Event()
+
+        def worker():
+            nonlocal next_program
+            while not failed.is_set():
+                with lock:
+                    pid = next_program
+                    next_program += 1
+                if pid >= num_programs:
+                    return
+                x, yz = divmod(pid, grid[1] * grid[2])
+                y, z = divmod(yz, grid[2])
+                interpreter_builder.set_grid_idx(x, y, z)
+                try:
+                    self.fn(**args)
+                except BaseException:
+                    failed.set()
+                    raise
+
+        with concurrent.futures.ThreadPoolExecutor(max_workers=num_threads) as pool:
+            futures = [pool.submit(worker) for _ in range(min(num_threads, num_programs))]
+        for future in futures:
+            future.result()
+
     def __call__(self, *args_dev, **kwargs):
         if kwargs.pop("warmup", False):
             return
@@ -1270,12 +1313,16 @@ class GridExecutor:
         assert len(grid) <= 3, "grid must have at most 3 dimensions"
         grid = grid + (1, ) * (3 - len(grid))
         interpreter_builder.set_grid_dim(*grid)
+        num_threads = triton.knobs.runtime.interpret_num_threads
         try:
-            for x in range(grid[0]):
-                for y in range(grid[1]):
-                    for z in range(grid[2]):
-                        interpreter_builder.set_grid_idx(x, y, z)
-                        self.fn(**args)
+            if num_threads > 1:
+                self._run_parallel(args, grid, num_threads)
+            else:
+                for x in range(grid[0]):
+                    for y in range(grid[1]):
+                        for z in range(grid[2]):
+                            interpreter_builder.set_grid_idx(x, y, z)
+                            self.fn(**args)
         except Exception as e:
             if triton.knobs.compilation.front_end_debugging:
                 raise
@@ -1,5 +1,6 @@
 // RUN: triton-opt %s -allow-unregistered-dialect -test-print-allocation -verify-diagnostics -o /dev/null
 // RUN: triton-opt %s -allow-unregistered-dialect -test-print-allocation="get-scratch-size-function=ValidConstant" 2>&1 | FileCheck %s --check-prefix=CHECK-128
+// RUN: triton-opt %s -allow-unregistered-dialect -test-print-allocation="allocation-policy=BestFit" 2>&1 | FileCheck %s --check-prefix=BESTFIT
 
 // Check there are no lines with a size different to 128 and we have at least a line with size 128.
 
@@ -11,6 +12,7 @@
 #sliceAd0 = #ttg.slice<{dim = 0, parent = #AL}>
 #BL = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
 #A_SHARED = #ttg.swizzled_shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#A_SHARED_1D = #ttg.swizzled_shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0]}>
 #A_SHARED_T = #ttg.swizzled_shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [0, 1]}>
 #B_SHARED = #ttg.swizzled_shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #C = #ttg.nvidia_mma<{versionMajor = 2, warpsPerCTA = [4, 1], instrShape = [16, 8]}>
@@ -200,6 +202,11 @@ tt.func @longlive(%A : !tt.ptr<f16>) {
 }
 
 // This example triggers graph coloring with > 1 colors.
+// Best-fit packing places %cst_1, %cst_7 and %cst_0 right above the convert
+// scratch buffers instead of bumping them past the whole color-1 band.
+// BESTFIT-LABEL: remark: multi_color{{$}}
+// BESTFIT: remark: size = 1440
+// BESTFIT: remark: saved = 64
 // expected-remark @below {{multi_color}}
 // expected-remark @below {{size = 1504}}
 tt.func @multi_color(%A : !tt.ptr<f16>) {
@@ -247,6 +254,10 @@ tt.func @multi_color(%A : !tt.ptr<f16>) {
 }
 
 // This example triggers graph coloring with multiple rounds
+// Graph coloring is already optimal here, so best-fit keeps its result.
+// BESTFIT-LABEL: remark: multi_color_multi_rounds
+// BESTFIT: remark: size = 9504
+// BESTFIT: remark: saved = 0
 // expected-remark @below {{multi_color_multi_rounds}}
 // expected-remark @below {{size = 9504}}
 tt.func @multi_color_multi_rounds(%arg0: !tt.ptr<f16>) {
@@ -273,6 +284,92 @@ tt.func @multi_color_multi_rounds(%arg0: !tt.ptr<f16>) {
   tt.return
 }
 
+// Best-fit compares the gaps left after aligning the start of a buffer. The
+// gap below %a is 96 bytes, but only 64 once %g is aligned in it, as tight as
+// the gap above %a. So %g takes the lower gap and leaves the upper one to %d.
+// BESTFIT-LABEL: remark: best_fit_aligned_gap
+// BESTFIT: remark: offset = 320, size = 16
+// BESTFIT: remark: offset = 192, size = 32
+// BESTFIT: remark: size = 432
+// BESTFIT: remark: saved = 32
+// expected-remark @below {{best_fit_aligned_gap}}
+// expected-remark @below {{size = 464}}
+tt.func @best_fit_aligned_gap() {
+  // expected-remark @below {{offset = 256, size = 64}}
+  %a = ttg.local_alloc {alignment = 128 : i32} : () -> !ttg.memdesc<64xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 0, size = 256}}
+  %b = ttg.local_alloc {alignment = 16 : i32} : () -> !ttg.memdesc<256xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 384, size = 48}}
+  %c = ttg.local_alloc {alignment = 128 : i32} : () -> !ttg.memdesc<48xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 448, size = 16}}
+  %d = ttg.local_alloc {alignment = 64 : i32} : () -> !ttg.memdesc<16xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>
+  "use"(%b) : (!ttg.memdesc<256xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>) -> ()
+  // expected-remark @below {{offset = 0, size = 96}}
+  %e = ttg.local_alloc {alignment = 64 : i32} : () -> !ttg.memdesc<96xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 96, size = 64}}
+  %f = ttg.local_alloc {alignment = 16 : i32} : () -> !ttg.memdesc<64xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 192, size = 32}}
+  %g = ttg.local_alloc {alignment = 64 : i32} : () -> !ttg.memdesc<32xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>
+  "use"(%d) : (!ttg.memdesc<16xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>) -> ()
+  "use"(%a) : (!ttg.memdesc<64xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>) -> ()
+  "use"(%g) : (!ttg.memdesc<32xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>) -> ()
+  "use"(%c) : (!ttg.memdesc<48xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>) -> ()
+  "use"(%f) : (!ttg.memdesc<64xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>) -> ()
+  "use"(%e) : (!ttg.memdesc<96xi8, #A_SHARED_1D, #ttg.shared_memory, mutable>) -> ()
+  tt.return
+}
+
+// Every buffer is live together with the three allocated before and after it.
+// Graph coloring leaves holes the larger buffers cannot reuse, best-fit
+// packs the window into the 5120 bytes its largest live set needs.
+// BESTFIT-LABEL: remark: sliding_window
+// BESTFIT: remark: offset = 4608, size = 512
+// BESTFIT: remark: offset = 3584, size = 1024
+// BESTFIT: remark: offset = 2048, size = 1536
+// BESTFIT: remark: offset = 0, size = 2048
+// BESTFIT: remark: offset = 4608, size = 512
+// BESTFIT: remark: offset = 3584, size = 1024
+// BESTFIT: remark: offset = 2048, size = 1536
+// BESTFIT: remark: offset = 0, size = 2048
+// BESTFIT: remark: offset = 4608, size = 512
+// BESTFIT: remark: offset = 3584, size = 1024
+// BESTFIT: remark: size = 5120
+// BESTFIT: remark: saved = 1024
+// expected-remark @below {{sliding_window}}
+// expected-remark @below {{size = 6144}}
+tt.func @sliding_window() {
+  // expected-remark @below {{offset = 4608, size = 512}}
+  %b0 = ttg.local_alloc : () -> !ttg.memdesc<16x16xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 3584, size = 1024}}
+  %b1 = ttg.local_alloc : () -> !ttg.memdesc<16x32xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 2048, size = 1536}}
+  %b2 = ttg.local_alloc : () -> !ttg.memdesc<16x48xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 0, size = 2048}}
+  %b3 = ttg.local_alloc : () -> !ttg.memdesc<16x64xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b0 : !ttg.memdesc<16x16xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 5632, size = 512}}
+  %b4 = ttg.local_alloc : () -> !ttg.memdesc<16x16xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b1 : !ttg.memdesc<16x32xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 4608, size = 1024}}
+  %b5 = ttg.local_alloc : () -> !ttg.memdesc<16x32xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b2 : !ttg.memdesc<16x48xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 3072, size = 1536}}
+  %b6 = ttg.local_alloc : () -> !ttg.memdesc<16x48xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b3 : !ttg.memdesc<16x64xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 0, size = 2048}}
+  %b7 = ttg.local_alloc : () -> !ttg.memdesc<16x64xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b4 : !ttg.memdesc<16x16xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 5632, size = 512}}
+  %b8 = ttg.local_alloc : () -> !ttg.memdesc<16x16xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b5 : !ttg.memdesc<16x32xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  // expected-remark @below {{offset = 2048, size = 1024}}
+  %b9 = ttg.local_alloc : () -> !ttg.memdesc<16x32xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b6 : !ttg.memdesc<16x48xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b7 : !ttg.memdesc<16x64xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b8 : !ttg.memdesc<16x16xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  ttg.local_dealloc %b9 : !ttg.memdesc<16x32xf16, #A_SHARED, #ttg.shared_memory, mutable>
+  tt.return
+}
 
 // expected-remark @below {{alloc}}
 // expected-remark @below {{size = 512}}
@@ -904,3 +904,59 @@ tt.func @membar_alias_through_warp_specialize() {
 }
 
 }
+
+// -----
+
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared = #ttg.swizzled_shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#smem = #ttg.shared_memory
+
+module attributes {"ttg.num-warps" = 4 : i32} {
+
+// A pipeline with three stages of two operands keeps six disjoint buffers in
+// flight. The first load reads what the stores wrote and the stores of the
+// next iteration overwrite what the loads read, so only the first store and
+// the first load of the body need a barrier.
+// CHECK-LABEL: @deep_pipeline
+tt.func @deep_pipeline(%lb : index, %ub : index, %step : index) {
+  %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf16, #blocked>
+  %b0 = ttg.local_alloc : () -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+  %b1 = ttg.local_alloc : () -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+  %b2 = ttg.local_alloc : () -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+  %b3 = ttg.local_alloc : () -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+  %b4 = ttg.local_alloc : () -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+  %b5 = ttg.local_alloc : () -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+  // CHECK: scf.for
+  scf.for %iv = %lb to %ub step %step {
+    // CHECK-NEXT: gpu.barrier
+    // CHECK-NEXT: local_store
+    ttg.local_store %cst, %b0 : tensor<32x32xf16, #blocked> -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+    // CHECK-NEXT: local_store
+    ttg.local_store %cst, %b1 : tensor<32x32xf16, #blocked> -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+    // CHECK-NEXT: local_store
+    ttg.local_store %cst, %b2 : tensor<32x32xf16, #blocked> -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+    // CHECK-NEXT: local_store
+    ttg.local_store %cst, %b3 : tensor<32x32xf16, #blocked> -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+    // CHECK-NEXT: local_store
+    ttg.local_store %cst, %b4 : tensor<32x32xf16, #blocked> -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+    // CHECK-NEXT: local_store
+    ttg.local_store %cst, %b5 : tensor<32x32xf16, #blocked> -> !ttg.memdesc<32x32xf16, #shared, #smem, mutable>
+    // CHECK-NEXT: gpu.barrier
+    // CHECK-NEXT: local_load
+    %l0 = ttg.local_load %b0 : !ttg.memdesc<32x32xf16, #shared, #smem, mutable> -> tensor<32x32xf16, #blocked>
+    // CHECK-NEXT: local_load
+    %l1 = ttg.local_load %b1 : !ttg.memdesc<32x32xf16, #shared, #smem, mutable> -> tensor<32x32xf16, #blocked>
+    // CHECK-NEXT: local_load
+    %l2 = ttg.local_load %b2 : !ttg.memdesc<32x32xf16, #shared, #smem, mutable> -> tensor<32x32xf16, #blocked>
+    // CHECK-NEXT: local_load
+    %l3 = ttg.local_load %b3 : !ttg.memdesc<32x32xf16, #shared, #smem, mutable> -> tensor<32x32xf16, #blocked>
+    // CHECK-NEXT: local_load
+    %l4 = ttg.local_load %b4 : !ttg.memdesc<32x32xf16, #shared, #smem, mutable> -> tensor<32x32xf16, #blocked>
+    // CHECK-NEXT: local_load
+    %l5 = ttg.local_load %b5 : !ttg.memdesc<32x32xf16, #shared, #smem, mutable> -> tensor<32x32xf16, #blocked>
+    // CHECK-NEXT: }
+  }
+  tt.return
+}
+
+}
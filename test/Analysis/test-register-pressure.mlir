@@ -0,0 +1,56 @@
+// RUN: triton-opt %s -test-print-register-pressure -verify-diagnostics -o /dev/null
+
+// Each thread holds 32 elements of a 64x64 tensor.
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+module attributes {"ttg.num-warps" = 4 : i32, "ttg.threads-per-warp" = 32 : i32} {
+
+// %a and %b are live across the first add, whose result needs 32 more
+// registers. The results of the other ops reuse the registers of their last
+// operands.
+// expected-remark @below {{peak = 96}}
+tt.func @straight_line(%a: tensor<64x64xf32, #blocked>, %b: tensor<64x64xf32, #blocked>) -> tensor<64x64xf32, #blocked> {
+  %0 = arith.addf %a, %b : tensor<64x64xf32, #blocked>
+  %1 = arith.mulf %0, %a : tensor<64x64xf32, #blocked>
+  %2 = arith.addf %1, %b : tensor<64x64xf32, #blocked>
+  tt.return %2 : tensor<64x64xf32, #blocked>
+}
+
+// %w is only used after the loop, but it holds 16 registers in the loop body
+// as well.
+// expected-remark @below {{peak = 112}}
+tt.func @loop(%lb: i32, %ub: i32, %step: i32, %x: tensor<64x64xf32, #blocked>, %w: tensor<64x64xf16, #blocked>) -> tensor<64x64xf32, #blocked> {
+  %init = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+  // expected-remark @below {{loop peak = 112}}
+  %r = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init) -> (tensor<64x64xf32, #blocked>) : i32 {
+    %c = arith.constant dense<2.000000e+00> : tensor<64x64xf32, #blocked>
+    %y = arith.mulf %acc, %c : tensor<64x64xf32, #blocked>
+    %z = arith.addf %y, %x : tensor<64x64xf32, #blocked>
+    scf.yield %z : tensor<64x64xf32, #blocked>
+  }
+  %wf = arith.extf %w : tensor<64x64xf16, #blocked> to tensor<64x64xf32, #blocked>
+  %o = arith.addf %r, %wf : tensor<64x64xf32, #blocked>
+  tt.return %o : tensor<64x64xf32, #blocked>
+}
+
+// The partitions run on other warps, so %v doesn't hold registers in them.
+// expected-remark @below {{peak = 32}}
+tt.func @partition(%v: tensor<64x64xf32, #blocked>, %lb: i32, %ub: i32, %step: i32) -> tensor<64x64xf32, #blocked> {
+  ttg.warp_specialize(%lb, %ub, %step)
+  default {
+    ttg.warp_yield
+  }
+  partition0(%a: i32, %b: i32, %c: i32) num_warps(4) {
+    %init = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    // expected-remark @below {{loop peak = 32}}
+    %r = scf.for %iv = %a to %b step %c iter_args(%acc = %init) -> (tensor<64x64xf32, #blocked>) : i32 {
+      %n = arith.addf %acc, %acc : tensor<64x64xf32, #blocked>
+      scf.yield %n : tensor<64x64xf32, #blocked>
+    }
+    ttg.warp_return
+  } : (i32, i32, i32) -> ()
+  %o = arith.addf %v, %v : tensor<64x64xf32, #blocked>
+  tt.return %o : tensor<64x64xf32, #blocked>
+}
+
+}
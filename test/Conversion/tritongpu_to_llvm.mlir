@@ -895,6 +895,25 @@ module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #ttg.blocked<{sizePerThread = [1, 32], threadsPerWarp = [32, 1], warpsPerCTA = [1, 4], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#blocked1 = #ttg.blocked<{sizePerThread = [4, 8], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32} {
+  // Data moves between warps, so it goes through shared memory.
+  // CHECK: llvm.mlir.global external @global_smem
+  // CHECK-LABEL: convert_layout_blocked_blocked_across_warps
+  tt.func @convert_layout_blocked_blocked_across_warps(%arg0: tensor<32x128xf32, #blocked0>) {
+    // CHECK-NOT: nvvm.shfl.sync
+    // CHECK: llvm.mlir.addressof @global_smem
+    // CHECK: llvm.store
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load
+    %0 = ttg.convert_layout %arg0 : tensor<32x128xf32, #blocked0> -> tensor<32x128xf32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #shared0 = #ttg.swizzled_shared<{vec = 1, perPhase=1, maxPhase=1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #mma0 = #ttg.nvidia_mma<{versionMajor = 2, warpsPerCTA = [1, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], instrShape = [16, 8]}>
@@ -1069,6 +1088,38 @@ module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked = #ttg.blocked<{sizePerThread = [1, 2], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0]}>
+#mma = #ttg.nvidia_mma<{versionMajor = 2, warpsPerCTA = [1, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], instrShape = [16, 8]}>
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 1 : i32} {
+  // One register bit of each layout is a lane bit of the other, which is
+  // cheaper to exchange with shuffles than through shared memory.
+  // CHECK-LABEL: convert_layout_blocked_mmav2_shuffle
+  tt.func @convert_layout_blocked_mmav2_shuffle(%arg0: tensor<16x16xf32, #blocked>) {
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: nvvm.shfl.sync
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: llvm.load
+    // CHECK: llvm.return
+    %0 = ttg.convert_layout %arg0 : tensor<16x16xf32, #blocked> -> tensor<16x16xf32, #mma>
+    tt.return
+  }
+
+  // CHECK-LABEL: convert_layout_mmav2_blocked_shuffle
+  tt.func @convert_layout_mmav2_blocked_shuffle(%arg0: tensor<16x16xf32, #mma>) {
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: nvvm.shfl.sync
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: llvm.load
+    // CHECK: llvm.return
+    %0 = ttg.convert_layout %arg0 : tensor<16x16xf32, #mma> -> tensor<16x16xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
 #mma = #ttg.nvidia_mma<{versionMajor = 2, warpsPerCTA = [1, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], instrShape = [16, 8]}>
 #dot1 = #ttg.dot_op<{opIdx=0, parent=#mma, kWidth=2}>
 module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 1 : i32} {
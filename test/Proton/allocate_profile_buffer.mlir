@@ -0,0 +1,35 @@
+// RUN: triton-opt %s -split-input-file --tritongpu-global-scratch-memory-allocation --proton-allocate-profile-buffer="slots-per-warp=4" | FileCheck %s
+
+// 4 warps with 8 header bytes and 4 records of 8 bytes each
+// CHECK: module attributes {proton.profile_buffer_offset = 0 : i32, proton.profile_buffer_size = 160 : i32, proton.profile_buffer_slots = 4 : i32, {{.*}}ttg.global_scratch_memory_alignment = 8 : i32, ttg.global_scratch_memory_size = 160 : i32
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK: @record{{.*}}ttg.global_scratch_memory_alignment = 8 : i32, ttg.global_scratch_memory_size = 160 : i32
+  tt.func public @record() {
+    proton.record() {isStart = true, regionId = 0 : i32}
+    proton.record() {isStart = false, regionId = 0 : i32}
+    tt.return
+  }
+}
+
+// -----
+
+// The profile buffer is placed after the existing scratch allocations
+// CHECK: module attributes {proton.profile_buffer_offset = 104 : i32, proton.profile_buffer_size = 160 : i32, proton.profile_buffer_slots = 4 : i32, {{.*}}ttg.global_scratch_memory_alignment = 8 : i32, ttg.global_scratch_memory_size = 264 : i32
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  tt.func public @record_with_scratch() -> !tt.ptr<i8> {
+    proton.record() {isStart = true, regionId = 0 : i32}
+    %0 = ttg.global_scratch_alloc {alignment = 8 : i32, nbytes = 100 : i32} : !tt.ptr<i8>
+    proton.record() {isStart = false, regionId = 0 : i32}
+    tt.return %0 : !tt.ptr<i8>
+  }
+}
+
+// -----
+
+// CHECK: module attributes {
+// CHECK-NOT: proton.profile_buffer
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  tt.func public @no_record() {
+    tt.return
+  }
+}
@@ -0,0 +1,42 @@
+// RUN: triton-opt %s -split-input-file --tritongpu-global-scratch-memory-allocation --proton-allocate-profile-buffer="slots-per-warp=4" --allocate-shared-memory --convert-triton-gpu-to-llvm | FileCheck %s
+
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: llvm.func @record_warpgroup
+  tt.func public @record_warpgroup() {
+    // CHECK: llvm.call_intrinsic "llvm.nvvm.read.ptx.sreg.clock64"
+    // CHECK: llvm.trunc %{{.*}} : i64 to i32
+    // CHECK: llvm.cond_br
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<1> -> i32
+    // CHECK: llvm.urem %{{.*}}, %{{.*}} : i32
+    // CHECK: llvm.store
+    // CHECK: llvm.store
+    // CHECK: llvm.store
+    // CHECK: llvm.br
+    proton.record() {isStart = true, regionId = 1 : i32}
+    // CHECK: llvm.call_intrinsic "llvm.nvvm.read.ptx.sreg.clock64"
+    // CHECK: llvm.cond_br
+    proton.record() {isStart = false, regionId = 1 : i32}
+    // CHECK-NOT: proton.record
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  // Records outside of the kernel are dropped, since the profile buffer is
+  // only allocated for kernels with records
+  // CHECK-LABEL: llvm.func internal @device_fn
+  // CHECK-NOT: llvm.nvvm.read.ptx.sreg.clock64
+  // CHECK: llvm.return
+  tt.func private @device_fn() attributes {noinline = true} {
+    proton.record() {isStart = true, regionId = 1 : i32}
+    proton.record() {isStart = false, regionId = 1 : i32}
+    tt.return
+  }
+
+  tt.func public @call_device_fn() {
+    tt.call @device_fn() : () -> ()
+    tt.return
+  }
+}
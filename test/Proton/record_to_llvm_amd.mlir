@@ -0,0 +1,16 @@
+// RUN: triton-opt %s --tritongpu-global-scratch-memory-allocation --proton-allocate-profile-buffer="slots-per-warp=4" --allocate-shared-memory --convert-triton-amdgpu-to-llvm=arch=gfx942 | FileCheck %s
+
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "hip:gfx942", "ttg.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: llvm.func @record_warpgroup
+  tt.func public @record_warpgroup() {
+    // CHECK: llvm.call_intrinsic "llvm.amdgcn.s.memtime"
+    // CHECK: llvm.trunc %{{.*}} : i64 to i32
+    // CHECK: llvm.cond_br
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<1> -> i32
+    // CHECK: llvm.store
+    proton.record() {isStart = true, regionId = 0 : i32}
+    // CHECK: llvm.call_intrinsic "llvm.amdgcn.s.memtime"
+    proton.record() {isStart = false, regionId = 0 : i32}
+    tt.return
+  }
+}
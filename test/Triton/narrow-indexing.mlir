@@ -0,0 +1,84 @@
+// RUN: triton-opt %s -split-input-file -triton-narrow-indexing | FileCheck %s
+
+// CHECK-LABEL: @narrow_offsets
+tt.func @narrow_offsets(%arg0: !tt.ptr<f32>) -> tensor<128xf32> {
+  // CHECK-DAG: %[[STRIDE:.*]] = arith.constant dense<4> : tensor<128xi32>
+  // CHECK-DAG: %[[C16:.*]] = arith.constant 16 : i32
+  // CHECK-DAG: %[[RANGE:.*]] = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK: %[[MUL:.*]] = arith.muli %[[RANGE]], %[[STRIDE]] : tensor<128xi32>
+  // CHECK: %[[BASE:.*]] = tt.splat %[[C16]] : i32 -> tensor<128xi32>
+  // CHECK: %[[OFFSET:.*]] = arith.addi %[[MUL]], %[[BASE]] : tensor<128xi32>
+  // CHECK: tt.addptr %{{.*}}, %[[OFFSET]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK-NOT: i64
+  %c4 = arith.constant dense<4> : tensor<128xi64>
+  %c16 = arith.constant 16 : i64
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = arith.extsi %0 : tensor<128xi32> to tensor<128xi64>
+  %2 = arith.muli %1, %c4 : tensor<128xi64>
+  %3 = tt.splat %c16 : i64 -> tensor<128xi64>
+  %4 = arith.addi %2, %3 : tensor<128xi64>
+  %5 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %6 = tt.addptr %5, %4 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %7 = tt.load %6 : tensor<128x!tt.ptr<f32>>
+  tt.return %7 : tensor<128xf32>
+}
+
+// -----
+
+// The program id can be as large as 2^31 - 1, so the offset may not fit in
+// i32 and is left alone.
+// CHECK-LABEL: @keep_wide_offsets
+tt.func @keep_wide_offsets(%arg0: !tt.ptr<f32>) -> tensor<128xf32> {
+  // CHECK: %[[PID:.*]] = arith.extsi %{{.*}} : i32 to i64
+  // CHECK: %[[OFFSET:.*]] = arith.muli %[[PID]], %{{.*}} : i64
+  // CHECK: tt.addptr %{{.*}}, %[[OFFSET]] : !tt.ptr<f32>, i64
+  %c128 = arith.constant 128 : i64
+  %0 = tt.get_program_id x : i32
+  %1 = arith.extsi %0 : i32 to i64
+  %2 = arith.muli %1, %c128 : i64
+  %3 = tt.addptr %arg0, %2 : !tt.ptr<f32>, i64
+  %4 = tt.splat %3 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %5 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %6 = tt.addptr %4, %5 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %7 = tt.load %6 : tensor<128x!tt.ptr<f32>>
+  tt.return %7 : tensor<128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @drop_true_masks
+tt.func @drop_true_masks(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>, %n: i32) {
+  %c256 = arith.constant 256 : i32
+  %cond = arith.cmpi sge, %n, %c256 : i32
+  llvm.intr.assume %cond : i1
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf32>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %n : i32 -> tensor<128xi32>
+  // CHECK-NOT: arith.cmpi slt
+  %mask = arith.cmpi slt, %0, %1 : tensor<128xi32>
+  %2 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %3 = tt.addptr %2, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: %[[VAL:.*]] = tt.load %{{.*}} : tensor<128x!tt.ptr<f32>>
+  %4 = tt.load %3, %mask, %cst : tensor<128x!tt.ptr<f32>>
+  %5 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %6 = tt.addptr %5, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.store %{{.*}}, %[[VAL]] : tensor<128x!tt.ptr<f32>>
+  tt.store %6, %4, %mask : tensor<128x!tt.ptr<f32>>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @keep_masks
+tt.func @keep_masks(%arg0: !tt.ptr<f32>, %n: i32) -> tensor<128xf32> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf32>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %n : i32 -> tensor<128xi32>
+  // CHECK: %[[MASK:.*]] = arith.cmpi slt
+  %mask = arith.cmpi slt, %0, %1 : tensor<128xi32>
+  %2 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %3 = tt.addptr %2, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.load %{{.*}}, %[[MASK]], %{{.*}} : tensor<128x!tt.ptr<f32>>
+  %4 = tt.load %3, %mask, %cst : tensor<128x!tt.ptr<f32>>
+  tt.return %4 : tensor<128xf32>
+}
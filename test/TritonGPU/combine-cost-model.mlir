@@ -0,0 +1,47 @@
+// RUN: triton-opt %s -tritongpu-remove-layout-conversions=cost-model=true -mlir-pass-statistics 2>&1 | FileCheck %s
+// RUN: triton-opt %s -tritongpu-remove-layout-conversions | FileCheck %s --check-prefix=HEURISTIC
+
+// Statistics are printed when the pass manager finishes, before the IR. Each
+// conversion between warps goes through shared memory: 64x64 f32 values are
+// stored and loaded back.
+// CHECK: TritonGPURemoveLayoutConversions
+// CHECK-DAG: (S) {{ *}}2 remaining-converts
+// CHECK-DAG: (S) {{ *}}65536 shared-memory-bytes
+
+#A = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#B = #ttg.blocked<{sizePerThread = [4, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#M = #ttg.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 4], instrShape = [16, 8]}>
+
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+  // The sum is reached by both layouts. Computing it in #A needs a single
+  // conversion, computing it in #B needs one for each operand.
+  // CHECK-LABEL: @epilogue
+  tt.func public @epilogue(%arg0: tensor<64x64xf32, #A>, %arg1: tensor<64x64xf32, #B>, %arg2: tensor<64x64x!tt.ptr<f32>, #A>) {
+    // CHECK: %[[CVT:.*]] = ttg.convert_layout %arg1 : {{.*}} -> tensor<64x64xf32, #[[A:blocked[0-9]*]]>
+    // CHECK-NEXT: %[[SUM:.*]] = arith.addf %arg0, %[[CVT]] : tensor<64x64xf32, #[[A]]>
+    // CHECK-NEXT: tt.store %arg2, %[[SUM]]
+    %0 = ttg.convert_layout %arg1 : tensor<64x64xf32, #B> -> tensor<64x64xf32, #A>
+    %1 = arith.addf %arg0, %0 : tensor<64x64xf32, #A>
+    tt.store %arg2, %1 : tensor<64x64x!tt.ptr<f32>, #A>
+    tt.return
+  }
+
+  // Without the cost model conflicts are resolved in favor of the mma layout,
+  // which converts %arg0 to it and the sum back for the store. The cost model
+  // computes the sum in #A and only converts %arg1.
+  // CHECK-LABEL: @prefer_cheaper_anchor
+  // HEURISTIC-LABEL: @prefer_cheaper_anchor
+  tt.func public @prefer_cheaper_anchor(%arg0: tensor<64x64xf32, #A>, %arg1: tensor<64x64xf32, #M>, %arg2: tensor<64x64x!tt.ptr<f32>, #A>) {
+    // CHECK: %[[CVT:.*]] = ttg.convert_layout %arg1 : tensor<64x64xf32, #mma> -> tensor<64x64xf32, #[[A:blocked[0-9]*]]>
+    // CHECK-NEXT: %[[SUM:.*]] = arith.addf %arg0, %[[CVT]] : tensor<64x64xf32, #[[A]]>
+    // CHECK-NEXT: tt.store %arg2, %[[SUM]]
+    // HEURISTIC: ttg.convert_layout %arg0 : tensor<64x64xf32, #{{blocked[0-9]*}}> -> tensor<64x64xf32, #mma>
+    // HEURISTIC: arith.addf {{.*}} : tensor<64x64xf32, #mma>
+    // HEURISTIC: ttg.convert_layout {{.*}} : tensor<64x64xf32, #mma> -> tensor<64x64xf32, #{{blocked[0-9]*}}>
+    // HEURISTIC-NEXT: tt.store %arg2
+    %0 = ttg.convert_layout %arg1 : tensor<64x64xf32, #M> -> tensor<64x64xf32, #A>
+    %1 = arith.addf %arg0, %0 : tensor<64x64xf32, #A>
+    tt.store %arg2, %1 : tensor<64x64x!tt.ptr<f32>, #A>
+    tt.return
+  }
+}
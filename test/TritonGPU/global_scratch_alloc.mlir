@@ -32,3 +32,129 @@ module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.targ
     tt.return %0, %1 : !tt.ptr<i8>, !tt.ptr<i8>
   }
 }
+
+// -----
+
+// CHECK: module attributes {ttg.global_scratch_memory_alignment = 128 : i32, ttg.global_scratch_memory_size = 128 : i32{{.*}}}
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @disjoint_lifetimes
+  tt.func public @disjoint_lifetimes(%arg0: !tt.ptr<i8>) {
+    // The first user of the bytes needs no barrier
+    // CHECK-NOT: gpu.barrier
+    // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 0
+    %0 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+    %1 = tt.load %0 : !tt.ptr<i8>
+    // Every thread is done with %0 before its bytes are reused
+    // CHECK: tt.load
+    // CHECK-NEXT: gpu.barrier
+    // CHECK-NEXT: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 0
+    %2 = ttg.global_scratch_alloc {alignment = 64 : i32, nbytes = 64 : i32} : !tt.ptr<i8>
+    %3 = tt.load %2 : !tt.ptr<i8>
+    %4 = arith.addi %1, %3 : i8
+    tt.store %arg0, %4 : !tt.ptr<i8>
+    tt.return
+  }
+}
+
+// -----
+
+// CHECK: module attributes {ttg.global_scratch_memory_alignment = 128 : i32, ttg.global_scratch_memory_size = 256 : i32{{.*}}}
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @derived_pointer
+  tt.func public @derived_pointer(%arg0: !tt.ptr<i8>) {
+    %c1_i32 = arith.constant 1 : i32
+    // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 0
+    %0 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+    %1 = tt.addptr %0, %c1_i32 : !tt.ptr<i8>, i32
+    // %0 is still live through %1
+    // CHECK-NOT: gpu.barrier
+    // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 128
+    %2 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+    %3 = tt.load %2 : !tt.ptr<i8>
+    %4 = tt.load %1 : !tt.ptr<i8>
+    %5 = arith.addi %3, %4 : i8
+    tt.store %arg0, %5 : !tt.ptr<i8>
+    tt.return
+  }
+}
+
+// -----
+
+// CHECK: module attributes {ttg.global_scratch_memory_alignment = 128 : i32, ttg.global_scratch_memory_size = 256 : i32{{.*}}}
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @loop
+  tt.func public @loop(%arg0: !tt.ptr<i8>, %lb: i32, %ub: i32) {
+    %c1_i32 = arith.constant 1 : i32
+    // CHECK-NOT: gpu.barrier
+    // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 0
+    %0 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+    scf.for %i = %lb to %ub step %c1_i32 : i32 {
+      // %0 is live across the loop. %1 reuses the bytes %3 had in the
+      // previous iteration, so it needs a barrier as well.
+      // CHECK: gpu.barrier
+      // CHECK-NEXT: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 128
+      %1 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+      %2 = tt.load %1 : !tt.ptr<i8>
+      tt.store %0, %2 : !tt.ptr<i8>
+      // CHECK: gpu.barrier
+      // CHECK-NEXT: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 128
+      %3 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+      %4 = tt.load %3 : !tt.ptr<i8>
+      tt.store %arg0, %4 : !tt.ptr<i8>
+    }
+    tt.return
+  }
+}
+
+// -----
+
+#shared = #ttg.nvmma_shared<{swizzlingByteWidth = 128, transposed = false, elementBitWidth = 16}>
+#blocked = #ttg.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+// CHECK: module attributes {ttg.global_scratch_memory_alignment = 128 : i32, ttg.global_scratch_memory_size = 256 : i32{{.*}}}
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @tensor_descriptors
+  tt.func public @tensor_descriptors(%arg0: i32) -> (tensor<64x64xf16, #blocked>, tensor<64x64xf16, #blocked>) {
+    // Descriptors are read by the async proxy, so their bytes are not shared
+    // even though their lifetimes don't overlap
+    // CHECK-NOT: gpu.barrier
+    // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 0
+    %0 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+    %1 = ttng.reinterpret_tensor_descriptor %0 : !tt.ptr<i8> to !tt.tensordesc<tensor<64x64xf16, #shared>>
+    %2 = tt.descriptor_load %1[%arg0, %arg0] : !tt.tensordesc<tensor<64x64xf16, #shared>> -> tensor<64x64xf16, #blocked>
+    // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 128
+    %3 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+    %4 = ttng.reinterpret_tensor_descriptor %3 : !tt.ptr<i8> to !tt.tensordesc<tensor<64x64xf16, #shared>>
+    %5 = tt.descriptor_load %4[%arg0, %arg0] : !tt.tensordesc<tensor<64x64xf16, #shared>> -> tensor<64x64xf16, #blocked>
+    tt.return %2, %5 : tensor<64x64xf16, #blocked>, tensor<64x64xf16, #blocked>
+  }
+}
+
+// -----
+
+// CHECK: module attributes {ttg.global_scratch_memory_alignment = 128 : i32, ttg.global_scratch_memory_size = 256 : i32{{.*}}}
+module attributes {"ttg.num-ctas" = 1 : i32, "ttg.num-warps" = 4 : i32, ttg.target = "cuda:90", "ttg.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @warp_specialize
+  tt.func public @warp_specialize(%arg0: !tt.ptr<i8>) {
+    ttg.warp_specialize(%arg0)
+    default {
+      ttg.warp_yield
+    }
+    // Partitions run concurrently, so their buffers don't share bytes
+    // CHECK-NOT: gpu.barrier
+    partition0(%arg1: !tt.ptr<i8>) num_warps(1) {
+      // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 0
+      %0 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+      %1 = tt.load %0 : !tt.ptr<i8>
+      tt.store %arg1, %1 : !tt.ptr<i8>
+      ttg.warp_return
+    }
+    partition1(%arg1: !tt.ptr<i8>) num_warps(1) {
+      // CHECK: ttg.global_scratch_alloc {{.*}}ttg.global_scratch_memory_offset = 128
+      %0 = ttg.global_scratch_alloc {alignment = 128 : i32, nbytes = 128 : i32} : !tt.ptr<i8>
+      %1 = tt.load %0 : !tt.ptr<i8>
+      tt.store %arg1, %1 : !tt.ptr<i8>
+      ttg.warp_return
+    } : (!tt.ptr<i8>) -> ()
+    tt.return
+  }
+}
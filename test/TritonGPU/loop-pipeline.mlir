@@ -284,6 +284,192 @@ tt.func @matmul_loop_nested(%lb : index, %ub : index, %step : index,
   tt.return %loop1#0 : tensor<128x128xf32, #C>
 }
 
+// The outer loop asks to be pipelined: the A tile of the next outer iterations
+// is copied while the inner loop of the current one runs.
+// CHECK-LABEL: tt.func @outer_loop_prefetch
+// CHECK: %[[ABUFFER:.*]] = ttg.local_alloc
+// CHECK: ttg.async_copy_global_to_local
+// CHECK: ttg.async_commit_group
+// CHECK: ttg.async_copy_global_to_local
+// CHECK: ttg.async_commit_group
+// CHECK: scf.for
+// CHECK-DAG: ttg.async_wait
+// CHECK-DAG: %[[A:.*]] = ttg.memdesc_subview %[[ABUFFER]]
+// CHECK:   ttg.local_load %[[A]]
+// CHECK:   scf.for
+// CHECK:     tt.load
+// CHECK:     tt.dot
+// CHECK:     scf.yield
+// CHECK:   ttg.memdesc_subview %[[ABUFFER]]
+// CHECK:   ttg.async_copy_global_to_local
+// CHECK:   ttg.async_commit_group
+// CHECK:   scf.yield
+// CHECK: ttg.async_wait {num = 0 : i32}
+// CHECK: ttg.local_dealloc %[[ABUFFER]]
+
+// AMD-LABEL: tt.func @outer_loop_prefetch
+// AMD_PREFETCH-LABEL: tt.func @outer_loop_prefetch
+tt.func @outer_loop_prefetch(%lb : i32, %ub : i32, %step : i32,
+                             %A : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                             %B : !tt.ptr<f16> {tt.divisibility = 16 : i32}) -> tensor<128x128xf32, #C>{
+  %c32_i32 = arith.constant 32 : i32
+  %c_start = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  // A ptrs
+  %a_ptr_splat = tt.splat %A : !tt.ptr<f16> -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_tmp0 = tt.make_range {end = 32: i32, start = 0: i32} : tensor<32xi32, #ALs0>
+  %a_tmp1 = tt.expand_dims %a_tmp0 {axis = 0 : i32} : tensor<32xi32, #ALs0> -> tensor<1x32xi32, #AL>
+  %a_offs = tt.broadcast %a_tmp1 : tensor<1x32xi32, #AL> -> tensor<128x32xi32, #AL>
+  %a_ptr_init = tt.addptr %a_ptr_splat, %a_offs : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  // B ptrs
+  %b_ptr_splat = tt.splat %B : !tt.ptr<f16> -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %b_tmp0 = tt.make_range {end = 128: i32, start = 0: i32} : tensor<128xi32, #BLs0>
+  %b_tmp1 = tt.expand_dims %b_tmp0 {axis = 0 : i32} : tensor<128xi32, #BLs0> -> tensor<1x128xi32, #BL>
+  %b_offs = tt.broadcast %b_tmp1 : tensor<1x128xi32, #BL> -> tensor<32x128xi32, #BL>
+  %b_ptr = tt.addptr %b_ptr_splat, %b_offs : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+
+  %loop1 = scf.for %iv0 = %lb to %ub step %step iter_args(%c_init = %c_start) -> (tensor<128x128xf32, #C>) : i32 {
+    %a_off_scalar = arith.muli %iv0, %c32_i32 : i32
+    %a_off = tt.splat %a_off_scalar : i32 -> tensor<128x32xi32, #AL>
+    %a_ptr = tt.addptr %a_ptr_init, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %a_ = tt.load %a_ptr : tensor<128x32x!tt.ptr<f16>, #AL>
+    %a = ttg.convert_layout %a_ : tensor<128x32xf16, #AL> -> tensor<128x32xf16, #A>
+
+    %loop2 = scf.for %iv = %lb to %ub step %step iter_args(%prev_c = %c_init) -> (tensor<128x128xf32, #C>) : i32 {
+      %b_ = tt.load %b_ptr : tensor<32x128x!tt.ptr<f16>, #BL>
+      %b = ttg.convert_layout %b_ : tensor<32x128xf16, #BL> -> tensor<32x128xf16, #B>
+      %c = tt.dot %a, %b, %prev_c : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+      scf.yield %c : tensor<128x128xf32, #C>
+    } {tt.num_stages = 1 : i32}
+
+    scf.yield %loop2 : tensor<128x128xf32, #C>
+  } {tt.num_stages = 3 : i32}
+  tt.return %loop1 : tensor<128x128xf32, #C>
+}
+
+// Persistent-kernel style: both the outer and the nested loop are pipelined.
+// The nested loop is expanded first, so its prologue and epilogue are placed
+// in the outer body and take the stage of the nested loop, which has to be
+// the last one. Only the A tiles of the outer loop are prefetched ahead of it.
+// The A pointer is yielded two outer iterations after it is computed.
+// CHECK-LABEL: tt.func @persistent_nested_pipeline
+// CHECK: %[[ABUFFER:.*]] = ttg.local_alloc
+// CHECK: ttg.async_copy_global_to_local
+// CHECK: ttg.async_copy_global_to_local
+// CHECK-NOT: ttg.async_copy_global_to_local
+// CHECK: scf.for
+// CHECK-DAG: ttg.async_wait
+// CHECK-DAG: %[[A:.*]] = ttg.memdesc_subview %[[ABUFFER]]
+// CHECK:   ttg.local_load %[[A]]
+// CHECK:   %[[BBUFFER:.*]] = ttg.local_alloc
+// CHECK:   ttg.async_copy_global_to_local
+// CHECK:   ttg.async_copy_global_to_local
+// CHECK:   scf.for
+// CHECK:     ttg.async_wait
+// CHECK:     ttg.memdesc_subview %[[BBUFFER]]
+// CHECK:     ttg.local_load
+// CHECK:     tt.dot
+// CHECK:     ttg.async_copy_global_to_local
+// CHECK:     scf.yield
+// CHECK:   ttg.async_wait {num = 0 : i32}
+// CHECK:   ttg.local_dealloc %[[BBUFFER]]
+// CHECK:   ttg.memdesc_subview %[[ABUFFER]]
+// CHECK:   ttg.async_copy_global_to_local
+// CHECK:   scf.yield
+// CHECK: ttg.async_wait {num = 0 : i32}
+// CHECK: ttg.local_dealloc %[[ABUFFER]]
+
+// AMD-LABEL: tt.func @persistent_nested_pipeline
+// AMD_PREFETCH-LABEL: tt.func @persistent_nested_pipeline
+tt.func @persistent_nested_pipeline(%lb : i32, %ub : i32, %step : i32,
+                                    %A : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                                    %B : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                                    %Out : !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %c32_i32 = arith.constant 32 : i32
+  %c_start = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %a_step = arith.constant dense<32> : tensor<128x32xi32, #AL>
+  %b_step = arith.constant dense<4096> : tensor<32x128xi32, #BL>
+  // A ptrs
+  %a_ptr_splat = tt.splat %A : !tt.ptr<f16> -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_tmp0 = tt.make_range {end = 32: i32, start = 0: i32} : tensor<32xi32, #ALs0>
+  %a_tmp1 = tt.expand_dims %a_tmp0 {axis = 0 : i32} : tensor<32xi32, #ALs0> -> tensor<1x32xi32, #AL>
+  %a_offs = tt.broadcast %a_tmp1 : tensor<1x32xi32, #AL> -> tensor<128x32xi32, #AL>
+  %a_ptr_init = tt.addptr %a_ptr_splat, %a_offs : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  %a_ptr_next = tt.addptr %a_ptr_init, %a_step : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  // B ptrs
+  %b_ptr_splat = tt.splat %B : !tt.ptr<f16> -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %b_tmp0 = tt.make_range {end = 128: i32, start = 0: i32} : tensor<128xi32, #BLs0>
+  %b_tmp1 = tt.expand_dims %b_tmp0 {axis = 0 : i32} : tensor<128xi32, #BLs0> -> tensor<1x128xi32, #BL>
+  %b_offs = tt.broadcast %b_tmp1 : tensor<1x128xi32, #BL> -> tensor<32x128xi32, #BL>
+  %b_ptr_init = tt.addptr %b_ptr_splat, %b_offs : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+  // Out ptrs
+  %out_ptr_init = tt.splat %Out : !tt.ptr<f32> -> tensor<128x128x!tt.ptr<f32>, #C>
+
+  %loop1:2 = scf.for %iv0 = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %a_ptr_1 = %a_ptr_next) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32x!tt.ptr<f16>, #AL>) : i32 {
+    %a_ = tt.load %a_ptr : tensor<128x32x!tt.ptr<f16>, #AL>
+    %a = ttg.convert_layout %a_ : tensor<128x32xf16, #AL> -> tensor<128x32xf16, #A>
+
+    %loop2:2 = scf.for %iv = %lb to %ub step %step iter_args(%prev_c = %c_start, %b_ptr = %b_ptr_init) -> (tensor<128x128xf32, #C>, tensor<32x128x!tt.ptr<f16>, #BL>) : i32 {
+      %b_ = tt.load %b_ptr : tensor<32x128x!tt.ptr<f16>, #BL>
+      %b = ttg.convert_layout %b_ : tensor<32x128xf16, #BL> -> tensor<32x128xf16, #B>
+      %c = tt.dot %a, %b, %prev_c : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+      %next_b_ptr = tt.addptr %b_ptr, %b_step : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+      scf.yield %c, %next_b_ptr : tensor<128x128xf32, #C>, tensor<32x128x!tt.ptr<f16>, #BL>
+    } {tt.num_stages = 3 : i32}
+
+    %out_off_scalar = arith.muli %iv0, %c32_i32 : i32
+    %out_off = tt.splat %out_off_scalar : i32 -> tensor<128x128xi32, #C>
+    %out_ptr = tt.addptr %out_ptr_init, %out_off : tensor<128x128x!tt.ptr<f32>, #C>, tensor<128x128xi32, #C>
+    tt.store %out_ptr, %loop2#0 : tensor<128x128x!tt.ptr<f32>, #C>
+    %a_ptr_2 = tt.addptr %a_ptr_1, %a_step : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    scf.yield %a_ptr_1, %a_ptr_2 : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32x!tt.ptr<f16>, #AL>
+  } {tt.num_stages = 3 : i32}
+  tt.return
+}
+
+// The offset of the outer load comes from the nested loop, which would have
+// to run in the first stage. The outer loop is left alone, and the copy that
+// split its loop-carried pointer is folded back into the yield.
+// CHECK-LABEL: tt.func @nested_loop_feeds_outer_load
+// CHECK-NOT: ttg.async_copy_global_to_local
+// CHECK: scf.for %{{.*}} iter_args(%{{.*}} = %{{.*}}, %[[NEXT:.*]] = %{{.*}})
+// CHECK:   scf.for
+// CHECK:   tt.load
+// CHECK:   tt.store
+// CHECK:   scf.yield %[[NEXT]], %{{.*}} :
+
+// AMD-LABEL: tt.func @nested_loop_feeds_outer_load
+// AMD_PREFETCH-LABEL: tt.func @nested_loop_feeds_outer_load
+tt.func @nested_loop_feeds_outer_load(%lb : i32, %ub : i32, %step : i32,
+                                      %A : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                                      %Out : !tt.ptr<f16> {tt.divisibility = 16 : i32}) {
+  %c0_i32 = arith.constant 0 : i32
+  %c32_i32 = arith.constant 32 : i32
+  %a_step = arith.constant dense<32> : tensor<128x32xi32, #AL>
+  %a_ptr_splat = tt.splat %A : !tt.ptr<f16> -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_tmp0 = tt.make_range {end = 32: i32, start = 0: i32} : tensor<32xi32, #ALs0>
+  %a_tmp1 = tt.expand_dims %a_tmp0 {axis = 0 : i32} : tensor<32xi32, #ALs0> -> tensor<1x32xi32, #AL>
+  %a_offs = tt.broadcast %a_tmp1 : tensor<1x32xi32, #AL> -> tensor<128x32xi32, #AL>
+  %a_ptr_init = tt.addptr %a_ptr_splat, %a_offs : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  %a_ptr_next = tt.addptr %a_ptr_init, %a_step : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  %out_ptr_splat = tt.splat %Out : !tt.ptr<f16> -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %out_ptr = tt.addptr %out_ptr_splat, %a_offs : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+
+  %loop1:2 = scf.for %iv0 = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %a_ptr_1 = %a_ptr_next) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32x!tt.ptr<f16>, #AL>) : i32 {
+    %sum = scf.for %iv = %lb to %ub step %step iter_args(%prev = %c0_i32) -> (i32) : i32 {
+      %next = arith.addi %prev, %iv : i32
+      scf.yield %next : i32
+    }
+    %off_scalar = arith.muli %sum, %c32_i32 : i32
+    %off = tt.splat %off_scalar : i32 -> tensor<128x32xi32, #AL>
+    %a_ptr_off = tt.addptr %a_ptr, %off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %a = tt.load %a_ptr_off : tensor<128x32x!tt.ptr<f16>, #AL>
+    tt.store %out_ptr, %a : tensor<128x32x!tt.ptr<f16>, #AL>
+    %a_ptr_2 = tt.addptr %a_ptr_1, %a_step : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    scf.yield %a_ptr_1, %a_ptr_2 : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32x!tt.ptr<f16>, #AL>
+  } {tt.num_stages = 3 : i32}
+  tt.return
+}
+
 // CHECK-LABEL: tt.func @matmul_loop_single_pipeline
 // CHECK-DAG: %[[CONSTANT_NEG1:.*]] = arith.constant -1 : i32
 // CHECK-DAG: %[[CONSTANT_0:.*]] = arith.constant 0 : i32
@@ -706,11 +892,21 @@ tt.func @post_load_inv(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32},
   tt.return %85#0 : tensor<32x32xf32, #C>
 }
 
+// The pointers are yielded two iterations after they are computed. The
+// dependency is split into two steps of one, so the loads are pipelined.
 // COMMON-LABEL: tt.func @cross_iter_dep
-// TODO: enable pipelining with distance of 2
-// COMMON-NOT: ttg.async_commit_group
-// COMMON: scf.for
-// COMMON: scf.yield
+// CHECK-COUNT-4: ttg.async_copy_global_to_local
+// CHECK: scf.for
+// CHECK:   ttg.async_wait
+// CHECK:   tt.dot
+// CHECK-COUNT-2: ttg.async_copy_global_to_local
+// CHECK:   scf.yield
+// AMD-NOT: ttg.async_commit_group
+// AMD: scf.for
+// AMD: scf.yield
+// AMD_PREFETCH-NOT: ttg.async_commit_group
+// AMD_PREFETCH: scf.for
+// AMD_PREFETCH: scf.yield
 
 tt.func @cross_iter_dep(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32},
                         %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32},
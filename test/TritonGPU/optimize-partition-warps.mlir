@@ -117,6 +117,32 @@ tt.func @fits_after_shrink(%arg0: i32) {
   tt.return
 }
 
+// The largest tensor needs 32 registers per thread, but four of them are live
+// at once, so unlike @medium_tensor_computation it doesn't fit in 4 warps.
+// CHECK-LABEL: @register_pressure_keeps_warps
+tt.func @register_pressure_keeps_warps(%arg0: i32) {
+  %alloc = ttg.local_alloc : () -> !ttg.memdesc<128x64xf16, #shared, #smem, mutable>
+  ttg.warp_specialize(%arg0, %alloc)
+  default {
+    ttg.warp_yield
+  }
+  // CHECK: partition0({{.*}}) num_warps(8)
+  partition0(%arg1: i32, %arg2: !ttg.memdesc<128x64xf16, #shared, #smem, mutable>) num_warps(8) {
+    %0 = ttg.local_load %arg2 : !ttg.memdesc<128x64xf16, #shared, #smem, mutable> -> tensor<128x64xf16, #blocked2d_8>
+    %1 = arith.extf %0 : tensor<128x64xf16, #blocked2d_8> to tensor<128x64xf32, #blocked2d_8>
+    %2 = arith.addf %1, %1 : tensor<128x64xf32, #blocked2d_8>
+    %3 = arith.mulf %1, %1 : tensor<128x64xf32, #blocked2d_8>
+    %4 = arith.subf %1, %1 : tensor<128x64xf32, #blocked2d_8>
+    %5 = arith.addf %2, %3 : tensor<128x64xf32, #blocked2d_8>
+    %6 = arith.addf %5, %4 : tensor<128x64xf32, #blocked2d_8>
+    %7 = arith.addf %6, %1 : tensor<128x64xf32, #blocked2d_8>
+    %8 = arith.truncf %7 : tensor<128x64xf32, #blocked2d_8> to tensor<128x64xf16, #blocked2d_8>
+    ttg.local_store %8, %arg2 : tensor<128x64xf16, #blocked2d_8> -> !ttg.memdesc<128x64xf16, #shared, #smem, mutable>
+    ttg.warp_return
+  } : (i32, !ttg.memdesc<128x64xf16, #shared, #smem, mutable>) -> ()
+  tt.return
+}
+
 // CHECK-LABEL: @register_use_heuristic
 tt.func @register_use_heuristic() {
   // CHECK: requestedRegisters = array<i32: 24, 88>
@@ -0,0 +1,49 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-schedule-loops=modulo-schedule=true | FileCheck %s
+
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// Each load takes longer to stream in than its latency, so prefetching it one
+// iteration ahead hides the latency and the third stage is dropped.
+module attributes {"ttg.num-warps" = 4 : i32, "ttg.num-ctas" = 1 : i32, "ttg.target" = "cuda:80"} {
+// CHECK-LABEL: @bandwidth_bound
+tt.func @bandwidth_bound(%lb : index, %ub : index, %step : index,
+                         %a_ptr : tensor<128x128x!tt.ptr<f32>, #blocked>,
+                         %b_ptr : tensor<128x128x!tt.ptr<f32>, #blocked>) -> tensor<128x128xf32, #blocked> {
+  %init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #blocked>
+  %loop = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init) -> (tensor<128x128xf32, #blocked>) {
+    // CHECK: tt.load {{.*}} {loop.cluster = 0 : i32, loop.stage = 0 : i32}
+    %a = tt.load %a_ptr {tt.latency = 2 : i32} : tensor<128x128x!tt.ptr<f32>, #blocked>
+    // CHECK: tt.load {{.*}} {loop.cluster = 2 : i32, loop.stage = 0 : i32}
+    %b = tt.load %b_ptr {tt.latency = 2 : i32} : tensor<128x128x!tt.ptr<f32>, #blocked>
+    // CHECK: arith.addf {{.*}} {loop.cluster = 0 : i32, loop.stage = 1 : i32}
+    %acc_a = arith.addf %acc, %a : tensor<128x128xf32, #blocked>
+    // CHECK: arith.addf {{.*}} {loop.cluster = 1 : i32, loop.stage = 1 : i32}
+    %res = arith.addf %acc_a, %b : tensor<128x128xf32, #blocked>
+    scf.yield %res : tensor<128x128xf32, #blocked>
+  }
+  // CHECK: tt.scheduled_max_stage = 1 : i32
+  tt.return %loop : tensor<128x128xf32, #blocked>
+}
+}
+
+// -----
+
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// A small load is latency bound and keeps all the stages it was given.
+module attributes {"ttg.num-warps" = 4 : i32, "ttg.num-ctas" = 1 : i32} {
+// CHECK-LABEL: @latency_bound
+tt.func @latency_bound(%lb : index, %ub : index, %step : index,
+                       %a_ptr : tensor<32x32x!tt.ptr<f16>, #blocked>) -> tensor<32x32xf16, #blocked> {
+  %init = arith.constant dense<0.00e+00> : tensor<32x32xf16, #blocked>
+  %loop = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init) -> (tensor<32x32xf16, #blocked>) {
+    // CHECK: tt.load {{.*}} {loop.cluster = 0 : i32, loop.stage = 0 : i32}
+    %a = tt.load %a_ptr {tt.latency = 2 : i32} : tensor<32x32x!tt.ptr<f16>, #blocked>
+    // CHECK: arith.addf {{.*}} {loop.cluster = 1 : i32, loop.stage = 2 : i32}
+    %res = arith.addf %acc, %a : tensor<32x32xf16, #blocked>
+    scf.yield %res : tensor<32x32xf16, #blocked>
+  }
+  // CHECK: tt.scheduled_max_stage = 2 : i32
+  tt.return %loop : tensor<32x32xf16, #blocked>
+}
+}
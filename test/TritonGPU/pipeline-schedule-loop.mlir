@@ -1,4 +1,5 @@
 // RUN: triton-opt %s -allow-unregistered-dialect -split-input-file -tritongpu-schedule-loops -canonicalize | FileCheck %s
+// RUN: triton-opt %s -allow-unregistered-dialect -split-input-file -tritongpu-schedule-loops | FileCheck %s --check-prefix=BAILOUT
 
 #AL = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
 #BL = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
@@ -350,6 +351,46 @@ tt.func @gpu_barrier(%lb : index, %ub : index, %step : index,
   }
   tt.return %loop#0 : tensor<128x32xf16, #A>
 }
+
+// Loop-carried distances are only split in loops that get a schedule.
+// BAILOUT-LABEL: @gpu_barrier_long_distance
+tt.func @gpu_barrier_long_distance(%lb : index, %ub : index, %step : index,
+                 %a_ptr_init : tensor<128x32x!tt.ptr<f16>, #A>) -> tensor<128x32xf16, #A> {
+  %init = arith.constant dense<0.00e+00> : tensor<128x32xf16, #A>
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init, %prev = %init) -> (tensor<128x32xf16, #A>, tensor<128x32xf16, #A>) {
+    // BAILOUT-NOT: unrealized_conversion_cast
+    // BAILOUT-NOT: loop.cluster
+    %a = tt.load %a_ptr_init {tt.latency = 2 : i32} : tensor<128x32x!tt.ptr<f16>, #A>
+    %res = arith.addf %prev, %a : tensor<128x32xf16, #A>
+    gpu.barrier
+    // BAILOUT: scf.yield %{{.*}}, %arg{{[0-9]+}} :
+    scf.yield %res, %acc : tensor<128x32xf16, #A>, tensor<128x32xf16, #A>
+  }
+  tt.return %loop#0 : tensor<128x32xf16, #A>
+}
+
+// The nested loop computes the address of the load, so it lands in the first
+// stage and the outer loop is not pipelined. The copy splitting the distance
+// of %acc is removed again.
+// BAILOUT-LABEL: @nested_loop_not_in_last_stage
+tt.func @nested_loop_not_in_last_stage(%lb : index, %ub : index, %step : index,
+                 %a_ptr_init : tensor<128x32x!tt.ptr<f16>, #A>) -> tensor<128x32xf16, #A> {
+  %init = arith.constant dense<0.00e+00> : tensor<128x32xf16, #A>
+  %one = arith.constant dense<1> : tensor<128x32xi32, #A>
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init, %prev = %init) -> (tensor<128x32xf16, #A>, tensor<128x32xf16, #A>) {
+    // BAILOUT-NOT: unrealized_conversion_cast
+    // BAILOUT-NOT: loop.cluster
+    %a_ptr = scf.for %jv = %lb to %ub step %step iter_args(%ptr = %a_ptr_init) -> (tensor<128x32x!tt.ptr<f16>, #A>) {
+      %next = tt.addptr %ptr, %one : tensor<128x32x!tt.ptr<f16>, #A>, tensor<128x32xi32, #A>
+      scf.yield %next : tensor<128x32x!tt.ptr<f16>, #A>
+    }
+    %a = tt.load %a_ptr {tt.latency = 2 : i32} : tensor<128x32x!tt.ptr<f16>, #A>
+    %res = arith.addf %prev, %a : tensor<128x32xf16, #A>
+    // BAILOUT: scf.yield %{{.*}}, %arg{{[0-9]+}} :
+    scf.yield %res, %acc : tensor<128x32xf16, #A>, tensor<128x32xf16, #A>
+  }
+  tt.return %loop#0 : tensor<128x32xf16, #A>
+}
 }
 
 // -----
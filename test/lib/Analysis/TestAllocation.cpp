@@ -29,9 +29,10 @@ struct TestAllocationPass
   ModuleAllocation getModuleAllocation() {
     switch (getScratchSizeFunction) {
     case GetScratchSizeFunction::None:
-      return {getOperation()};
+      return {getOperation(), triton::defaultAllocationAnalysisScratchSizeFn,
+              allocationPolicy};
     case GetScratchSizeFunction::ValidConstant:
-      return {getOperation(), getScratchSize128};
+      return {getOperation(), getScratchSize128, allocationPolicy};
     }
     llvm_unreachable("Unhandled case");
   }
@@ -68,6 +69,9 @@ struct TestAllocationPass
       });
       mlir::emitRemark(funcOp.getLoc())
           << "size = " << allocation->getSharedMemorySize();
+      if (allocationPolicy == triton::AllocationPolicy::BestFit)
+        mlir::emitRemark(funcOp.getLoc())
+            << "saved = " << allocation->getSharedMemorySizeSaved();
     });
   }
 
@@ -79,6 +83,14 @@ struct TestAllocationPass
           clEnumValN(GetScratchSizeFunction::None, "None", "None (default)"),
           clEnumValN(GetScratchSizeFunction::ValidConstant, "ValidConstant",
                      "ValidConstant"))};
+  Option<triton::AllocationPolicy> allocationPolicy{
+      *this, "allocation-policy",
+      llvm::cl::desc("Shared memory allocation policy to use"),
+      llvm::cl::init(triton::AllocationPolicy::GraphColoring),
+      llvm::cl::values(clEnumValN(triton::AllocationPolicy::GraphColoring,
+                                  "GraphColoring", "GraphColoring (default)"),
+                       clEnumValN(triton::AllocationPolicy::BestFit, "BestFit",
+                                  "BestFit"))};
 };
 
 } // namespace
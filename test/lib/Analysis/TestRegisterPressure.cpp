@@ -0,0 +1,42 @@
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+using namespace mlir;
+
+namespace {
+
+struct TestRegisterPressurePass
+    : public PassWrapper<TestRegisterPressurePass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestRegisterPressurePass);
+
+  StringRef getArgument() const final { return "test-print-register-pressure"; }
+  StringRef getDescription() const final {
+    return "print the peak register pressure of functions and loops";
+  }
+
+  void runOnOperation() override {
+    ModuleOp moduleOp = getOperation();
+    triton::RegisterPressureAnalysis analysis(moduleOp);
+    moduleOp.walk([&](triton::FuncOp funcOp) {
+      mlir::emitRemark(funcOp.getLoc())
+          << "peak = " << analysis.getMaxPressure(funcOp.getBody());
+      funcOp.walk([&](scf::ForOp forOp) {
+        mlir::emitRemark(forOp.getLoc())
+            << "loop peak = " << analysis.getMaxPressure(forOp.getBodyRegion());
+      });
+    });
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestRegisterPressurePass() {
+  PassRegistration<TestRegisterPressurePass>();
+}
+} // namespace test
+} // namespace mlir
@@ -1,6 +1,7 @@
 from triton.backends.compiler import BaseBackend, GPUTarget, Language
 from triton._C.libtriton import ir, passes, llvm, amd
 from triton import knobs
+from triton.runtime.cache import cached_codegen
 from dataclasses import dataclass
 from typing import Any, Dict, Tuple
 from types import ModuleType
@@ -384,14 +385,19 @@ class HIPBackend(BaseBackend):
         # Disable inlining of print related functions,
         # because inlining of these function could slow down compilation significantly
         amd.disable_print_inline(llvm_mod)
-        return str(llvm_mod)
+        # The module is handed to make_amdgcn as is. It keeps its context alive
+        # and is only printed when it gets cached or dumped.
+        return llvm_mod
 
     @staticmethod
     def make_amdgcn(src, metadata, options):
         # Find kernel names (there should only be one)
         # We get the name at the last possible step to accommodate `triton.compile`
         # on user-provided LLVM
-        names = re.findall(r"define amdgpu_kernel void @([a-zA-Z_][a-zA-Z0-9_]*)", src)
+        if isinstance(src, str):
+            names = re.findall(r"define amdgpu_kernel void @([a-zA-Z_][a-zA-Z0-9_]*)", src)
+        else:
+            names = [fn.name for fn in src.get_functions() if not fn.is_declaration() and fn.is_external_linkage()]
         assert len(names) == 1
         metadata["name"] = names[0]
         # llvm -> hsaco
@@ -402,7 +408,13 @@ class HIPBackend(BaseBackend):
         # the regression is not significant. It would be better to have some heuristics.
         if options.schedule_hint == 'attention':
             flags.append('sink-insts-to-avoid-spills')
-        amdgcn = llvm.translate_to_asm(src, amd.TARGET_TRIPLE, options.arch, '', flags, options.enable_fp_fusion, False)
+
+        def translate():
+            return llvm.translate_to_asm(src, amd.TARGET_TRIPLE, options.arch, '', flags, options.enable_fp_fusion,
+                                         False)
+
+        inputs = [src, amd.TARGET_TRIPLE, options.arch, flags, options.enable_fp_fusion]
+        amdgcn = cached_codegen("amdgcn", inputs, translate)
         if knobs.amd.dump_amdgcn:
             print("// -----// AMDGCN Dump //----- //")
             print(amdgcn)
@@ -413,15 +425,18 @@ class HIPBackend(BaseBackend):
         target_features = ''
         if knobs.compilation.enable_asan:
             target_features = '+xnack'
-        hsaco = amd.assemble_amdgcn(src, options.arch, target_features)
-        with tempfile.NamedTemporaryFile() as tmp_out:
-            with tempfile.NamedTemporaryFile() as tmp_in:
-                with open(tmp_in.name, "wb") as fd_in:
-                    fd_in.write(hsaco)
-                amd.link_hsaco(tmp_in.name, tmp_out.name)
-            with open(tmp_out.name, "rb") as fd_out:
-                ret = fd_out.read()
-        return ret
+
+        def assemble():
+            hsaco = amd.assemble_amdgcn(src, options.arch, target_features)
+            with tempfile.NamedTemporaryFile() as tmp_out:
+                with tempfile.NamedTemporaryFile() as tmp_in:
+                    with open(tmp_in.name, "wb") as fd_in:
+                        fd_in.write(hsaco)
+                    amd.link_hsaco(tmp_in.name, tmp_out.name)
+                with open(tmp_out.name, "rb") as fd_out:
+                    return fd_out.read()
+
+        return cached_codegen("hsaco", [src, options.arch, target_features], assemble, binary=True)
 
     def add_stages(self, stages, options, language):
         if language == Language.TRITON:
@@ -5,13 +5,6 @@
 
 namespace mlir::triton::AMD {
 
-constexpr int globalPtrBitWidth = 64;
-
-static unsigned getBitwidth(RankedTensorType ty) {
-  auto isPtr = isa<PointerType>(ty.getElementType());
-  return isPtr ? globalPtrBitWidth : std::max(ty.getElementTypeBitWidth(), 8u);
-}
-
 unsigned getConvertLayoutScratchInBytes(RankedTensorType srcTy,
                                         RankedTensorType dstTy,
                                         bool usePadding) {
@@ -26,7 +19,7 @@ unsigned getConvertLayoutScratchInBytes(RankedTensorType srcTy,
                     "AMD backend yet");
     // TODO use swizzling
   }
-  return elems * getBitwidth(srcTy) / 8;
+  return elems * getConvertLayoutBitwidth(srcTy) / 8;
 }
 
 unsigned AMDAllocationAnalysisScratchSizeFn(Operation *op) {
@@ -156,6 +156,12 @@ Value TargetInfo::programId(RewriterBase &rewriter, Location loc,
   return LLVM::AMD::llGetPid(loc, rewriter, moduleOp, axis);
 }
 
+Value TargetInfo::getCycleCounter(RewriterBase &rewriter, Location loc) const {
+  return LLVM::createLLVMIntrinsicCallOp(rewriter, loc, "llvm.amdgcn.s.memtime",
+                                         i64_ty, {})
+      .getResult(0);
+}
+
 // Cast and sext values into specific-length int to meet the requirements of
 // instructions like UpdateDpp or readlane if necessary.
 static inline Type castToAndSExtInt(RewriterBase &rewriter, Location loc,
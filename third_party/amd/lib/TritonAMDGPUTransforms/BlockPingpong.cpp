@@ -8,7 +8,9 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "third_party/amd/include/Dialect/TritonAMDGPU/IR/Dialect.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/ModuloSchedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 #include "llvm/ADT/TypeSwitch.h"
 
@@ -882,6 +884,31 @@ void Pingponger::getDotPingponged() {
   intShape.push_back(mfmaEncoding.getMDim());
   intShape.push_back(mfmaEncoding.getNDim());
 
+  // Two warps share each SIMD, so each of them only gets half of the register
+  // file. The dot cluster holds the accumulator and one slice of the A and B
+  // operands, as the dot is sliced along K into one slice per cluster.
+  // This is deliberately not the pressure of the whole loop from
+  // RegisterPressureAnalysis. The pass runs before pointer canonicalization,
+  // so it would count each pointer as 64 bits rather than a 32-bit offset.
+  // Tensors live across the loop, e.g. the epilogue operands of a persistent
+  // kernel, take the same registers with or without pingpong. Counting both
+  // rejects the 256x256x64 tiles that the four-cluster schedule is built for.
+  auto dotFitsInRegisters = [&](int numSlices) {
+    auto model =
+        ttg::PipelineTargetModel::get(forOp->getParentOfType<ModuleOp>());
+    unsigned operandRegs =
+        tt::getNumI32RegsPerThread(aType) +
+        tt::getNumI32RegsPerThread(dotOps[0].getB().getType());
+    unsigned regs = tt::getNumI32RegsPerThread(dotType) +
+                    llvm::divideCeil(operandRegs, numSlices);
+    unsigned regsPerWarp = model.getDesc().registersPerThread / 2;
+    if (regs <= regsPerWarp)
+      return true;
+    LDBG("Dot cluster needs " << regs << " registers per thread with "
+                              << numSlices << " slices, skip pingpong");
+    return false;
+  };
+
   if (dotOps.size() == 1 && useAsyncCopy) {
     if (numWarps != 8) {
       LDBG("Currently only support num_warp=8 for async PP");
@@ -997,7 +1024,8 @@ void Pingponger::getDotPingponged() {
     // times for issuing the memory operations and issuing dot operations,
     // smaller tile sizes are not likely to get any advantage from current dot
     // centric pingpong scheduling.
-    if (tileSize <= smallTile && tileSize >= minTile)
+    if (tileSize <= smallTile && tileSize >= minTile &&
+        dotFitsInRegisters(/*numSlices=*/1))
       transformOnePPClusters(builder, loc);
     // numWarps=4 doesn't need asymmetric sync, return.
     return;
@@ -1012,6 +1040,8 @@ void Pingponger::getDotPingponged() {
     }
     // Transform a loop where the tile size requires dots to be sliced
     if (tileSize == mediumTile) {
+      if (!dotFitsInRegisters(/*numSlices=*/2))
+        return;
       if (transformTwoPPClusters(builder, dotOps[0]->getLoc()).failed()) {
         LDBG("Encountered failure when trying to execute the two ping pong "
              "cluster transformation");
@@ -1023,6 +1053,8 @@ void Pingponger::getDotPingponged() {
         LDBG("Reached known register spilling case, skip pingpong scheduling");
         return;
       }
+      if (!dotFitsInRegisters(/*numSlices=*/4))
+        return;
       if (transformFourPPClusters(builder, dotOps[0]->getLoc()).failed()) {
         LDBG("Encountered failure when trying to execute the four ping pong "
              "cluster transformation");
@@ -169,7 +169,8 @@ public:
     // Precompute the contiguity of all AsyncCopy ops based on the src and
     // mask contiguity/alignment to avoid rebuilding ModuleAxisInfoAnalysis
     // after every IR change.
-    AMD::ModuleAxisInfoAnalysis axisAnalysis(m);
+    AMD::ModuleAxisInfoAnalysis &axisAnalysis =
+        getAnalysis<AMD::ModuleAxisInfoAnalysis>();
     DenseMap<ttg::AsyncCopyGlobalToLocalOp, unsigned> asyncCopyContiguity;
     m->walk([&](ttg::AsyncCopyGlobalToLocalOp copyOp) {
       unsigned contiguity =
@@ -9,10 +9,10 @@
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "third_party/amd/include/Analysis/AxisInfoExt.h"
-#include "third_party/amd/include/Analysis/RangeAnalysis.h"
 #include "third_party/amd/include/Dialect/TritonAMDGPU/IR/Dialect.h"
 #include "third_party/amd/lib/TritonAMDGPUToLLVM/Utility.h"
 #include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RangeAnalysis.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
@@ -88,7 +88,7 @@ bool verifyNonNegativeExpr(
             solver->lookupState<dataflow::IntegerValueRangeLattice>(v)) {
       if (r->getValue().isUninitialized())
         return false;
-      if (AMD::isEmptyInitializedRange(r->getValue().getValue()))
+      if (tt::isEmptyInitializedRange(r->getValue().getValue()))
         return false;
     }
     return succeeded(dataflow::staticallyNonNegative(*solver, v));
@@ -621,15 +621,16 @@ public:
 
     // Collect assumptions in the function
     DenseMap<Value, SetVector<Operation *>> assumptions =
-        AMD::TritonIntegerRangeAnalysis::collectAssumptions(getOperation());
+        tt::TritonIntegerRangeAnalysis::collectAssumptions(getOperation());
     std::shared_ptr<DataFlowSolver> solver = createDataFlowSolver();
-    AMD::TritonIntegerRangeAnalysis *rangeAnalysis =
-        solver->load<AMD::TritonIntegerRangeAnalysis>(assumptions);
-    AMD::initializeFuncOps(mod, rangeAnalysis);
+    tt::TritonIntegerRangeAnalysis *rangeAnalysis =
+        solver->load<tt::TritonIntegerRangeAnalysis>(assumptions);
+    tt::initializeFuncOps(mod, rangeAnalysis);
     if (failed(solver->initializeAndRun(getOperation())))
       return signalPassFailure();
 
-    AMD::ModuleAxisInfoAnalysis axisInfoAnalysis(mod);
+    AMD::ModuleAxisInfoAnalysis &axisInfoAnalysis =
+        getAnalysis<AMD::ModuleAxisInfoAnalysis>();
     patterns.add<ConvertTritonLoadToBufferLoad<tt::LoadOp>,
                  ConvertTritonLoadToBufferLoad<ttg::AsyncCopyGlobalToLocalOp>,
                  ConvertTritonStoreToBufferStore>(context, assumptions, solver);
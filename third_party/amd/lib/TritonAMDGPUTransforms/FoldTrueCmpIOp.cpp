@@ -1,6 +1,6 @@
 #include "TritonAMDGPUTransforms/Passes.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
-#include "third_party/amd/include/Analysis/RangeAnalysis.h"
+#include "triton/Analysis/RangeAnalysis.h"
 #include "triton/Analysis/Utility.h"
 
 using namespace mlir::triton;
@@ -15,17 +15,17 @@ struct TritonAMDFoldTrueCmpIOpPass
 
   void runOnOperation() override {
     DenseMap<Value, SetVector<Operation *>> assumptions =
-        AMD::TritonIntegerRangeAnalysis::collectAssumptions(getOperation());
+        TritonIntegerRangeAnalysis::collectAssumptions(getOperation());
     ModuleOp mod = getOperation();
     std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
-    AMD::TritonIntegerRangeAnalysis *rangeAnalysis =
-        solver->load<AMD::TritonIntegerRangeAnalysis>(assumptions);
-    AMD::initializeFuncOps(mod, rangeAnalysis);
+    TritonIntegerRangeAnalysis *rangeAnalysis =
+        solver->load<TritonIntegerRangeAnalysis>(assumptions);
+    initializeFuncOps(mod, rangeAnalysis);
     if (failed(solver->initializeAndRun(getOperation())))
       return signalPassFailure();
 
     RewritePatternSet patterns(&getContext());
-    AMD::populateFoldTrueCmpIOpPatterns(patterns, solver.get());
+    populateFoldTrueCmpIOpPatterns(patterns, solver.get());
     (void)applyPatternsGreedily(mod, std::move(patterns));
   }
 };
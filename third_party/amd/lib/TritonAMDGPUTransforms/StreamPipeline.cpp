@@ -2,15 +2,19 @@
 #include "amd/lib/TritonAMDGPUToLLVM/TargetInfo.h"
 #include "third_party/amd/include/Analysis/AxisInfoExt.h"
 #include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Dialect/Triton/IR/OpInterfaces.h"
 #include "triton/Dialect/TritonGPU/IR/Attributes.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/ModuloSchedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/PipelineExpander.h"
 #include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
 #include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
+#include <optional>
 #include <variant>
 
 //===----------------------------------------------------------------------===//
@@ -671,19 +675,134 @@ buildSchedule(scf::ForOp &forOp, int numStages, const LoadToInfoMap &loadToInfo,
   return schedule;
 }
 
-LogicalResult pipelineLoop(scf::ForOp forOp, int numStages, int globalPrefetch,
-                           int localPrefetch, bool useAsyncCopy,
-                           bool waitAtTail) {
-
-  triton::AMD::ModuleAxisInfoAnalysis axisInfoAnalysis(
-      forOp->getParentOfType<ModuleOp>());
+// Choose the number of stages and the prefetch distances from a modulo
+// schedule of the stream ops each load will be split into, using the latency
+// and throughput of the ops on the target. The given number of stages is an
+// upper bound. The stream ops are modeled as stream copies, or as async copies
+// with one more buffer if `useAsyncCopy` is set. `liveRegisters` is the peak
+// register pressure of the loop body.
+LogicalResult chooseStreamStages(scf::ForOp forOp,
+                                 const LoadToInfoMap &loadToInfo,
+                                 unsigned liveRegisters,
+                                 bool useAsyncCopy, int &numStages,
+                                 int &globalPrefetch, int &localPrefetch) {
+  auto model =
+      ttg::PipelineTargetModel::get(forOp->getParentOfType<ModuleOp>());
+  ttg::ModuloScheduler scheduler(model);
+  scheduler.setLiveRegisters(liveRegisters);
+  auto getLatency = [&](unsigned node) {
+    return scheduler.getNode(node).timing.latency;
+  };
 
-  LoadToInfoMap loadToInfo = preprocessLoop(axisInfoAnalysis, forOp, numStages);
+  struct StreamNodes {
+    unsigned globalLoad;
+    std::optional<unsigned> localStore;
+    std::optional<unsigned> localLoad;
+    unsigned compute;
+  };
+  SmallVector<StreamNodes> streams;
+  llvm::MapVector<Operation *, unsigned> computeNodes;
+  for (auto &[loadOp, info] : loadToInfo) {
+    Type loadTy = loadOp->getResultTypes()[0];
+    int64_t bytes = ttg::getNumBytes(loadTy);
+    int numRegs = tt::getNumI32RegsPerThread(loadTy);
+    bool viaSharedMemory = info.sharedEncoding != nullptr;
+
+    StreamNodes stream;
+    ttg::ModuloScheduler::Node globalLoad{loadOp,
+                                          model.getGlobalLoadTiming(bytes)};
+    if (viaSharedMemory && useAsyncCopy) {
+      globalLoad.sharedMemoryBytes = bytes;
+      globalLoad.extraBuffers = 1;
+    } else {
+      globalLoad.numRegs = numRegs;
+    }
+    stream.globalLoad = scheduler.addNode(globalLoad);
+    unsigned producer = stream.globalLoad;
+    if (viaSharedMemory && !useAsyncCopy) {
+      stream.localStore = scheduler.addNode(
+          {nullptr, model.getSharedMemoryTiming(bytes), bytes});
+      scheduler.addEdge(producer, *stream.localStore, getLatency(producer));
+      producer = *stream.localStore;
+    }
+    if (viaSharedMemory) {
+      stream.localLoad = scheduler.addNode(
+          {nullptr, model.getSharedMemoryTiming(bytes), 0, 0, numRegs});
+      // The buffer is handed over to ttg.local_load at a stage boundary.
+      scheduler.addEdge(producer, *stream.localLoad, getLatency(producer),
+                        /*distance=*/0, /*crossStage=*/true);
+      producer = *stream.localLoad;
+    }
+    auto [it, inserted] = computeNodes.try_emplace(info.use, 0);
+    if (inserted)
+      it->second = scheduler.addOp(info.use);
+    stream.compute = it->second;
+    scheduler.addEdge(producer, stream.compute, getLatency(producer));
+    streams.push_back(stream);
+  }
+  // Accumulators are carried to the next iteration.
+  Operation *yieldOp = forOp.getBody()->getTerminator();
+  for (auto [op, node] : computeNodes) {
+    for (Value operand : op->getOperands()) {
+      auto arg = dyn_cast<BlockArgument>(operand);
+      if (arg && arg.getOwner() == forOp.getBody() && arg.getArgNumber() > 0 &&
+          yieldOp->getOperand(arg.getArgNumber() - 1).getDefiningOp() == op)
+        scheduler.addEdge(node, node, getLatency(node), /*distance=*/1);
+    }
+  }
 
-  if (loadToInfo.empty()) {
-    LDBG("couldn't find any pipeline-able loads:\n" << *forOp);
+  FailureOr<ttg::ModuloScheduler::Result> result = scheduler.run(numStages);
+  if (failed(result))
     return failure();
+
+  // All the loads are issued in the first stage, so the stages are counted
+  // from the global load of each stream.
+  int lastStage = 0;
+  int localStoreStage = 0;
+  std::optional<int> localLoadDistance;
+  for (const StreamNodes &stream : streams) {
+    int globalLoadStage = result->getStage(stream.globalLoad);
+    int computeStage = result->getStage(stream.compute);
+    lastStage = std::max(lastStage, computeStage - globalLoadStage);
+    if (stream.localStore) {
+      localStoreStage =
+          std::max(localStoreStage,
+                   result->getStage(*stream.localStore) - globalLoadStage);
+    }
+    if (stream.localLoad) {
+      int distance = computeStage - result->getStage(*stream.localLoad);
+      localLoadDistance = std::min(localLoadDistance.value_or(distance),
+                                   distance);
+    }
   }
+  if (lastStage == 0)
+    return failure();
+
+  numStages = lastStage + 1;
+  globalPrefetch = localStoreStage;
+  localPrefetch =
+      std::min(localLoadDistance.value_or(0), lastStage - localStoreStage);
+  LDBG("Modulo schedule at II " << result->ii << ": num_stages = " << numStages
+                                << ", global_prefetch = " << globalPrefetch
+                                << ", local_prefetch = " << localPrefetch);
+  return success();
+}
+
+// The stages are chosen from a modulo schedule if `liveRegisters`, the peak
+// register pressure of the loop body, is set.
+LogicalResult
+pipelineLoop(scf::ForOp forOp, LoadToInfoMap &loadToInfo, int numStages,
+             int globalPrefetch, int localPrefetch, bool useAsyncCopy,
+             bool waitAtTail, std::optional<unsigned> liveRegisters,
+             triton::AMD::ModuleAxisInfoAnalysis &axisInfoAnalysis) {
+  // Chained loads keep the stages spread by scheduleLoads.
+  bool hasIndirectLoads = llvm::any_of(loadToInfo, [](auto &loadAndInfo) {
+    return loadAndInfo.second.distToUse > 0;
+  });
+  if (liveRegisters && !hasIndirectLoads &&
+      failed(chooseStreamStages(forOp, loadToInfo, *liveRegisters, useAsyncCopy,
+                                numStages, globalPrefetch, localPrefetch)))
+    LDBG("No modulo schedule fits, keeping the requested stages");
 
   auto schedule =
       buildSchedule(forOp, numStages, loadToInfo, globalPrefetch, localPrefetch,
@@ -752,6 +871,27 @@ struct PipelinePass : impl::TritonAMDGPUStreamPipelineBase<PipelinePass> {
         loops.push_back(forOp);
     });
 
+    // Pipelining a loop creates new values, so the axis info is recomputed
+    // after a loop is transformed rather than for every loop.
+    std::optional<triton::AMD::ModuleAxisInfoAnalysis> axisInfoAnalysis;
+    // The register pressure only bounds the modulo schedule. Pipelining a
+    // loop creates ops the analysis doesn't know about, so the pressure of
+    // every loop is read once per function before any loop is pipelined.
+    bool moduloScheduleRequested =
+        moduloSchedule || triton::tools::getBoolEnv("TRITON_MODULO_SCHEDULE");
+    DenseMap<Operation *, unsigned> liveRegisters;
+    if (moduloScheduleRequested) {
+      std::optional<tt::RegisterPressureAnalysis> pressure;
+      FunctionOpInterface pressureFunc;
+      for (scf::ForOp forOp : loops) {
+        auto funcOp = forOp->getParentOfType<FunctionOpInterface>();
+        if (funcOp != pressureFunc) {
+          pressure.emplace(funcOp);
+          pressureFunc = funcOp;
+        }
+        liveRegisters[forOp] = pressure->getMaxPressure(forOp.getBodyRegion());
+      }
+    }
     for (scf::ForOp forOp : loops) {
       if (!triton::gpu::isSafeToPipeline(forOp)) {
         LDBG("Loop not safe to pipeline:\n" << *forOp);
@@ -761,8 +901,23 @@ struct PipelinePass : impl::TritonAMDGPUStreamPipelineBase<PipelinePass> {
       // pingpong, which is the only use case of this scheduling variant.
       int numStagesThis = tt::getNumStagesOrDefault(forOp, numStages);
       bool waitAtTail = usePingpong && (numStagesThis == 3) && useAsyncCopy;
-      (void)pipelineLoop(forOp, numStagesThis, globalPrefetch, localPrefetch,
-                         useAsyncCopy, waitAtTail);
+      // The ping-pong schedule relies on the requested stages.
+      bool useModuloSchedule = !waitAtTail && moduloScheduleRequested;
+      if (!axisInfoAnalysis)
+        axisInfoAnalysis.emplace(moduleOp);
+      LoadToInfoMap loadToInfo =
+          preprocessLoop(*axisInfoAnalysis, forOp, numStagesThis);
+      if (loadToInfo.empty()) {
+        LDBG("couldn't find any pipeline-able loads:\n" << *forOp);
+        continue;
+      }
+      (void)pipelineLoop(forOp, loadToInfo, numStagesThis, globalPrefetch,
+                         localPrefetch, useAsyncCopy, waitAtTail,
+                         useModuloSchedule
+                             ? std::optional(liveRegisters.lookup(forOp))
+                             : std::nullopt,
+                         *axisInfoAnalysis);
+      axisInfoAnalysis.reset();
     }
 
     if (useAsyncCopy) {
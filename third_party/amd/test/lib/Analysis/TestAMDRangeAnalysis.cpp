@@ -1,6 +1,6 @@
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Pass/Pass.h"
-#include "third_party/amd/include/Analysis/RangeAnalysis.h"
+#include "triton/Analysis/RangeAnalysis.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
@@ -28,11 +28,11 @@ struct TestAMDRangeAnalysisPass
 
     // Collect assumptions in the function
     DenseMap<Value, SetVector<Operation *>> assumptions =
-        AMD::TritonIntegerRangeAnalysis::collectAssumptions(getOperation());
+        TritonIntegerRangeAnalysis::collectAssumptions(getOperation());
     std::shared_ptr<DataFlowSolver> solver = createDataFlowSolver();
-    AMD::TritonIntegerRangeAnalysis *rangeAnalysis =
-        solver->load<AMD::TritonIntegerRangeAnalysis>(assumptions);
-    AMD::initializeFuncOps(mod, rangeAnalysis);
+    TritonIntegerRangeAnalysis *rangeAnalysis =
+        solver->load<TritonIntegerRangeAnalysis>(assumptions);
+    initializeFuncOps(mod, rangeAnalysis);
     if (failed(solver->initializeAndRun(getOperation())))
       return signalPassFailure();
 
@@ -41,7 +41,7 @@ struct TestAMDRangeAnalysisPass
               solver->lookupState<dataflow::IntegerValueRangeLattice>(v)) {
         if (r->getValue().isUninitialized())
           return false;
-        if (AMD::isEmptyInitializedRange(r->getValue().getValue()))
+        if (isEmptyInitializedRange(r->getValue().getValue()))
           return false;
       }
       return succeeded(dataflow::staticallyNonNegative(*solver, v));
@@ -49,7 +49,7 @@ struct TestAMDRangeAnalysisPass
 
     mod.walk<WalkOrder::PreOrder>([&solver](FuncOp funcOp) {
       auto args = funcOp.getArguments();
-      if (auto argRanges = AMD::collectRanges(*solver, args)) {
+      if (auto argRanges = collectRanges(*solver, args)) {
         int i = -1;
         for (const auto &[arg, argR] : llvm::zip(args, *argRanges)) {
           i++;
@@ -69,7 +69,7 @@ struct TestAMDRangeAnalysisPass
     mod->walk<WalkOrder::PreOrder>([&solver, nonNegativePred,
                                     rangeAnalysis](Operation *op) {
       auto results = op->getResults();
-      if (auto outputRanges = AMD::collectRanges(*solver, results)) {
+      if (auto outputRanges = collectRanges(*solver, results)) {
         int i = -1;
         for (const auto &[res, outR] : llvm::zip(results, *outputRanges)) {
           i++;
@@ -85,7 +85,7 @@ struct TestAMDRangeAnalysisPass
         }
 
         if (auto cmpOp = llvm::dyn_cast<arith::CmpIOp>(op)) {
-          if (AMD::cmpIIsStaticallyTrue(*solver, cmpOp))
+          if (cmpIIsStaticallyTrue(*solver, cmpOp))
             emitRemark(op->getLoc(), "result is true");
         }
       }
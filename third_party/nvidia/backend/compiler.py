@@ -1,6 +1,7 @@
 from triton.backends.compiler import BaseBackend, GPUTarget, Language
-from triton._C.libtriton import ir, passes, llvm, nvidia
+from triton._C.libtriton import ir, passes, llvm, nvidia, proton
 from triton import knobs
+from triton.runtime.cache import cached_codegen
 from triton.runtime.errors import PTXASError
 
 from dataclasses import dataclass
@@ -227,6 +228,7 @@ class CUDABackend(BaseBackend):
         passes.common.add_canonicalizer(pm)
         passes.ttir.add_combine(pm)
         passes.ttir.add_reorder_broadcast(pm)
+        passes.ttir.add_narrow_indexing(pm)
         passes.common.add_cse(pm)
         passes.common.add_symbol_dce(pm)
         passes.ttir.add_loop_unroll(pm)
@@ -342,6 +344,7 @@ class CUDABackend(BaseBackend):
             # Call ConcurrencySanitizerPass here, before allocating global scratch memory but after allocating tensor and shared
             passes.ttgpuir.add_concurrency_sanitizer(pm)
         passes.ttgpuir.add_allocate_global_scratch_memory(pm)
+        proton.passes.add_allocate_profile_buffer(pm, knobs.proton.record_slots_per_warp)
         nvidia.passes.ttnvgpuir.add_proxy_fence_insertion(pm, capability)
         nvidia.passes.ttgpuir.add_to_llvmir(pm, capability, ptx_version)
         passes.common.add_canonicalizer(pm)
@@ -384,10 +387,12 @@ class CUDABackend(BaseBackend):
         metadata["tmem_size"] = src.get_int_attr("ttg.tensor_memory_size")
         metadata["global_scratch_size"] = src.get_int_attr("ttg.global_scratch_memory_size")
         metadata["global_scratch_align"] = src.get_int_attr("ttg.global_scratch_memory_alignment")
-        ret = str(llvm_mod)
-        del llvm_mod
-        del context
-        return ret
+        metadata["profile_buffer_offset"] = src.get_int_attr("proton.profile_buffer_offset")
+        metadata["profile_buffer_size"] = src.get_int_attr("proton.profile_buffer_size")
+        metadata["profile_buffer_slots"] = src.get_int_attr("proton.profile_buffer_slots")
+        # The module is handed to make_ptx as is. It keeps its context alive and
+        # is only printed when it gets cached or dumped.
+        return llvm_mod
 
     def make_ptx(self, src, metadata, opt, capability):
         ptx_version = get_ptx_version_from_options(opt, self.target.arch)
@@ -395,76 +400,86 @@ class CUDABackend(BaseBackend):
         triple = 'nvptx64-nvidia-cuda'
         proc = sm_arch_from_capability(capability)
         features = get_features(opt, self.target.arch)
-        ret = llvm.translate_to_asm(src, triple, proc, features, [], opt.enable_fp_fusion, False)
+
+        def translate():
+            ret = llvm.translate_to_asm(src, triple, proc, features, [], opt.enable_fp_fusion, False)
+            # post-process
+            version = f'{ptx_version//10}.{ptx_version%10}'
+            ret = re.sub(r'\.version \d+\.\d+', f'.version {version}', ret, flags=re.MULTILINE)
+            ret = re.sub(r'\.target sm_\d+', f'.target sm_{capability}', ret, flags=re.MULTILINE)
+            # Remove the debug flag that prevents ptxas from optimizing the code
+            ret = re.sub(r",\s*debug|debug,\s*", "", ret)
+            return ret
+
+        ret = cached_codegen("ptx", [src, triple, proc, features, opt.enable_fp_fusion, ptx_version, capability],
+                             translate)
         # Find kernel names (there should only be one)
         names = re.findall(r".visible .entry ([a-zA-Z_][a-zA-Z0-9_]*)", ret)
         assert len(names) == 1
         metadata["name"] = names[0]
-        # post-process
-        ptx_version = f'{ptx_version//10}.{ptx_version%10}'
-        ret = re.sub(r'\.version \d+\.\d+', f'.version {ptx_version}', ret, flags=re.MULTILINE)
-        ret = re.sub(r'\.target sm_\d+', f'.target sm_{capability}', ret, flags=re.MULTILINE)
-        # Remove the debug flag that prevents ptxas from optimizing the code
-        ret = re.sub(r",\s*debug|debug,\s*", "", ret)
         if knobs.nvidia.dump_nvptx:
             print("// -----// NVPTX Dump //----- //")
             print(ret)
         return ret
 
     def make_cubin(self, src, metadata, opt, capability):
-        ptxas = get_ptxas().path
-        with tempfile.NamedTemporaryFile(delete=False, mode='w', suffix='.ptx') as fsrc, \
-            tempfile.NamedTemporaryFile(delete=False, mode='r', suffix='.log') as flog:
-            fsrc.write(src)
-            fsrc.flush()
-            fbin = fsrc.name + '.o'
-
-            line_info = ["-lineinfo", "-suppress-debug-info"] if knobs.compilation.disable_line_info else ["-lineinfo"]
-            fmad = [] if opt.enable_fp_fusion else ['--fmad=false']
-            arch = sm_arch_from_capability(capability)
-
-            # Disable ptxas optimizations if requested
-            disable_opt = ['--opt-level', '0'] if knobs.nvidia.disable_ptxas_opt else []
-
-            # Accept more ptxas options if provided
-            ptx_extra_options = opt.ptx_options.split(" ") if opt.ptx_options else []
-
-            ptxas_cmd = [
-                ptxas, *line_info, *fmad, '-v', *disable_opt, *ptx_extra_options, f'--gpu-name={arch}', fsrc.name, '-o',
-                fbin
-            ]
-            try:
-                subprocess.run(ptxas_cmd, check=True, close_fds=False, stderr=flog)
-                if knobs.nvidia.dump_ptxas_log:
+        ptxas = get_ptxas()
+        line_info = ["-lineinfo", "-suppress-debug-info"] if knobs.compilation.disable_line_info else ["-lineinfo"]
+        fmad = [] if opt.enable_fp_fusion else ['--fmad=false']
+        arch = sm_arch_from_capability(capability)
+
+        # Disable ptxas optimizations if requested
+        disable_opt = ['--opt-level', '0'] if knobs.nvidia.disable_ptxas_opt else []
+
+        # Accept more ptxas options if provided
+        ptx_extra_options = opt.ptx_options.split(" ") if opt.ptx_options else []
+
+        def assemble():
+            with tempfile.NamedTemporaryFile(delete=False, mode='w', suffix='.ptx') as fsrc, \
+                tempfile.NamedTemporaryFile(delete=False, mode='r', suffix='.log') as flog:
+                fsrc.write(src)
+                fsrc.flush()
+                fbin = fsrc.name + '.o'
+
+                ptxas_cmd = [
+                    ptxas.path, *line_info, *fmad, '-v', *disable_opt, *ptx_extra_options, f'--gpu-name={arch}',
+                    fsrc.name, '-o', fbin
+                ]
+                try:
+                    subprocess.run(ptxas_cmd, check=True, close_fds=False, stderr=flog)
+                    if knobs.nvidia.dump_ptxas_log:
+                        with open(flog.name) as log_file:
+                            print(log_file.read())
+
+                    if os.path.exists(fsrc.name):
+                        os.remove(fsrc.name)
+                    if os.path.exists(flog.name):
+                        os.remove(flog.name)
+                except subprocess.CalledProcessError as e:
                     with open(flog.name) as log_file:
-                        print(log_file.read())
-
-                if os.path.exists(fsrc.name):
-                    os.remove(fsrc.name)
-                if os.path.exists(flog.name):
-                    os.remove(flog.name)
-            except subprocess.CalledProcessError as e:
-                with open(flog.name) as log_file:
-                    log = log_file.read()
-                if os.path.exists(flog.name):
-                    os.remove(flog.name)
-
-                if e.returncode == 255:
-                    error = 'Internal Triton PTX codegen error'
-                elif e.returncode == 128 + signal.SIGSEGV:
-                    error = '`ptxas` raised SIGSEGV'
-                else:
-                    error = f'`ptxas` failed with error code {e.returncode}'
-
-                raise PTXASError(f"{error}\n"
-                                 f"`ptxas` stderr:\n{log}\n"
-                                 f'Repro command: {" ".join(ptxas_cmd)}\n')
-
-            with open(fbin, 'rb') as f:
-                cubin = f.read()
-            if os.path.exists(fbin):
-                os.remove(fbin)
-        return cubin
+                        log = log_file.read()
+                    if os.path.exists(flog.name):
+                        os.remove(flog.name)
+
+                    if e.returncode == 255:
+                        error = 'Internal Triton PTX codegen error'
+                    elif e.returncode == 128 + signal.SIGSEGV:
+                        error = '`ptxas` raised SIGSEGV'
+                    else:
+                        error = f'`ptxas` failed with error code {e.returncode}'
+
+                    raise PTXASError(f"{error}\n"
+                                     f"`ptxas` stderr:\n{log}\n"
+                                     f'Repro command: {" ".join(ptxas_cmd)}\n')
+
+                with open(fbin, 'rb') as f:
+                    cubin = f.read()
+                if os.path.exists(fbin):
+                    os.remove(fbin)
+            return cubin
+
+        inputs = [src, ptxas.path, ptxas.version, line_info, fmad, disable_opt, ptx_extra_options, arch]
+        return cached_codegen("cubin", inputs, assemble, binary=True)
 
     def add_stages(self, stages, options, language):
         capability = self._parse_arch(options.arch)
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <stdexcept>
+#include <string_view>
 
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
@@ -78,6 +79,21 @@ static void initProton(pybind11::module &&m) {
           SessionManager::instance().addMetrics(scopeId, metrics);
         });
 
+  m.def("add_records", [](size_t scopeId, const pybind11::bytes &scratch,
+                          size_t offset, size_t bufferSize, size_t scratchSize,
+                          size_t slots) {
+    std::string_view view = scratch;
+    auto regions = parseProfileBuffer(
+        reinterpret_cast<const uint8_t *>(view.data()), view.size(), offset,
+        bufferSize, scratchSize, slots);
+    std::map<std::string, std::map<std::string, MetricValueType>> metrics;
+    for (auto &[regionId, region] : regions) {
+      metrics["region_" + std::to_string(regionId)] = {
+          {"cycles", region.cycles}, {"count", region.count}};
+    }
+    SessionManager::instance().addRegionMetrics(scopeId, metrics);
+  });
+
   m.def("get_context_depth", [](size_t sessionId) {
     return SessionManager::instance().getContextDepth(sessionId);
   });
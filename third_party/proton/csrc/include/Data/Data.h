@@ -10,7 +10,7 @@
 
 namespace proton {
 
-enum class OutputFormat { Hatchet, Count };
+enum class OutputFormat { Hatchet, HatchetMsgPack, ChromeTrace, Count };
 
 class Data : public ScopeInterface {
 public:
@@ -32,6 +32,10 @@ public:
   addMetrics(size_t scopeId,
              const std::map<std::string, MetricValueType> &metrics) = 0;
 
+  /// Notify the data that every kernel launched by the op has been added to
+  /// it.  Data that keeps track of the ops in flight can forget the op.
+  virtual void completeOp(size_t scopeId) {}
+
   /// Clear all caching data.
   virtual void clear() = 0;
 
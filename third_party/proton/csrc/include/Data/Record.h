@@ -0,0 +1,31 @@
+#ifndef PROTON_DATA_RECORD_H_
+#define PROTON_DATA_RECORD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace proton {
+
+/// The cycles spent in a `proton.record` region, summed over every warp that
+/// executed it.
+struct RegionRecord {
+  uint64_t cycles{};
+  // Number of start/end pairs
+  uint64_t count{};
+};
+
+/// Decodes the profile buffers that `proton.record` ops write into the global
+/// scratch memory of a kernel.
+///
+/// `scratch` holds the scratch memory of every program, `scratchSize` bytes
+/// apart. Each program's buffer starts at `offset` and holds one circular
+/// buffer of `slots` records per warp; see
+/// proton/dialect/include/Dialect/Proton/IR/Dialect.h for the layout.
+std::map<uint32_t, RegionRecord>
+parseProfileBuffer(const uint8_t *scratch, size_t numBytes, size_t offset,
+                   size_t bufferSize, size_t scratchSize, size_t slots);
+
+} // namespace proton
+
+#endif // PROTON_DATA_RECORD_H_
@@ -2,13 +2,24 @@
 #define PROTON_DATA_TRACE_DATA_H_
 
 #include "Data.h"
+#include "Utility/Set.h"
+
+#include <unordered_set>
 
 namespace proton {
 
+/// TraceData records every scope, op and kernel activity as a timeline event
+/// instead of aggregating them into a tree.
+///
+/// Events are appended to a buffer owned by the recording thread, so the hot
+/// path never takes `Data::mutex`; the buffers are only merged when the trace
+/// is dumped.
 class TraceData : public Data {
 public:
-  using Data::Data;
-  virtual ~TraceData() = default;
+  TraceData(const std::string &path, ContextSource *contextSource);
+  virtual ~TraceData();
+
+  TraceData(const std::string &path) : TraceData(path, nullptr) {}
 
   size_t addOp(size_t scopeId, const std::string &name) override;
 
@@ -18,6 +29,8 @@ public:
   addMetrics(size_t scopeId,
              const std::map<std::string, MetricValueType> &metrics) override;
 
+  void completeOp(size_t scopeId) override;
+
   void clear() override;
 
 protected:
@@ -27,7 +40,16 @@ protected:
   void exitScope(const Scope &scope) override final;
 
 private:
+  void dumpChromeTrace(std::ostream &os) const;
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
+
+  class Trace;
+  std::unique_ptr<Trace> trace;
+  // Scopes and ops in flight, which ops can be nested under and kernels
+  // attached to.  Written by both the user threads and the background
+  // threads.  An op is dropped once its kernel is attached, or once the
+  // profiler reports that all of its kernels were.
+  ShardedThreadSafeSet<size_t, std::unordered_set<size_t>> activeScopeIds;
 };
 
 } // namespace proton
@@ -34,6 +34,7 @@ protected:
 private:
   void init();
   void dumpHatchet(std::ostream &os) const;
+  void dumpHatchetMsgPack(std::ostream &os) const;
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
 
   // `tree` and `scopeIdToContextId` can be accessed by both the user thread and
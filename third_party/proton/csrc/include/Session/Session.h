@@ -103,6 +103,12 @@ public:
   void addMetrics(size_t scopeId,
                   const std::map<std::string, MetricValueType> &metrics);
 
+  /// Adds an op named after each region under the op of `scopeId`.
+  void addRegionMetrics(
+      size_t scopeId,
+      const std::map<std::string, std::map<std::string, MetricValueType>>
+          &regionMetrics);
+
   void setState(std::optional<Context> context);
 
 private:
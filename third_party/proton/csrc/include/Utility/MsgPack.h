@@ -0,0 +1,123 @@
+#ifndef PROTON_UTILITY_MSGPACK_H_
+#define PROTON_UTILITY_MSGPACK_H_
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace proton {
+
+/// A minimal streaming MessagePack writer.
+/// Values are written to the stream as soon as they are packed, so arrays and
+/// maps must be announced with their number of elements before their contents.
+class MsgPackWriter {
+public:
+  explicit MsgPackWriter(std::ostream &os) : os(os) {}
+
+  void packNil() { put(0xc0); }
+
+  void packBool(bool value) { put(value ? 0xc3 : 0xc2); }
+
+  void packUInt(uint64_t value) {
+    if (value < 0x80) {
+      put(static_cast<uint8_t>(value));
+    } else if (value <= UINT8_MAX) {
+      put(0xcc);
+      put(static_cast<uint8_t>(value));
+    } else if (value <= UINT16_MAX) {
+      put(0xcd);
+      putBigEndian<uint16_t>(value);
+    } else if (value <= UINT32_MAX) {
+      put(0xce);
+      putBigEndian<uint32_t>(value);
+    } else {
+      put(0xcf);
+      putBigEndian<uint64_t>(value);
+    }
+  }
+
+  void packInt(int64_t value) {
+    if (value >= 0) {
+      packUInt(static_cast<uint64_t>(value));
+    } else if (value >= -32) {
+      put(static_cast<uint8_t>(value));
+    } else if (value >= INT8_MIN) {
+      put(0xd0);
+      put(static_cast<uint8_t>(value));
+    } else if (value >= INT16_MIN) {
+      put(0xd1);
+      putBigEndian<uint16_t>(static_cast<uint16_t>(value));
+    } else if (value >= INT32_MIN) {
+      put(0xd2);
+      putBigEndian<uint32_t>(static_cast<uint32_t>(value));
+    } else {
+      put(0xd3);
+      putBigEndian<uint64_t>(static_cast<uint64_t>(value));
+    }
+  }
+
+  void packDouble(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put(0xcb);
+    putBigEndian<uint64_t>(bits);
+  }
+
+  void packStr(const std::string &value) {
+    auto size = value.size();
+    if (size < 32) {
+      put(0xa0 | static_cast<uint8_t>(size));
+    } else if (size <= UINT8_MAX) {
+      put(0xd9);
+      put(static_cast<uint8_t>(size));
+    } else if (size <= UINT16_MAX) {
+      put(0xda);
+      putBigEndian<uint16_t>(size);
+    } else {
+      put(0xdb);
+      putBigEndian<uint32_t>(size);
+    }
+    os.write(value.data(), size);
+  }
+
+  void packArray(uint32_t size) { packHeader(size, 0x90, 0xdc, 0xdd); }
+
+  void packMap(uint32_t size) { packHeader(size, 0x80, 0xde, 0xdf); }
+
+  void pack(uint64_t value) { packUInt(value); }
+  void pack(int64_t value) { packInt(value); }
+  void pack(double value) { packDouble(value); }
+  void pack(const std::string &value) { packStr(value); }
+
+private:
+  void packHeader(uint32_t size, uint8_t fixMarker, uint8_t marker16,
+                  uint8_t marker32) {
+    if (size < 16) {
+      put(fixMarker | static_cast<uint8_t>(size));
+    } else if (size <= UINT16_MAX) {
+      put(marker16);
+      putBigEndian<uint16_t>(size);
+    } else {
+      put(marker32);
+      putBigEndian<uint32_t>(size);
+    }
+  }
+
+  void put(uint8_t byte) { os.put(static_cast<char>(byte)); }
+
+  template <typename T> void putBigEndian(T value) {
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      bytes[sizeof(T) - 1 - i] = static_cast<char>(value & 0xff);
+      value >>= 8;
+    }
+    os.write(bytes, sizeof(T));
+  }
+
+  std::ostream &os;
+};
+
+} // namespace proton
+
+#endif // PROTON_UTILITY_MSGPACK_H_
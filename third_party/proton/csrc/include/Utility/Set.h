@@ -1,6 +1,8 @@
 #ifndef PROTON_UTILITY_SET_H_
 #define PROTON_UTILITY_SET_H_
 
+#include <array>
+#include <functional>
 #include <set>
 #include <shared_mutex>
 
@@ -40,6 +42,38 @@ private:
   std::shared_mutex mutex;
 };
 
+/// A thread safe set split into independently locked shards, so that threads
+/// inserting or erasing different keys rarely wait for each other.
+template <typename Key, typename Container = std::set<Key>,
+          size_t NumShards = 16>
+class ShardedThreadSafeSet {
+public:
+  ShardedThreadSafeSet() = default;
+
+  void insert(const Key &key) { getShard(key).insert(key); }
+
+  bool contain(const Key &key) { return getShard(key).contain(key); }
+
+  bool erase(const Key &key) { return getShard(key).erase(key); }
+
+  void clear() {
+    for (auto &shard : shards)
+      shard.set.clear();
+  }
+
+private:
+  // Keep every shard on its own cache line
+  struct alignas(64) Shard {
+    ThreadSafeSet<Key, Container> set;
+  };
+
+  ThreadSafeSet<Key, Container> &getShard(const Key &key) {
+    return shards[std::hash<Key>{}(key) % NumShards].set;
+  }
+
+  std::array<Shard, NumShards> shards;
+};
+
 } // namespace proton
 
 #endif // PROTON_UTILITY_MAP_H_
@@ -16,9 +16,8 @@ void Data::dump(OutputFormat outputFormat) {
   if (path.empty() || path == "-") {
     out.reset(new std::ostream(std::cout.rdbuf())); // Redirecting to cout
   } else {
-    out.reset(new std::ofstream(
-        path + "." +
-        outputFormatToString(outputFormat))); // Opening a file for output
+    out.reset(new std::ofstream(path + "." + outputFormatToString(outputFormat),
+                                std::ios::binary)); // Opening a file for output
   }
   doDump(*out, outputFormat);
 }
@@ -26,6 +25,10 @@ void Data::dump(OutputFormat outputFormat) {
 OutputFormat parseOutputFormat(const std::string &outputFormat) {
   if (toLower(outputFormat) == "hatchet") {
     return OutputFormat::Hatchet;
+  } else if (toLower(outputFormat) == "hatchet_msgpack") {
+    return OutputFormat::HatchetMsgPack;
+  } else if (toLower(outputFormat) == "chrome_trace") {
+    return OutputFormat::ChromeTrace;
   }
   throw std::runtime_error("Unknown output format: " + outputFormat);
 }
@@ -33,6 +36,10 @@ OutputFormat parseOutputFormat(const std::string &outputFormat) {
 const std::string outputFormatToString(OutputFormat outputFormat) {
   if (outputFormat == OutputFormat::Hatchet) {
     return "hatchet";
+  } else if (outputFormat == OutputFormat::HatchetMsgPack) {
+    return "hatchet_msgpack";
+  } else if (outputFormat == OutputFormat::ChromeTrace) {
+    return "chrome_trace";
   }
   throw std::runtime_error("Unknown output format: " +
                            std::to_string(static_cast<int>(outputFormat)));
@@ -0,0 +1,71 @@
+#include "Data/Record.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace proton {
+
+namespace {
+
+// Must match the constants in the proton dialect
+constexpr size_t kHeaderBytes = 8;
+constexpr size_t kRecordBytes = 8;
+constexpr uint32_t kStartBit = 1u << 31;
+
+uint32_t readU32(const uint8_t *ptr) {
+  // Device memory is little endian, like the hosts proton runs on
+  uint32_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+void parseWarpBuffer(const uint8_t *warp, size_t slots,
+                     std::map<uint32_t, RegionRecord> &regions) {
+  uint64_t count = readU32(warp);
+  // Older records have been overwritten once a warp wraps around
+  uint64_t first = count > slots ? count - slots : 0;
+  std::unordered_map<uint32_t, uint32_t> startCycles;
+  for (uint64_t i = first; i < count; ++i) {
+    const uint8_t *record = warp + kHeaderBytes + (i % slots) * kRecordBytes;
+    uint32_t tag = readU32(record);
+    uint32_t cycles = readU32(record + sizeof(uint32_t));
+    uint32_t regionId = tag & ~kStartBit;
+    if (tag & kStartBit) {
+      startCycles[regionId] = cycles;
+      continue;
+    }
+    auto startIt = startCycles.find(regionId);
+    // The start record was overwritten
+    if (startIt == startCycles.end())
+      continue;
+    auto &region = regions[regionId];
+    // Only the low 32 bits of the counter are recorded
+    region.cycles += static_cast<uint32_t>(cycles - startIt->second);
+    region.count += 1;
+    startCycles.erase(startIt);
+  }
+}
+
+} // namespace
+
+std::map<uint32_t, RegionRecord>
+parseProfileBuffer(const uint8_t *scratch, size_t numBytes, size_t offset,
+                   size_t bufferSize, size_t scratchSize, size_t slots) {
+  size_t bytesPerWarp = kHeaderBytes + slots * kRecordBytes;
+  if (slots == 0 || scratchSize == 0 || offset + bufferSize > scratchSize ||
+      bufferSize % bytesPerWarp != 0)
+    throw std::invalid_argument("Invalid profile buffer layout");
+  size_t numWarps = bufferSize / bytesPerWarp;
+  std::map<uint32_t, RegionRecord> regions;
+  for (size_t program = 0; (program + 1) * scratchSize <= numBytes;
+       ++program) {
+    const uint8_t *buffer = scratch + program * scratchSize + offset;
+    for (size_t warp = 0; warp < numWarps; ++warp)
+      parseWarpBuffer(buffer + warp * bytesPerWarp, slots, regions);
+  }
+  return regions;
+}
+
+} // namespace proton
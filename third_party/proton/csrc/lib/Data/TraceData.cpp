@@ -1,31 +1,329 @@
 #include "Data/TraceData.h"
-#include "Utility/Errors.h"
+#include "Context/Context.h"
+#include "Data/Metric.h"
+#include "Driver/Device.h"
+#include "nlohmann/json.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
 
 namespace proton {
 
-void TraceData::enterScope(const Scope &scope) { throw NotImplemented(); }
+namespace {
+
+uint64_t getHostTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Chrome trace timestamps are in microseconds
+double toTraceTime(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+} // namespace
+
+class TraceData::Trace {
+public:
+  struct Event {
+    enum class Kind { ScopeEnter, ScopeExit, Op, Kernel, Metrics };
+
+    Kind kind;
+    size_t scopeId;
+    // The scope an op was added under, if any
+    size_t parentId = Scope::DummyScopeId;
+    // Host time for scopes and ops, device time for kernels
+    uint64_t startTime = 0;
+    uint64_t endTime = 0;
+    uint64_t deviceId = 0;
+    uint64_t deviceType = 0;
+    std::string name{};
+    // Where an op was launched from, if it wasn't added under a scope
+    std::vector<Context> contexts{};
+    std::map<std::string, MetricValueType> metrics{};
+  };
+
+  struct ThreadBuffer {
+    explicit ThreadBuffer(size_t threadIndex)
+        : threadIndex(threadIndex), owner(std::this_thread::get_id()) {}
+
+    const size_t threadIndex;
+    const std::thread::id owner;
+    // Only contended while the trace is being dumped
+    std::mutex mutex;
+    std::vector<Event> events;
+  };
+
+  Trace() : id(nextTraceId++) {}
+
+  void append(Event event) {
+    auto &buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back(std::move(event));
+  }
+
+  template <typename FnT> void forEachBuffer(FnT &&fn) const {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto &buffer : buffers) {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      fn(*buffer);
+    }
+  }
+
+private:
+  ThreadBuffer &getThreadBuffer() {
+    // Only the buffer of the last trace this thread appended to is cached, so
+    // the cache doesn't grow with the number of traces.  It is keyed by the
+    // trace id rather than its address, so a buffer of a destroyed trace is
+    // never handed to a new one
+    struct CachedBuffer {
+      size_t traceId;
+      ThreadBuffer *buffer;
+    };
+    thread_local CachedBuffer cached{std::numeric_limits<size_t>::max(),
+                                     nullptr};
+    if (cached.traceId != id) {
+      cached = {id, &findOrCreateThreadBuffer()};
+    }
+    return *cached.buffer;
+  }
+
+  ThreadBuffer &findOrCreateThreadBuffer() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    auto threadId = std::this_thread::get_id();
+    for (auto &buffer : buffers) {
+      if (buffer->owner == threadId)
+        return *buffer;
+    }
+    buffers.push_back(std::make_unique<ThreadBuffer>(buffers.size()));
+    return *buffers.back();
+  }
 
-void TraceData::exitScope(const Scope &scope) { throw NotImplemented(); }
+  inline static std::atomic<size_t> nextTraceId{0};
+
+  const size_t id;
+  mutable std::mutex buffersMutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+void TraceData::enterScope(const Scope &scope) {
+  activeScopeIds.insert(scope.scopeId);
+  Trace::Event event{Trace::Event::Kind::ScopeEnter, scope.scopeId};
+  event.startTime = getHostTime();
+  event.name = scope.name;
+  trace->append(std::move(event));
+}
+
+void TraceData::exitScope(const Scope &scope) {
+  // Ops added under the scope have ids of their own, so nothing refers to the
+  // scope id anymore
+  activeScopeIds.erase(scope.scopeId);
+  Trace::Event event{Trace::Event::Kind::ScopeExit, scope.scopeId};
+  event.startTime = getHostTime();
+  event.name = scope.name;
+  trace->append(std::move(event));
+}
 
 size_t TraceData::addOp(size_t scopeId, const std::string &name) {
-  throw NotImplemented();
+  Trace::Event event{Trace::Event::Kind::Op, scopeId};
+  event.startTime = getHostTime();
+  event.name = name;
+  if (activeScopeIds.contain(scopeId)) {
+    // Add a new op under the scope
+    event.parentId = scopeId;
+    scopeId = Scope::getNewScopeId();
+    event.scopeId = scopeId;
+  } else if (contextSource != nullptr) {
+    // Record where the op is launched from
+    event.contexts = contextSource->getContexts();
+  }
+  activeScopeIds.insert(scopeId);
+  trace->append(std::move(event));
+  return scopeId;
 }
 
 void TraceData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
-  throw NotImplemented();
+  // The profile data is deactivated, ignore the metric
+  if (!activeScopeIds.contain(scopeId))
+    return;
+  // Only kernel activities have a place on the timeline
+  if (metric->getKind() != MetricKind::Kernel)
+    return;
+  auto kernelMetric = std::dynamic_pointer_cast<KernelMetric>(metric);
+  Trace::Event event{Trace::Event::Kind::Kernel, scopeId};
+  event.startTime =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::StartTime));
+  event.endTime =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::EndTime));
+  event.deviceId =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceId));
+  event.deviceType =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceType));
+  trace->append(std::move(event));
+  // An op launches a single kernel, unless it is a graph or CUDA API launch.
+  // Those are the parents of one op per kernel and are dropped by completeOp.
+  activeScopeIds.erase(scopeId);
 }
 
+void TraceData::completeOp(size_t scopeId) { activeScopeIds.erase(scopeId); }
+
 void TraceData::addMetrics(
     size_t scopeId, const std::map<std::string, MetricValueType> &metrics) {
-  throw NotImplemented();
+  // The profile data is deactivated, ignore the metric
+  if (!activeScopeIds.contain(scopeId))
+    return;
+  Trace::Event event{Trace::Event::Kind::Metrics, scopeId};
+  event.metrics = metrics;
+  trace->append(std::move(event));
 }
 
-void TraceData::clear() { throw NotImplemented(); }
+// The recorded events are kept: a session is deactivated, and so cleared,
+// right before its data is dumped
+void TraceData::clear() { activeScopeIds.clear(); }
+
+void TraceData::dumpChromeTrace(std::ostream &os) const {
+  using Kind = Trace::Event::Kind;
+
+  // First pass: names, parents and user metrics of every scope and op, which
+  // can be recorded on a different thread than the events that refer to them
+  std::unordered_map<size_t, std::string> names;
+  std::unordered_map<size_t, size_t> parents;
+  std::unordered_map<size_t, json> args;
+  trace->forEachBuffer([&](const Trace::ThreadBuffer &buffer) {
+    for (const auto &event : buffer.events) {
+      auto &eventArgs = args[event.scopeId];
+      if (event.kind == Kind::ScopeEnter || event.kind == Kind::Op) {
+        names[event.scopeId] = event.name;
+      }
+      if (event.kind == Kind::Op && event.parentId != Scope::DummyScopeId) {
+        parents[event.scopeId] = event.parentId;
+      }
+      if (event.kind == Kind::Op && !event.contexts.empty()) {
+        std::string path;
+        for (const auto &context : event.contexts) {
+          path += (path.empty() ? "" : "/") + context.name;
+        }
+        eventArgs["context"] = path;
+      }
+      for (const auto &[metricName, metricValue] : event.metrics) {
+        std::visit([&](auto &&value) { eventArgs[metricName] = value; },
+                   metricValue);
+      }
+    }
+  });
+  auto getArgs = [&](size_t scopeId) {
+    json eventArgs = args[scopeId];
+    eventArgs["scope_id"] = scopeId;
+    auto parentIt = parents.find(scopeId);
+    if (parentIt != parents.end()) {
+      eventArgs["parent_scope_id"] = parentIt->second;
+      eventArgs["parent"] = names[parentIt->second];
+    }
+    return eventArgs;
+  };
+
+  // Second pass: write one event at a time instead of building the document
+  bool first = true;
+  auto write = [&](const json &traceEvent) {
+    os << (first ? "\n" : ",\n") << traceEvent.dump();
+    first = false;
+  };
+  constexpr int hostPid = 0;
+  std::map<std::pair<uint64_t, uint64_t>, int> devicePids;
+  auto getDevicePid = [&](uint64_t deviceType, uint64_t deviceId) {
+    auto [it, inserted] = devicePids.try_emplace({deviceType, deviceId},
+                                                 hostPid + 1 + devicePids.size());
+    if (inserted) {
+      auto deviceName =
+          getDeviceTypeString(static_cast<DeviceType>(deviceType)) + " " +
+          std::to_string(deviceId);
+      write({{"ph", "M"},
+             {"name", "process_name"},
+             {"pid", it->second},
+             {"args", {{"name", deviceName}}}});
+    }
+    return it->second;
+  };
+
+  os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  write({{"ph", "M"},
+         {"name", "process_name"},
+         {"pid", hostPid},
+         {"args", {{"name", "host"}}}});
+  trace->forEachBuffer([&](const Trace::ThreadBuffer &buffer) {
+    auto tid = buffer.threadIndex;
+    write({{"ph", "M"},
+           {"name", "thread_name"},
+           {"pid", hostPid},
+           {"tid", tid},
+           {"args", {{"name", "thread " + std::to_string(tid)}}}});
+    for (const auto &event : buffer.events) {
+      switch (event.kind) {
+      case Kind::ScopeEnter:
+        write({{"ph", "B"},
+               {"name", event.name},
+               {"pid", hostPid},
+               {"tid", tid},
+               {"ts", toTraceTime(event.startTime)},
+               {"args", getArgs(event.scopeId)}});
+        break;
+      case Kind::ScopeExit:
+        write({{"ph", "E"},
+               {"pid", hostPid},
+               {"tid", tid},
+               {"ts", toTraceTime(event.startTime)}});
+        break;
+      case Kind::Op:
+        // Ops added under a scope are attached by the profiler's background
+        // thread, so only launches have a meaningful host time
+        if (event.parentId == Scope::DummyScopeId) {
+          write({{"ph", "i"},
+                 {"s", "t"},
+                 {"name", event.name},
+                 {"pid", hostPid},
+                 {"tid", tid},
+                 {"ts", toTraceTime(event.startTime)},
+                 {"args", getArgs(event.scopeId)}});
+        }
+        break;
+      case Kind::Kernel:
+        write({{"ph", "X"},
+               {"name", names[event.scopeId]},
+               {"pid", getDevicePid(event.deviceType, event.deviceId)},
+               {"tid", 0},
+               {"ts", toTraceTime(event.startTime)},
+               {"dur", toTraceTime(event.endTime - event.startTime)},
+               {"args", getArgs(event.scopeId)}});
+        break;
+      case Kind::Metrics:
+        // Merged into the args of the scope above
+        break;
+      }
+    }
+  });
+  os << "\n]}" << std::endl;
+}
 
 void TraceData::doDump(std::ostream &os, OutputFormat outputFormat) const {
-  throw NotImplemented();
+  if (outputFormat == OutputFormat::ChromeTrace) {
+    dumpChromeTrace(os);
+  } else {
+    throw std::logic_error("TraceData only supports the chrome_trace output "
+                           "format, but got " +
+                           outputFormatToString(outputFormat));
+  }
 }
 
+TraceData::TraceData(const std::string &path, ContextSource *contextSource)
+    : Data(path, contextSource), trace(std::make_unique<Trace>()) {}
+
+TraceData::~TraceData() {}
+
 } // namespace proton
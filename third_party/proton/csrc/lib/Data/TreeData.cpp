@@ -2,8 +2,10 @@
 #include "Context/Context.h"
 #include "Data/Metric.h"
 #include "Driver/Device.h"
+#include "Utility/MsgPack.h"
 #include "nlohmann/json.hpp"
 
+#include <array>
 #include <limits>
 #include <map>
 #include <mutex>
@@ -16,58 +18,67 @@ namespace proton {
 
 class TreeData::Tree {
 public:
-  struct TreeNode : public Context {
+  struct TreeNode {
     inline static const size_t RootId = 0;
     inline static const size_t DummyId = std::numeric_limits<size_t>::max();
 
     TreeNode() = default;
-    explicit TreeNode(size_t id, const std::string &name)
-        : id(id), Context(name) {}
-    TreeNode(size_t id, size_t parentId, const std::string &name)
-        : id(id), parentId(parentId), Context(name) {}
-    virtual ~TreeNode() = default;
+    TreeNode(size_t id, size_t parentId, size_t nameId)
+        : id(id), parentId(parentId), nameId(nameId) {}
 
-    void addChild(const Context &context, size_t id) { children[context] = id; }
-
-    bool hasChild(const Context &context) const {
-      return children.find(context) != children.end();
+    std::shared_ptr<Metric> &getMetric(MetricKind metricKind) {
+      return metrics[static_cast<size_t>(metricKind)];
     }
 
-    size_t getChild(const Context &context) const {
-      return children.at(context);
+    template <typename FnT> void forEachMetric(FnT &&fn) const {
+      for (size_t i = 0; i < metrics.size(); ++i) {
+        if (metrics[i])
+          fn(static_cast<MetricKind>(i), metrics[i]);
+      }
     }
 
-    size_t parentId = DummyId;
     size_t id = DummyId;
-    std::map<Context, size_t> children = {};
-    std::map<MetricKind, std::shared_ptr<Metric>> metrics = {};
-    std::map<std::string, FlexibleMetric> flexibleMetrics = {};
-    friend class Tree;
+    size_t parentId = DummyId;
+    // Index into the tree's interned context names
+    size_t nameId = DummyId;
+    // Child ids in insertion order; lookups by name go through the tree
+    std::vector<size_t> children = {};
+    // One slot per fixed metric kind, indexed by MetricKind
+    std::array<std::shared_ptr<Metric>, static_cast<size_t>(MetricKind::Count)>
+        metrics = {};
+    std::unordered_map<std::string, FlexibleMetric> flexibleMetrics = {};
   };
 
   Tree() {
-    treeNodeMap.try_emplace(TreeNode::RootId, TreeNode::RootId, "ROOT");
+    treeNodes.emplace_back(TreeNode::RootId, TreeNode::DummyId,
+                           internName("ROOT"));
   }
 
   size_t addNode(const Context &context, size_t parentId) {
-    if (treeNodeMap[parentId].hasChild(context)) {
-      return treeNodeMap[parentId].getChild(context);
+    auto nameId = internName(context.name);
+    auto [childIt, inserted] =
+        childIds.try_emplace({parentId, nameId}, treeNodes.size());
+    if (inserted) {
+      auto id = childIt->second;
+      treeNodes.emplace_back(id, parentId, nameId);
+      treeNodes[parentId].children.push_back(id);
     }
-    auto id = nextContextId++;
-    treeNodeMap.try_emplace(id, id, parentId, context.name);
-    treeNodeMap[parentId].addChild(context, id);
-    return id;
+    return childIt->second;
   }
 
   size_t addNode(const std::vector<Context> &indices) {
     auto parentId = TreeNode::RootId;
-    for (auto index : indices) {
+    for (auto &index : indices) {
       parentId = addNode(index, parentId);
     }
     return parentId;
   }
 
-  TreeNode &getNode(size_t id) { return treeNodeMap.at(id); }
+  TreeNode &getNode(size_t id) { return treeNodes[id]; }
+
+  const std::string &getName(const TreeNode &node) const {
+    return names[node.nameId]->first;
+  }
 
   enum class WalkPolicy { PreOrder, PostOrder };
 
@@ -81,22 +92,40 @@ public:
 
   template <typename FnT> void walkPreOrder(size_t contextId, FnT &&fn) {
     fn(getNode(contextId));
-    for (auto &child : getNode(contextId).children) {
-      walkPreOrder(child.second, fn);
+    for (auto childId : getNode(contextId).children) {
+      walkPreOrder(childId, fn);
     }
   }
 
   template <typename FnT> void walkPostOrder(size_t contextId, FnT &&fn) {
-    for (auto &child : getNode(contextId).children) {
-      walkPostOrder(child.second, fn);
+    for (auto childId : getNode(contextId).children) {
+      walkPostOrder(childId, fn);
     }
     fn(getNode(contextId));
   }
 
 private:
-  size_t nextContextId = TreeNode::RootId + 1;
+  struct ChildKeyHash {
+    size_t operator()(const std::pair<size_t, size_t> &key) const {
+      return std::hash<size_t>()(key.first) * 31 +
+             std::hash<size_t>()(key.second);
+    }
+  };
+
+  size_t internName(const std::string &name) {
+    auto [it, inserted] = nameIds.try_emplace(name, names.size());
+    if (inserted)
+      names.push_back(&*it);
+    return it->second;
+  }
+
   // tree node id -> tree node
-  std::map<size_t, TreeNode> treeNodeMap;
+  std::vector<TreeNode> treeNodes;
+  // context name -> name id, and back (unordered_map nodes are stable)
+  std::unordered_map<std::string, size_t> nameIds;
+  std::vector<const std::pair<const std::string, size_t> *> names;
+  // (parent id, name id) -> child id
+  std::unordered_map<std::pair<size_t, size_t>, size_t, ChildKeyHash> childIds;
 };
 
 void TreeData::init() { tree = std::make_unique<Tree>(); }
@@ -141,11 +170,11 @@ void TreeData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
   if (scopeIdIt == scopeIdToContextId.end())
     return;
   auto contextId = scopeIdIt->second;
-  auto &node = tree->getNode(contextId);
-  if (node.metrics.find(metric->getKind()) == node.metrics.end())
-    node.metrics.emplace(metric->getKind(), metric);
+  auto &nodeMetric = tree->getNode(contextId).getMetric(metric->getKind());
+  if (!nodeMetric)
+    nodeMetric = metric;
   else
-    node.metrics[metric->getKind()]->updateMetric(*metric);
+    nodeMetric->updateMetric(*metric);
 }
 
 void TreeData::addMetrics(
@@ -157,12 +186,13 @@ void TreeData::addMetrics(
     return;
   auto contextId = scopeIdIt->second;
   auto &node = tree->getNode(contextId);
-  for (auto [metricName, metricValue] : metrics) {
-    if (node.flexibleMetrics.find(metricName) == node.flexibleMetrics.end()) {
+  for (auto &[metricName, metricValue] : metrics) {
+    auto flexibleMetricIt = node.flexibleMetrics.find(metricName);
+    if (flexibleMetricIt == node.flexibleMetrics.end()) {
       node.flexibleMetrics.emplace(metricName,
                                    FlexibleMetric(metricName, metricValue));
     } else {
-      node.flexibleMetrics.at(metricName).updateValue(metricValue);
+      flexibleMetricIt->second.updateValue(metricValue);
     }
   }
 }
@@ -181,12 +211,13 @@ void TreeData::dumpHatchet(std::ostream &os) const {
   std::map<uint64_t, std::set<uint64_t>> deviceIds;
   this->tree->template walk<Tree::WalkPolicy::PreOrder>(
       [&](Tree::TreeNode &treeNode) {
-        const auto contextName = treeNode.name;
+        const auto &contextName = tree->getName(treeNode);
         auto contextId = treeNode.id;
         json *jsonNode = jsonNodes[contextId];
         (*jsonNode)["frame"] = {{"name", contextName}, {"type", "function"}};
         (*jsonNode)["metrics"] = json::object();
-        for (auto [metricKind, metric] : treeNode.metrics) {
+        treeNode.forEachMetric([&](MetricKind metricKind,
+                                   const std::shared_ptr<Metric> &metric) {
           if (metricKind == MetricKind::Kernel) {
             std::shared_ptr<KernelMetric> kernelMetric =
                 std::dynamic_pointer_cast<KernelMetric>(metric);
@@ -232,7 +263,7 @@ void TreeData::dumpHatchet(std::ostream &os) const {
           } else {
             throw std::runtime_error("MetricKind not supported");
           }
-        }
+        });
         for (auto [_, flexibleMetric] : treeNode.flexibleMetrics) {
           auto valueName = flexibleMetric.getValueName(0);
           if (!flexibleMetric.isExclusive(0))
@@ -242,13 +273,12 @@ void TreeData::dumpHatchet(std::ostream &os) const {
               flexibleMetric.getValues()[0]);
         }
         (*jsonNode)["children"] = json::array();
-        auto children = treeNode.children;
+        auto &children = treeNode.children;
         for (auto _ : children) {
           (*jsonNode)["children"].push_back(json::object());
         }
         auto idx = 0;
-        for (auto child : children) {
-          auto [index, childId] = child;
+        for (auto childId : children) {
           jsonNodes[childId] = &(*jsonNode)["children"][idx];
           idx++;
         }
@@ -281,11 +311,140 @@ void TreeData::dumpHatchet(std::ostream &os) const {
   os << std::endl << output.dump(4) << std::endl;
 }
 
+namespace {
+
+// The hatchet metric values of a node, in the order the JSON dump emits them.
+template <typename TreeNodeT, typename FnT>
+void forEachHatchetMetric(const TreeNodeT &treeNode, FnT &&fn) {
+  treeNode.forEachMetric([&](MetricKind metricKind,
+                             const std::shared_ptr<Metric> &metric) {
+    if (metricKind == MetricKind::Kernel) {
+      auto kernelMetric = std::dynamic_pointer_cast<KernelMetric>(metric);
+      uint64_t deviceId =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceId));
+      uint64_t deviceType =
+          std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceType));
+      for (auto valueId : {KernelMetric::Duration, KernelMetric::Invocations}) {
+        fn(kernelMetric->getValueName(valueId), /*inclusive=*/true,
+           kernelMetric->getValue(valueId));
+      }
+      fn(kernelMetric->getValueName(KernelMetric::DeviceId),
+         /*inclusive=*/false, MetricValueType(std::to_string(deviceId)));
+      fn(kernelMetric->getValueName(KernelMetric::DeviceType),
+         /*inclusive=*/false,
+         MetricValueType(
+             getDeviceTypeString(static_cast<DeviceType>(deviceType))));
+    } else if (metricKind == MetricKind::PCSampling) {
+      auto pcSamplingMetric =
+          std::dynamic_pointer_cast<PCSamplingMetric>(metric);
+      for (size_t i = 0; i < PCSamplingMetric::Count; i++) {
+        fn(pcSamplingMetric->getValueName(i), /*inclusive=*/true,
+           pcSamplingMetric->getValues()[i]);
+      }
+    } else {
+      throw std::runtime_error("MetricKind not supported");
+    }
+  });
+  for (auto &[_, flexibleMetric] : treeNode.flexibleMetrics) {
+    fn(flexibleMetric.getValueName(0), !flexibleMetric.isExclusive(0),
+       flexibleMetric.getValues()[0]);
+  }
+}
+
+} // namespace
+
+void TreeData::dumpHatchetMsgPack(std::ostream &os) const {
+  // The layout matches the JSON dump, but nodes are written as the tree is
+  // walked instead of being collected into a document first.  Only the root
+  // needs to know about the whole tree, so a first walk gathers the
+  // inclusive metric names it carries as hints and the devices in use.
+  std::set<std::string> inclusiveValueNames;
+  std::map<uint64_t, std::set<uint64_t>> deviceIds;
+  this->tree->template walk<Tree::WalkPolicy::PreOrder>(
+      [&](Tree::TreeNode &treeNode) {
+        forEachHatchetMetric(treeNode, [&](const std::string &valueName,
+                                           bool inclusive,
+                                           const MetricValueType &) {
+          if (inclusive)
+            inclusiveValueNames.insert(valueName);
+        });
+        if (auto &metric = treeNode.getMetric(MetricKind::Kernel)) {
+          auto kernelMetric = std::dynamic_pointer_cast<KernelMetric>(metric);
+          deviceIds[std::get<uint64_t>(
+                        kernelMetric->getValue(KernelMetric::DeviceType))]
+              .insert(std::get<uint64_t>(
+                  kernelMetric->getValue(KernelMetric::DeviceId)));
+        }
+      });
+
+  MsgPackWriter writer(os);
+  writer.packArray(2);
+  std::vector<std::pair<std::string, MetricValueType>> metrics;
+  this->tree->template walk<Tree::WalkPolicy::PreOrder>(
+      [&](Tree::TreeNode &treeNode) {
+        metrics.clear();
+        forEachHatchetMetric(treeNode,
+                             [&](const std::string &valueName, bool,
+                                 const MetricValueType &value) {
+                               metrics.emplace_back(valueName, value);
+                             });
+        if (treeNode.id == Tree::TreeNode::RootId) {
+          std::map<std::string, MetricValueType> rootMetrics(metrics.begin(),
+                                                             metrics.end());
+          for (auto &valueName : inclusiveValueNames)
+            rootMetrics[valueName] = uint64_t(0);
+          metrics.assign(rootMetrics.begin(), rootMetrics.end());
+        }
+        writer.packMap(3);
+        writer.packStr("frame");
+        writer.packMap(2);
+        writer.packStr("name");
+        writer.packStr(tree->getName(treeNode));
+        writer.packStr("type");
+        writer.packStr("function");
+        writer.packStr("metrics");
+        writer.packMap(metrics.size());
+        for (auto &[valueName, value] : metrics) {
+          writer.packStr(valueName);
+          std::visit([&](auto &&v) { writer.pack(v); }, value);
+        }
+        // The children themselves follow in the pre-order walk
+        writer.packStr("children");
+        writer.packArray(treeNode.children.size());
+      });
+
+  writer.packMap(deviceIds.size());
+  for (auto &[deviceType, ids] : deviceIds) {
+    writer.packStr(getDeviceTypeString(static_cast<DeviceType>(deviceType)));
+    writer.packMap(ids.size());
+    for (auto deviceId : ids) {
+      Device device = getDevice(static_cast<DeviceType>(deviceType), deviceId);
+      writer.packStr(std::to_string(deviceId));
+      writer.packMap(5);
+      writer.packStr("clock_rate");
+      writer.packUInt(device.clockRate);
+      writer.packStr("memory_clock_rate");
+      writer.packUInt(device.memoryClockRate);
+      writer.packStr("bus_width");
+      writer.packUInt(device.busWidth);
+      writer.packStr("arch");
+      writer.packStr(device.arch);
+      writer.packStr("num_sms");
+      writer.packUInt(device.numSms);
+    }
+  }
+  os.flush();
+}
+
 void TreeData::doDump(std::ostream &os, OutputFormat outputFormat) const {
   if (outputFormat == OutputFormat::Hatchet) {
     dumpHatchet(os);
+  } else if (outputFormat == OutputFormat::HatchetMsgPack) {
+    dumpHatchetMsgPack(os);
   } else {
-    std::logic_error("OutputFormat not supported");
+    throw std::logic_error("TreeData does not support the " +
+                           outputFormatToString(outputFormat) +
+                           " output format");
   }
 }
 
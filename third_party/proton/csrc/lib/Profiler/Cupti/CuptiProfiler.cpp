@@ -83,6 +83,8 @@ processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
   --numInstances;
   if (numInstances == 0) {
     corrIdToExternId.erase(correlationId);
+    for (auto *data : dataSet)
+      data->completeOp(parentId);
   } else {
     corrIdToExternId[correlationId].second = numInstances;
   }
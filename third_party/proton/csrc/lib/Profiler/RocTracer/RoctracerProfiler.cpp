@@ -124,6 +124,8 @@ void processActivityKernel(
   --numInstances;
   if (numInstances == 0) {
     corrIdToExternId.erase(correlationId);
+    for (auto *data : dataSet)
+      data->completeOp(parentId);
   } else {
     corrIdToExternId[correlationId].second = numInstances;
   }
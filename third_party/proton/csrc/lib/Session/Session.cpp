@@ -1,6 +1,7 @@
 #include "Session/Session.h"
 #include "Context/Python.h"
 #include "Context/Shadow.h"
+#include "Data/TraceData.h"
 #include "Data/TreeData.h"
 #include "Profiler/Cupti/CuptiProfiler.h"
 #include "Profiler/Roctracer/RoctracerProfiler.h"
@@ -27,6 +28,8 @@ std::unique_ptr<Data> makeData(const std::string &dataName,
                                ContextSource *contextSource) {
   if (toLower(dataName) == "tree") {
     return std::make_unique<TreeData>(path, contextSource);
+  } else if (toLower(dataName) == "trace") {
+    return std::make_unique<TraceData>(path, contextSource);
   }
   throw std::runtime_error("Unknown data: " + dataName);
 }
@@ -232,6 +235,22 @@ void SessionManager::addMetrics(
   }
 }
 
+void SessionManager::addRegionMetrics(
+    size_t scopeId,
+    const std::map<std::string, std::map<std::string, MetricValueType>>
+        &regionMetrics) {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto [sessionId, active] : sessionActive) {
+    if (!active)
+      continue;
+    auto data = sessions[sessionId]->data.get();
+    for (auto &[name, metrics] : regionMetrics) {
+      auto regionScopeId = data->addOp(scopeId, name);
+      data->addMetrics(regionScopeId, metrics);
+    }
+  }
+}
+
 void SessionManager::setState(std::optional<Context> context) {
   std::lock_guard<std::mutex> lock(mutex);
   for (auto iter : contextSourceCounts) {
@@ -16,7 +16,31 @@
 
 namespace mlir {
 namespace triton {
-namespace proton {} // namespace proton
+namespace proton {
+
+// Module attributes describing the profile buffer that lowered proton.record
+// ops append to. The buffer lives at `offset` bytes into the global scratch
+// memory of every program and holds one circular buffer per warp.
+constexpr static char AttrProfileBufferOffsetName[] =
+    "proton.profile_buffer_offset";
+constexpr static char AttrProfileBufferSizeName[] =
+    "proton.profile_buffer_size";
+constexpr static char AttrProfileBufferSlotsName[] =
+    "proton.profile_buffer_slots";
+
+// Each per-warp circular buffer starts with a header holding the number of
+// records the warp has appended so far (u32) and padding, followed by `slots`
+// records. A record is a tag (u32: isStart << 31 | regionId) and the low 32
+// bits of the cycle counter (u32). The host-side decoder in
+// proton/csrc/lib/Data/Record.cpp relies on this layout.
+constexpr int kProfileBufferHeaderBytes = 8;
+constexpr int kProfileBufferRecordBytes = 8;
+
+inline int getProfileBufferBytesPerWarp(int slots) {
+  return kProfileBufferHeaderBytes + slots * kProfileBufferRecordBytes;
+}
+
+} // namespace proton
 } // namespace triton
 } // namespace mlir
 
@@ -0,0 +1,22 @@
+#ifndef TRITON_DIALECT_PROTON_TRANSFORMS_PASSES_H_
+#define TRITON_DIALECT_PROTON_TRANSFORMS_PASSES_H_
+
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace triton {
+namespace proton {
+
+// Generate the pass class declarations.
+#define GEN_PASS_DECL
+#include "proton/dialect/include/Dialect/Proton/Transforms/Passes.h.inc"
+
+// Generate the code for registering passes.
+#define GEN_PASS_REGISTRATION
+#include "proton/dialect/include/Dialect/Proton/Transforms/Passes.h.inc"
+
+} // namespace proton
+} // namespace triton
+} // namespace mlir
+
+#endif // TRITON_DIALECT_PROTON_TRANSFORMS_PASSES_H_
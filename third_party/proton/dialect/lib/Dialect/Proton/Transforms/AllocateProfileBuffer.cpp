@@ -0,0 +1,92 @@
+#include "Dialect/Proton/IR/Dialect.h"
+#include "Dialect/Proton/Transforms/Passes.h"
+#include "mlir/IR/Builders.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/IR/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+namespace mlir {
+namespace triton {
+namespace proton {
+
+#define GEN_PASS_DEF_PROTONALLOCATEPROFILEBUFFER
+#include "proton/dialect/include/Dialect/Proton/Transforms/Passes.h.inc"
+
+namespace {
+
+int32_t roundUp(int32_t val, int32_t step) {
+  auto t = val + step - 1;
+  return t - (t % step);
+}
+
+class ProtonAllocateProfileBufferPass
+    : public impl::ProtonAllocateProfileBufferBase<
+          ProtonAllocateProfileBufferPass> {
+public:
+  using impl::ProtonAllocateProfileBufferBase<
+      ProtonAllocateProfileBufferPass>::ProtonAllocateProfileBufferBase;
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    if (slotsPerWarp <= 0) {
+      mod.emitError("slots-per-warp must be positive");
+      return signalPassFailure();
+    }
+
+    triton::FuncOp kernel;
+    mod.walk([&](triton::FuncOp func) {
+      if (triton::isKernel(func))
+        kernel = func;
+    });
+    bool hasRecords = false;
+    if (kernel)
+      kernel.walk([&](RecordOp) { hasRecords = true; });
+    if (!hasRecords)
+      return;
+
+    auto sizeAttr =
+        mod->getAttrOfType<IntegerAttr>("ttg.global_scratch_memory_size");
+    auto alignAttr =
+        mod->getAttrOfType<IntegerAttr>("ttg.global_scratch_memory_alignment");
+    if (!sizeAttr || !alignAttr) {
+      mod.emitError("global scratch memory must be allocated before the "
+                    "profile buffer");
+      return signalPassFailure();
+    }
+
+    // Warp specialization adds warps beyond ttg.num-warps, and each of them
+    // gets its own circular buffer.
+    int numWarps = triton::gpu::lookupNumWarps(kernel);
+    if (auto totalNumWarps =
+            mod->getAttrOfType<IntegerAttr>("ttg.total-num-warps"))
+      numWarps = totalNumWarps.getInt();
+
+    // The header counters are read and written as u32.
+    constexpr int32_t bufferAlignment = 8;
+    int32_t offset = roundUp(sizeAttr.getInt(), bufferAlignment);
+    int32_t bufferSize = numWarps * getProfileBufferBytesPerWarp(slotsPerWarp);
+    int32_t alignment =
+        std::max<int32_t>(alignAttr.getInt(), bufferAlignment);
+    int32_t totalSize = roundUp(offset + bufferSize, alignment);
+
+    OpBuilder builder(mod);
+    for (Operation *op : {mod.getOperation(), kernel.getOperation()}) {
+      op->setAttr("ttg.global_scratch_memory_size",
+                  builder.getI32IntegerAttr(totalSize));
+      op->setAttr("ttg.global_scratch_memory_alignment",
+                  builder.getI32IntegerAttr(alignment));
+    }
+    mod->setAttr(AttrProfileBufferOffsetName,
+                 builder.getI32IntegerAttr(offset));
+    mod->setAttr(AttrProfileBufferSizeName,
+                 builder.getI32IntegerAttr(bufferSize));
+    mod->setAttr(AttrProfileBufferSlotsName,
+                 builder.getI32IntegerAttr(slotsPerWarp));
+  }
+};
+
+} // namespace
+
+} // namespace proton
+} // namespace triton
+} // namespace mlir
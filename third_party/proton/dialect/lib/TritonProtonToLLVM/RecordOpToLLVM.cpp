@@ -23,7 +23,76 @@ struct RecordOpConversion
   LogicalResult
   matchAndRewrite(mlir::triton::proton::RecordOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
+    auto funcOp = op->getParentOfType<LLVM::LLVMFuncOp>();
+    if (!funcOp)
+      return failure();
+    auto mod = op->getParentOfType<ModuleOp>();
+    auto offsetAttr = mod->getAttrOfType<IntegerAttr>(
+        proton::AttrProfileBufferOffsetName);
+    auto slotsAttr =
+        mod->getAttrOfType<IntegerAttr>(proton::AttrProfileBufferSlotsName);
+    // The profile buffer is indexed from the kernel's scratch memory, so
+    // records without a buffer or in device functions are dropped
+    if (!offsetAttr || !slotsAttr || !triton::isKernel(funcOp)) {
+      rewriter.eraseOp(op);
+      return success();
+    }
 
+    Location loc = op.getLoc();
+    auto b = TritonLLVMOpBuilder(loc, rewriter);
+    int slots = slotsAttr.getInt();
+    int bytesPerWarp = proton::getProfileBufferBytesPerWarp(slots);
+
+    // Read the counter first so that the address computation below is not
+    // attributed to the region.
+    Value cycles = b.trunc(i32_ty, targetInfo.getCycleCounter(rewriter, loc));
+    uint32_t tag = (op.getIsStart() ? 1u << 31 : 0u) | op.getRegionId();
+
+    // Every warp of the CTA, including the ones of warp specialized
+    // partitions, owns a circular buffer indexed by its hardware warp id.
+    Value tid = rewriter.create<::mlir::gpu::ThreadIdOp>(
+        loc, ::mlir::gpu::Dimension::x);
+    tid = rewriter.create<arith::IndexCastOp>(loc, i32_ty, tid);
+    Value threadsPerWarp =
+        b.i32_val(triton::gpu::lookupThreadsPerWarp(rewriter));
+    Value warpId = b.udiv(tid, threadsPerWarp);
+    Value isWriter = b.icmp_eq(b.urem(tid, threadsPerWarp), b.i32_val(0));
+    if (op.getGranularity() == proton::Granularity::WARPGROUP) {
+      Value warpInGroup = b.urem(warpId, b.i32_val(4));
+      isWriter = b.and_(isWriter, b.icmp_eq(warpInGroup, b.i32_val(0)));
+    }
+    Value bufferPtr = LLVM::getGlobalScratchPtr(
+        loc, rewriter, targetInfo, funcOp, b.i32_val(offsetAttr.getInt()));
+    Value warpPtr = b.gep(bufferPtr.getType(), i8_ty, bufferPtr,
+                          b.mul(warpId, b.i32_val(bytesPerWarp)));
+
+    // #prevBlock
+    // if (isWriter) {
+    //   #writeBlock
+    //   buffer[count++ % slots] = {tag, cycles}
+    // }
+    // #afterBlock
+    Block *prevBlock = rewriter.getInsertionBlock();
+    Block *afterBlock =
+        rewriter.splitBlock(prevBlock, rewriter.getInsertionPoint());
+    Block *writeBlock = rewriter.createBlock(afterBlock);
+    rewriter.setInsertionPointToEnd(prevBlock);
+    rewriter.create<LLVM::CondBrOp>(loc, isWriter, writeBlock, afterBlock);
+
+    rewriter.setInsertionPointToStart(writeBlock);
+    Value count = b.load(i32_ty, warpPtr);
+    Value slotOffset =
+        b.add(b.i32_val(proton::kProfileBufferHeaderBytes),
+              b.mul(b.urem(count, b.i32_val(slots)),
+                    b.i32_val(proton::kProfileBufferRecordBytes)));
+    Value recordPtr = b.gep(warpPtr.getType(), i8_ty, warpPtr, slotOffset);
+    b.store(b.i32_val(static_cast<int32_t>(tag)), recordPtr);
+    b.store(cycles,
+            b.gep(recordPtr.getType(), i32_ty, recordPtr, b.i32_val(1)));
+    b.store(b.add(count, b.i32_val(1)), warpPtr);
+    rewriter.create<LLVM::BrOp>(loc, afterBlock);
+
+    rewriter.setInsertionPointToStart(afterBlock);
     rewriter.eraseOp(op);
     return success();
   }
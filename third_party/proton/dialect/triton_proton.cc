@@ -1,4 +1,5 @@
 #include "Dialect/Proton/IR/Dialect.h"
+#include "Dialect/Proton/Transforms/Passes.h"
 #include "mlir/Pass/PassManager.h"
 #include "passes.h"
 #include <pybind11/pybind11.h>
@@ -7,8 +8,15 @@
 
 namespace py = pybind11;
 
+void init_triton_proton_passes(py::module &&m) {
+  ADD_PASS_OPTION_WRAPPER_1(
+      "add_allocate_profile_buffer",
+      mlir::triton::proton::createProtonAllocateProfileBuffer, int32_t);
+}
+
 void init_triton_proton(py::module &&m) {
   auto passes = m.def_submodule("passes");
+  init_triton_proton_passes(std::move(passes));
 
   // load dialects
   m.def("load_dialects", [](mlir::MLIRContext &context) {
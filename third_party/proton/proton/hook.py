@@ -1,11 +1,56 @@
+import threading
+
 from .state import enter_state, exit_state
-from .scope import enter_scope, exit_scope
+from .scope import enter_scope, exit_scope, thread_local_scopes
 from triton import knobs
 from triton.compiler import LazyDict
+from triton.runtime import _allocation
+from triton._C.libproton import proton as libproton
 
 COMPUTE_METADATA_SCOPE_NAME = "__proton_launch_metadata"
 
 
+class RecordAllocator:
+    """
+    Wraps the global scratch allocator to find the scratch memory of kernels with `proton.record` ops.
+
+    The launcher allocates the scratch memory right before it calls the launch enter hook, so the last allocation of
+    each thread is kept until the enter hook claims it. The per-warp record counters start from zero, so the scratch
+    memory of a kernel with a profile buffer is cleared, and kept until the launch returns, when the records are read
+    back.
+    """
+
+    state = threading.local()
+
+    def __init__(self, allocator: _allocation.Allocator) -> None:
+        self.allocator = allocator
+
+    def __call__(self, size: int, alignment: int, stream):
+        buffer = self.allocator(size, alignment, stream)
+        RecordAllocator.state.last = buffer
+        return buffer
+
+    @staticmethod
+    def claim(profile_buffer) -> None:
+        state = RecordAllocator.state
+        scratch = getattr(state, "last", None)
+        state.last = None
+        if profile_buffer is None or not hasattr(scratch, "zero_"):
+            profile_buffer, scratch = None, None
+        else:
+            scratch.zero_()
+        state.profile_buffer = profile_buffer
+        state.scratch = scratch
+
+    @staticmethod
+    def take():
+        state = RecordAllocator.state
+        profile_buffer = getattr(state, "profile_buffer", None)
+        scratch = getattr(state, "scratch", None)
+        state.profile_buffer, state.scratch = None, None
+        return profile_buffer, scratch
+
+
 class TritonHook:
     flops_width = [8, 16, 32, 64]
     metrics = [f"flops{width}" for width in flops_width] + ["bytes"] + ["flops"]
@@ -17,9 +62,17 @@ class TritonHook:
         exit_state()
         fn_metrics = {k: metadata[k] for k in TritonHook.metrics if k in metadata}
         enter_scope(metadata["name"], triton_op=True, metrics=fn_metrics)
+        RecordAllocator.claim(metadata.get("profile_buffer"))
 
     @staticmethod
     def exit(lazy_dict: LazyDict) -> None:
+        profile_buffer, scratch = RecordAllocator.take()
+        if profile_buffer is not None and thread_local_scopes.scopes:
+            # Copying to the host waits for the kernel to finish
+            scope_id = thread_local_scopes.scopes[-1][0]
+            libproton.add_records(scope_id,
+                                  scratch.cpu().numpy().tobytes(), profile_buffer["offset"], profile_buffer["size"],
+                                  profile_buffer["scratch_size"], profile_buffer["slots"])
         exit_scope(triton_op=True)
 
 
@@ -27,9 +80,13 @@ def register_triton_hook() -> None:
     if knobs.runtime.launch_enter_hook is None:
         knobs.runtime.launch_enter_hook = TritonHook.enter
         knobs.runtime.launch_exit_hook = TritonHook.exit
+        # Also wraps allocators set with triton.set_allocator later on
+        _allocation.set_allocator_wrapper(RecordAllocator)
 
 
 def unregister_triton_hook() -> None:
     if knobs.runtime.launch_enter_hook == TritonHook.enter:
         knobs.runtime.launch_enter_hook = None
         knobs.runtime.launch_exit_hook = None
+        if _allocation._allocator_wrapper is RecordAllocator:
+            _allocation.set_allocator_wrapper(None)
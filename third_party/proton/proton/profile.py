@@ -73,7 +73,9 @@ def start(
                                  Available options are ["shadow", "python"].
                                  Defaults to "shadow".
         data (str, optional): The data structure to use for profiling.
-                              Available options are ["tree"].
+                              Available options are ["tree", "trace"].
+                              "tree" aggregates metrics by calling context, while "trace" records a timeline
+                              of scopes and kernels that can only be finalized as "chrome_trace".
                               Defaults to "tree".
         hook (str, optional): The hook to use for profiling.
                               Available options are [None, "triton"].
@@ -147,7 +149,7 @@ def finalize(session: Optional[int] = None, output_format: str = "hatchet") -> N
     Args:
         session (int, optional): The session ID to finalize. If None, all sessions are finalized. Defaults to None.
         output_format (str, optional): The output format for the profiling results.
-                                       Aavailable options are ["hatchet"].
+                                       Aavailable options are ["hatchet", "hatchet_msgpack", "chrome_trace"].
 
     Returns:
         None
@@ -19,7 +19,8 @@ def parse_arguments():
                         choices=["cupti", "cupti_pcsampling", "roctracer"])
     parser.add_argument("-c", "--context", type=str, help="Profiling context", default="shadow",
                         choices=["shadow", "python"])
-    parser.add_argument("-d", "--data", type=str, help="Profiling data", default="tree", choices=["tree"])
+    parser.add_argument("-d", "--data", type=str, help="Profiling data", default="tree",
+                        choices=["tree", "trace"])
     parser.add_argument("-k", "--hook", type=str, help="Profiling hook", default=None, choices=[None, "triton"])
     parser.add_argument("-i", "--instrument", type=str, help="Instrumentation analysis type", default=None,
                         choices=[None, "print-mem-spaces"])
@@ -86,7 +87,7 @@ def run_profiling(args, target_args):
 
     do_setup_and_execute(target_args)
 
-    finalize()
+    finalize(output_format="chrome_trace" if args.data == "trace" else "hatchet")
 
 
 def run_instrumentation(args, target_args):
@@ -1,6 +1,7 @@
 import argparse
 from collections import namedtuple
 import json
+import struct
 import pandas as pd
 
 try:
@@ -63,8 +64,86 @@ def remove_frames(database: json):
     return new_database
 
 
-def get_raw_metrics(file):
-    database = json.load(file)
+def _unpack_msgpack(data: bytes):
+    # Decodes the subset of MessagePack written by proton's hatchet_msgpack dump
+    pos = 0
+
+    def take(n):
+        nonlocal pos
+        pos += n
+        return data[pos - n:pos]
+
+    def unpack_str(n):
+        return take(n).decode("utf-8")
+
+    def unpack_array(n):
+        return [unpack() for _ in range(n)]
+
+    def unpack_map(n):
+        ret = {}
+        for _ in range(n):
+            key = unpack()
+            ret[key] = unpack()
+        return ret
+
+    def unpack_be(fmt, n):
+        return struct.unpack(">" + fmt, take(n))[0]
+
+    fixed = {
+        0xc0: lambda: None,
+        0xc2: lambda: False,
+        0xc3: lambda: True,
+        0xcb: lambda: unpack_be("d", 8),
+        0xcc: lambda: unpack_be("B", 1),
+        0xcd: lambda: unpack_be("H", 2),
+        0xce: lambda: unpack_be("I", 4),
+        0xcf: lambda: unpack_be("Q", 8),
+        0xd0: lambda: unpack_be("b", 1),
+        0xd1: lambda: unpack_be("h", 2),
+        0xd2: lambda: unpack_be("i", 4),
+        0xd3: lambda: unpack_be("q", 8),
+        0xd9: lambda: unpack_str(unpack_be("B", 1)),
+        0xda: lambda: unpack_str(unpack_be("H", 2)),
+        0xdb: lambda: unpack_str(unpack_be("I", 4)),
+        0xdc: lambda: unpack_array(unpack_be("H", 2)),
+        0xdd: lambda: unpack_array(unpack_be("I", 4)),
+        0xde: lambda: unpack_map(unpack_be("H", 2)),
+        0xdf: lambda: unpack_map(unpack_be("I", 4)),
+    }
+
+    def unpack():
+        byte = take(1)[0]
+        if byte < 0x80:
+            return byte
+        if byte < 0x90:
+            return unpack_map(byte & 0x0f)
+        if byte < 0xa0:
+            return unpack_array(byte & 0x0f)
+        if byte < 0xc0:
+            return unpack_str(byte & 0x1f)
+        if byte >= 0xe0:
+            return byte - 0x100
+        if byte not in fixed:
+            raise ValueError(f"Unsupported MessagePack type 0x{byte:02x}")
+        return fixed[byte]()
+
+    return unpack()
+
+
+def load_database(filename):
+    if filename.endswith(".hatchet_msgpack"):
+        with open(filename, "rb") as f:
+            data = f.read()
+        try:
+            import msgpack
+            return msgpack.unpackb(data, raw=False, strict_map_key=False)
+        except ImportError:
+            return _unpack_msgpack(data)
+    with open(filename, "r") as f:
+        return json.load(f)
+
+
+def get_raw_metrics(database):
     database = remove_frames(database)
     device_info = database.pop(1)
     gf = ht.GraphFrame.from_literal(database)
@@ -257,11 +336,10 @@ def print_tree(gf, metrics, depth=100, format=None, print_sorted=False):
 
 
 def read(filename):
-    with open(filename, "r") as f:
-        gf, inclusive_metrics, exclusive_metrics, device_info = get_raw_metrics(f)
-        assert len(inclusive_metrics + exclusive_metrics) > 0, "No metrics found in the input file"
-        gf.update_inclusive_columns()
-        return gf, inclusive_metrics, exclusive_metrics, device_info
+    gf, inclusive_metrics, exclusive_metrics, device_info = get_raw_metrics(load_database(filename))
+    assert len(inclusive_metrics + exclusive_metrics) > 0, "No metrics found in the input file"
+    gf.update_inclusive_columns()
+    return gf, inclusive_metrics, exclusive_metrics, device_info
 
 
 def parse(metrics, filename, include=None, exclude=None, threshold=None):
@@ -273,18 +351,17 @@ def parse(metrics, filename, include=None, exclude=None, threshold=None):
 
 
 def show_metrics(file_name):
-    with open(file_name, "r") as f:
-        _, inclusive_metrics, exclusive_metrics, _ = get_raw_metrics(f)
-        print("Available inclusive metrics:")
-        if inclusive_metrics:
-            for raw_metric in inclusive_metrics:
-                raw_metric_no_unit = raw_metric.split("(")[0].strip().lower()
-                print(f"- {raw_metric_no_unit}")
-        print("Available exclusive metrics:")
-        if exclusive_metrics:
-            for raw_metric in exclusive_metrics:
-                raw_metric_no_unit = raw_metric.split("(")[0].strip().lower()
-                print(f"- {raw_metric_no_unit}")
+    _, inclusive_metrics, exclusive_metrics, _ = get_raw_metrics(load_database(file_name))
+    print("Available inclusive metrics:")
+    if inclusive_metrics:
+        for raw_metric in inclusive_metrics:
+            raw_metric_no_unit = raw_metric.split("(")[0].strip().lower()
+            print(f"- {raw_metric_no_unit}")
+    print("Available exclusive metrics:")
+    if exclusive_metrics:
+        for raw_metric in exclusive_metrics:
+            raw_metric_no_unit = raw_metric.split("(")[0].strip().lower()
+            print(f"- {raw_metric_no_unit}")
 
 
 def main():
@@ -0,0 +1,51 @@
+"""
+Measures how many ops per second a session records when every op is launched
+under a deep stack of scopes, as seen from deep Python call stacks.
+
+    python third_party/proton/test/bench_add_op.py --depth 8 64
+
+Run it on two builds to compare them.
+"""
+import argparse
+import pathlib
+import tempfile
+import time
+
+import triton._C.libproton.proton as libproton
+from triton.profiler.profile import _select_backend
+
+
+def bench(path: str, data: str, depth: int, num_ops: int):
+    session_id = libproton.start(path, "shadow", data, _select_backend(), "")
+    scope_ids = [libproton.record_scope() for _ in range(depth)]
+    for i, scope_id in enumerate(scope_ids):
+        libproton.enter_scope(scope_id, f"frame_{i}")
+    start = time.perf_counter()
+    for i in range(num_ops):
+        op_id = libproton.record_scope()
+        libproton.enter_op(op_id, f"kernel_{i % 16}")
+        libproton.add_metrics(op_id, {"flops": 1.0})
+        libproton.exit_op(op_id, f"kernel_{i % 16}")
+    elapsed = time.perf_counter() - start
+    for i, scope_id in reversed(list(enumerate(scope_ids))):
+        libproton.exit_scope(scope_id, f"frame_{i}")
+    libproton.finalize(session_id, "hatchet" if data == "tree" else "chrome_trace")
+    return num_ops / elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--depth", type=int, nargs="+", default=[1, 16, 64])
+    parser.add_argument("--num-ops", type=int, default=100000)
+    parser.add_argument("--data", nargs="+", default=["tree", "trace"])
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        for data in args.data:
+            for depth in args.depth:
+                ops = bench(str(pathlib.Path(tmp) / f"{data}_{depth}"), data, depth, args.num_ops)
+                print(f"{data:>6} data, {depth:>3} frames: {ops:12.0f} ops/s")
+
+
+if __name__ == "__main__":
+    main()
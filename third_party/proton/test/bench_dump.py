@@ -0,0 +1,83 @@
+"""
+Compares the time and peak memory of dumping a large tree profile as JSON
+(hatchet) and as MessagePack (hatchet_msgpack).
+
+    python third_party/proton/test/bench_dump.py --width 100
+
+The default width of 100 builds a tree of three nested scope levels with a
+million leaves.  Each format is dumped in a fresh process so that the peak RSS
+it reports belongs to that format alone.
+"""
+import argparse
+import json
+import pathlib
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def build_tree(path: str, width: int, depth: int):
+    import triton._C.libproton.proton as libproton
+    from triton.profiler.profile import _select_backend
+
+    session_id = libproton.start(path, "shadow", "tree", _select_backend(), "")
+
+    def build(level):
+        for i in range(width):
+            scope_id = libproton.record_scope()
+            libproton.enter_scope(scope_id, f"scope_{level}_{i}")
+            if level + 1 < depth:
+                build(level + 1)
+            else:
+                libproton.add_metrics(scope_id, {"count": i, "time": 0.5 * i, "tag": str(i)})
+            libproton.exit_scope(scope_id, f"scope_{level}_{i}")
+
+    build(0)
+    return session_id
+
+
+def dump(path: str, output_format: str, width: int, depth: int):
+    import triton._C.libproton.proton as libproton
+
+    session_id = build_tree(path, width, depth)
+    build_rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    start = time.perf_counter()
+    libproton.finalize(session_id, output_format)
+    dump_time = time.perf_counter() - start
+    peak_rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # ru_maxrss is in kilobytes on Linux
+    print(json.dumps({"time": dump_time, "rss_mb": (peak_rss - build_rss) / 1024}))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--width", type=int, default=100)
+    parser.add_argument("--depth", type=int, default=3)
+    parser.add_argument("--dump", choices=["hatchet", "hatchet_msgpack"], help=argparse.SUPPRESS)
+    parser.add_argument("--path", help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.dump:
+        dump(args.path, args.dump, args.width, args.depth)
+        return
+
+    with tempfile.TemporaryDirectory() as tmp:
+        print(f"{args.width ** args.depth} leaves")
+        for output_format in ("hatchet", "hatchet_msgpack"):
+            path = pathlib.Path(tmp) / output_format
+            output = subprocess.check_output([
+                sys.executable, __file__, "--dump", output_format, "--path",
+                str(path), "--width",
+                str(args.width), "--depth",
+                str(args.depth)
+            ])
+            result = json.loads(output.decode().strip().splitlines()[-1])
+            size = path.with_suffix(f".{output_format}").stat().st_size
+            print(f"{output_format:>16}: dump {result['time']:7.3f} s, peak RSS +{result['rss_mb']:8.1f} MB, "
+                  f"{size / 2**20:8.1f} MB on disk")
+
+
+if __name__ == "__main__":
+    main()
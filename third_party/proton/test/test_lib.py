@@ -1,8 +1,11 @@
+import json
+import os
 import pathlib
 import pytest
 
 import triton._C.libproton.proton as libproton
 from triton.profiler.profile import _select_backend
+from triton.profiler.viewer import load_database
 
 
 def test_record():
@@ -60,3 +63,121 @@ def test_add_metrics(tmp_path: pathlib.Path):
     libproton.exit_scope(id1, "one")
     libproton.finalize_all("hatchet")
     assert temp_file.exists()
+
+
+def test_trace_data(tmp_path: pathlib.Path):
+    temp_file = tmp_path / "test_trace_data.chrome_trace"
+    session_id = libproton.start(str(temp_file.with_suffix("")), "shadow", "trace", _select_backend(), "")
+    id0 = libproton.record_scope()
+    libproton.enter_scope(id0, "zero")
+    id1 = libproton.record_scope()
+    libproton.enter_scope(id1, "one")
+    libproton.add_metrics(id1, {"a": 1.0})
+    libproton.exit_scope(id1, "one")
+    # The scope is no longer active, so metrics added after it exits are dropped
+    libproton.add_metrics(id1, {"late": 1.0})
+    libproton.exit_scope(id0, "zero")
+    libproton.finalize(session_id, "chrome_trace")
+    assert temp_file.exists()
+
+    with temp_file.open() as f:
+        events = json.load(f)["traceEvents"]
+    scopes = [(event["ph"], event.get("name")) for event in events if event["ph"] in ("B", "E")]
+    assert scopes == [("B", "zero"), ("B", "one"), ("E", None), ("E", None)]
+    one = next(event for event in events if event.get("name") == "one")
+    assert one["args"]["scope_id"] == id1
+    assert one["args"]["a"] == 1.0
+    assert "late" not in one["args"]
+
+
+def _build_tree(path: str, data: str, width: int, depth: int):
+    # Builds a tree with `width ** depth` leaves under nested scopes
+    session_id = libproton.start(path, "shadow", data, _select_backend(), "")
+
+    def build(level):
+        for i in range(width):
+            scope_id = libproton.record_scope()
+            libproton.enter_scope(scope_id, f"scope_{level}_{i}")
+            if level + 1 < depth:
+                build(level + 1)
+            else:
+                libproton.add_metrics(scope_id, {"count": i, "time": 0.5 * i, "tag": str(i)})
+            libproton.exit_scope(scope_id, f"scope_{level}_{i}")
+
+    build(0)
+    return session_id
+
+
+def test_hatchet_msgpack(tmp_path: pathlib.Path):
+    databases = []
+    for output_format in ("hatchet", "hatchet_msgpack"):
+        temp_file = tmp_path / f"test_hatchet_msgpack.{output_format}"
+        session_id = _build_tree(str(temp_file.with_suffix("")), "tree", width=3, depth=3)
+        libproton.finalize(session_id, output_format)
+        assert temp_file.exists()
+        databases.append(load_database(str(temp_file)))
+    assert databases[0] == databases[1]
+    leaf = databases[1][0]["children"][0]["children"][2]["children"][1]
+    assert leaf["frame"]["name"] == "scope_2_1"
+    assert leaf["metrics"] == {"count": 1, "time": 0.5, "tag": "1"}
+
+
+def test_hatchet_msgpack_large(tmp_path: pathlib.Path):
+    # PROTON_DUMP_BENCHMARK_WIDTH=100 gives the million-node tree
+    width = int(os.environ.get("PROTON_DUMP_BENCHMARK_WIDTH", "16"))
+    databases = {}
+    for output_format in ("hatchet", "hatchet_msgpack"):
+        temp_file = tmp_path / f"{output_format}.{output_format}"
+        session_id = _build_tree(str(temp_file.with_suffix("")), "tree", width=width, depth=3)
+        libproton.finalize(session_id, output_format)
+        databases[output_format] = load_database(str(temp_file))
+    assert databases["hatchet"] == databases["hatchet_msgpack"]
+    msgpack_size = (tmp_path / "hatchet_msgpack.hatchet_msgpack").stat().st_size
+    assert msgpack_size < (tmp_path / "hatchet.hatchet").stat().st_size
+
+    def leaves(node):
+        if not node["children"]:
+            yield node
+        for child in node["children"]:
+            yield from leaves(child)
+
+    root = databases["hatchet_msgpack"][0]
+    found = list(leaves(root))
+    assert len(found) == width**3
+    assert sum(leaf["metrics"]["count"] for leaf in found) == width**2 * sum(range(width))
+
+
+def test_tree_data_rejects_chrome_trace(tmp_path: pathlib.Path):
+    temp_file = tmp_path / "test_tree_data_rejects_chrome_trace.hatchet"
+    session_id = libproton.start(str(temp_file.with_suffix("")), "shadow", "tree", _select_backend(), "")
+    with pytest.raises(RuntimeError, match="does not support the chrome_trace output format"):
+        libproton.finalize(session_id, "chrome_trace")
+    libproton.finalize(session_id, "hatchet")
+    assert temp_file.exists()
+
+
+def test_add_op_under_deep_scopes(tmp_path: pathlib.Path):
+    # Ops launched under a deep stack of scopes, as seen from deep Python call stacks
+    depth, num_ops = 64, 1600
+    temp_file = tmp_path / "test_add_op_under_deep_scopes.hatchet"
+    session_id = libproton.start(str(temp_file.with_suffix("")), "shadow", "tree", _select_backend(), "")
+    scope_ids = [libproton.record_scope() for _ in range(depth)]
+    for i, scope_id in enumerate(scope_ids):
+        libproton.enter_scope(scope_id, f"frame_{i}")
+    for i in range(num_ops):
+        op_id = libproton.record_scope()
+        libproton.enter_op(op_id, f"kernel_{i % 16}")
+        libproton.add_metrics(op_id, {"flops": 1.0})
+        libproton.exit_op(op_id, f"kernel_{i % 16}")
+    for i, scope_id in reversed(list(enumerate(scope_ids))):
+        libproton.exit_scope(scope_id, f"frame_{i}")
+    libproton.finalize(session_id, "hatchet")
+
+    with temp_file.open() as f:
+        node = json.load(f)[0]
+    for i in range(depth):
+        node = node["children"][0]
+        assert node["frame"]["name"] == f"frame_{i}"
+    # Children are dumped in insertion order
+    assert [child["frame"]["name"] for child in node["children"]] == [f"kernel_{i}" for i in range(16)]
+    assert sum(child["metrics"]["flops"] for child in node["children"]) == num_ops
@@ -1,11 +1,18 @@
+import json
 import torch
 import pathlib
+import pytest
 
 import triton
 import triton.language as tl
+import triton.profiler as proton
 import triton.profiler.language as pl
 
 
+def is_cuda():
+    return triton.runtime.driver.active.get_current_target().backend == "cuda"
+
+
 def test_proton_record(tmp_path: pathlib.Path):
 
     @triton.jit
@@ -38,3 +45,41 @@ def test_proton_record(tmp_path: pathlib.Path):
     ttir = pgm.asm['ttir']
     assert "proton.record() {isStart = true, regionId = 0 : i32}" in ttir
     assert "proton.record() {isStart = false, regionId = 0 : i32}" in ttir
+
+
+@pytest.mark.skipif(not is_cuda(), reason="profile buffers are only allocated on NVIDIA GPUs")
+@pytest.mark.parametrize("allocator_before_start", [True, False])
+def test_proton_record_cycles(tmp_path: pathlib.Path, allocator_before_start: bool):
+
+    @triton.jit
+    def loop_kernel(x_ptr, n_iters, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(x_ptr + offsets)
+        for _ in range(n_iters):
+            pl.record(True, 1)
+            x = x * 2.0 + 1.0
+            pl.record(False, 1)
+        tl.store(x_ptr + offsets, x)
+
+    def alloc_fn(size: int, alignment: int, stream):
+        return torch.empty(size, device="cuda", dtype=torch.int8)
+
+    x = torch.zeros(1024, device="cuda")
+    temp_file = tmp_path / "test_proton_record_cycles.hatchet"
+    # The records are found whether the allocator is set before or after the hook is registered
+    if allocator_before_start:
+        triton.set_allocator(alloc_fn)
+    proton.start(str(temp_file.with_suffix("")), hook="triton")
+    if not allocator_before_start:
+        triton.set_allocator(alloc_fn)
+    pgm = loop_kernel[(4, )](x, 3, BLOCK_SIZE=256, num_warps=4)
+    proton.finalize()
+    assert pgm.metadata.profile_buffer_size > 0
+
+    with temp_file.open() as f:
+        data = json.load(f)
+    kernel_frame = next(child for child in data[0]["children"] if child["frame"]["name"] == "loop_kernel")
+    region_frame = next(child for child in kernel_frame["children"] if child["frame"]["name"] == "region_1")
+    # The first warp of the only warp group records every iteration of every program
+    assert region_frame["metrics"]["count"] == 4 * 3
+    assert region_frame["metrics"]["cycles"] > 0
@@ -0,0 +1,171 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Parser/Parser.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/Membar.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <limits>
+#include <gtest/gtest.h>
+
+namespace mlir {
+namespace {
+
+// Builds a function with `numBuffers` explicit allocations of varying sizes.
+// Buffer `i` is freed right after buffer `i + window` is allocated, so every
+// buffer interferes with its `window` predecessors and successors.
+std::string buildManyBufferModule(int numBuffers, int window) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << R"(
+#shared = #ttg.swizzled_shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#smem = #ttg.shared_memory
+module attributes {"ttg.num-warps" = 4 : i32, "ttg.num-ctas" = 1 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  tt.func @many_buffers() {
+)";
+  auto type = [](int i) {
+    return llvm::formatv("!ttg.memdesc<16x{0}xf16, #shared, #smem, mutable>",
+                         16 * (1 + i % 4))
+        .str();
+  };
+  for (int i = 0; i < numBuffers; ++i) {
+    os << llvm::formatv("    %b{0} = ttg.local_alloc : () -> {1}\n", i,
+                        type(i));
+    if (i >= window)
+      os << llvm::formatv("    ttg.local_dealloc %b{0} : {1}\n", i - window,
+                          type(i - window));
+  }
+  for (int i = std::max(0, numBuffers - window); i < numBuffers; ++i)
+    os << llvm::formatv("    ttg.local_dealloc %b{0} : {1}\n", i, type(i));
+  os << "    tt.return\n  }\n}\n";
+  return str;
+}
+
+// Builds a loop that mimics a software pipeline with `numStages` stages, each
+// staging `numOperands` tiles through their own shared memory buffer. Every
+// buffer is written and then read back in the loop body, so the membar
+// analysis tracks `numStages * numOperands` distinct intervals per block.
+std::string buildDeepPipelineModule(int numStages, int numOperands) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << R"(
+#blocked = #ttg.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared = #ttg.swizzled_shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#smem = #ttg.shared_memory
+module attributes {"ttg.num-warps" = 4 : i32, "ttg.num-ctas" = 1 : i32, "ttg.threads-per-warp" = 32 : i32} {
+  tt.func @deep_pipeline(%lb : index, %ub : index, %step : index) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf16, #blocked>
+)";
+  constexpr const char *type =
+      "!ttg.memdesc<32x32xf16, #shared, #smem, mutable>";
+  int numBuffers = numStages * numOperands;
+  for (int i = 0; i < numBuffers; ++i)
+    os << llvm::formatv("    %b{0} = ttg.local_alloc : () -> {1}\n", i, type);
+  os << "    scf.for %iv = %lb to %ub step %step {\n";
+  for (int i = 0; i < numBuffers; ++i)
+    os << llvm::formatv("      ttg.local_store %cst, %b{0} : "
+                        "tensor<32x32xf16, #blocked> -> {1}\n",
+                        i, type);
+  for (int i = 0; i < numBuffers; ++i)
+    os << llvm::formatv("      %l{0} = ttg.local_load %b{0} : {1} -> "
+                        "tensor<32x32xf16, #blocked>\n",
+                        i, type);
+  os << "    }\n    tt.return\n  }\n}\n";
+  return str;
+}
+
+// Returns the time of the fastest of `iters` runs of `fn` in milliseconds.
+template <typename Fn> double timeMs(int iters, Fn &&fn) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < iters; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start);
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+// The correctness of the analyses on these shapes is covered by the lit tests
+// in test/Analysis. This only reports how long they take on synthetic modules
+// much larger than a real kernel.
+class AnalysisBenchmark : public ::testing::Test {
+public:
+  AnalysisBenchmark() {
+    ctx.loadDialect<arith::ArithDialect, gpu::GPUDialect, scf::SCFDialect,
+                    triton::TritonDialect, triton::gpu::TritonGPUDialect,
+                    triton::nvidia_gpu::TritonNvidiaGPUDialect>();
+  }
+
+protected:
+  static constexpr int kIters = 5;
+
+  OwningOpRef<ModuleOp> parse(const std::string &source) {
+    auto mod = parseSourceString<ModuleOp>(source, &ctx);
+    EXPECT_TRUE(mod);
+    return mod;
+  }
+
+  MLIRContext ctx;
+};
+
+TEST_F(AnalysisBenchmark, ManyBuffersAllocation) {
+  constexpr int window = 8;
+  for (int numBuffers : {64, 256, 1024, 4096}) {
+    auto mod = parse(buildManyBufferModule(numBuffers, window));
+    if (!mod)
+      return;
+
+    size_t sizes[2];
+    double times[2];
+    for (auto policy : {triton::AllocationPolicy::GraphColoring,
+                        triton::AllocationPolicy::BestFit}) {
+      int idx = policy == triton::AllocationPolicy::BestFit;
+      times[idx] = timeMs(kIters, [&] {
+        ModuleAllocation allocation(
+            *mod, triton::defaultAllocationAnalysisScratchSizeFn, policy);
+        sizes[idx] = allocation.getSharedMemorySize();
+      });
+    }
+    EXPECT_LE(sizes[1], sizes[0]);
+    llvm::outs() << llvm::formatv(
+        "allocation of {0,5} buffers: coloring {1,9:F2} ms ({2} bytes), "
+        "best-fit {3,9:F2} ms ({4} bytes)\n",
+        numBuffers, times[0], sizes[0], times[1], sizes[1]);
+  }
+}
+
+TEST_F(AnalysisBenchmark, DeepPipelineMembar) {
+  constexpr int numOperands = 16;
+  for (int numStages = 2; numStages <= 6; ++numStages) {
+    auto mod = parse(buildDeepPipelineModule(numStages, numOperands));
+    if (!mod)
+      return;
+
+    // The analysis inserts barriers, so every run starts from a fresh copy of
+    // the module.
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < kIters; i++) {
+      OwningOpRef<ModuleOp> clone = mod->clone();
+      ModuleAllocation allocation(*clone);
+      best = std::min(best, timeMs(1, [&] {
+                        ModuleMembarAnalysis membarPass(&allocation);
+                        membarPass.run();
+                      }));
+    }
+    llvm::outs() << llvm::formatv(
+        "membar of {0} stages x {1} operands: {2,9:F2} ms\n", numStages,
+        numOperands, best);
+  }
+}
+
+} // namespace
+} // namespace mlir
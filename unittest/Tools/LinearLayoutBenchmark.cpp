@@ -0,0 +1,157 @@
+#include "triton/Tools/LinearLayout.h"
+
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <optional>
+#include <gtest/gtest.h>
+
+namespace mlir::triton {
+namespace {
+
+// The basis-by-basis versions of `apply` and `compose` that predate the flat
+// bit-matrix storage, kept as the baseline the new code is compared against.
+SmallVector<std::pair<StringAttr, int32_t>>
+referenceApply(const LinearLayout &ll,
+               ArrayRef<std::pair<StringAttr, int32_t>> ins) {
+  SmallVector<std::pair<StringAttr, int32_t>> ret;
+  for (StringAttr outDim : ll.getOutDimNames()) {
+    int32_t outVal = 0;
+    for (auto &[inDim, val] : ins) {
+      for (int i = 0; i < ll.getInDimSizeLog2(inDim); i++) {
+        if (val & (1 << i))
+          outVal ^= ll.getBasis(inDim, i, outDim);
+      }
+    }
+    ret.push_back({outDim, outVal});
+  }
+  return ret;
+}
+
+LinearLayout referenceCompose(const LinearLayout &inner,
+                              const LinearLayout &outer) {
+  LinearLayout::BasesT newBases;
+  for (const auto &[inDim, inDimBases] : inner.getBases()) {
+    auto &newInDimBases = newBases[inDim];
+    for (const auto &basis : inDimBases) {
+      SmallVector<std::pair<StringAttr, int32_t>> ins;
+      for (auto [outDim, b] : llvm::zip(inner.getOutDimNames(), basis))
+        ins.push_back({outDim, b});
+      auto outs = referenceApply(outer, ins);
+      auto outVals = llvm::make_second_range(outs);
+      newInDimBases.push_back(
+          std::vector<int32_t>(outVals.begin(), outVals.end()));
+    }
+  }
+  return LinearLayout(std::move(newBases), outer.getOutDims(),
+                      /*requireSurjective=*/false);
+}
+
+// Returns the average time of `fn` in microseconds.
+template <typename Fn> double timeUs(int iters, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iters; i++)
+    fn();
+  auto elapsed = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start);
+  return elapsed.count() / iters;
+}
+
+class LinearLayoutBenchmark : public ::testing::Test {
+public:
+  StringAttr S(StringRef str) { return StringAttr::get(&ctx, str); }
+
+  void SetUp() override {
+    // Two blocked-style layouts of a 64x32 tensor over 2 CTAs of 4 warps that
+    // distribute the same elements in a different order, as seen by a
+    // convert_layout between them.
+    src = LinearLayout::identity1D(4, S("register"), S("dim1")) *
+          LinearLayout::identity1D(8, S("lane"), S("dim1")) *
+          LinearLayout::identity1D(4, S("lane"), S("dim0")) *
+          LinearLayout::identity1D(4, S("warp"), S("dim0")) *
+          LinearLayout::identity1D(2, S("register"), S("dim0")) *
+          LinearLayout::identity1D(2, S("block"), S("dim0"));
+    dst = LinearLayout::identity1D(2, S("register"), S("dim0")) *
+          LinearLayout::identity1D(4, S("lane"), S("dim0")) *
+          LinearLayout::identity1D(8, S("lane"), S("dim1")) *
+          LinearLayout::identity1D(4, S("register"), S("dim1")) *
+          LinearLayout::identity1D(4, S("warp"), S("dim0")) *
+          LinearLayout::identity1D(2, S("block"), S("dim0"));
+  }
+
+  void report(StringRef op, double newUs, std::optional<double> oldUs = {}) {
+    llvm::outs() << llvm::formatv("{0,-18} {1,8:F3} us", op, newUs);
+    if (oldUs)
+      llvm::outs() << llvm::formatv("  (basis-by-basis {0,8:F3} us, {1:F1}x)",
+                                    *oldUs, *oldUs / newUs);
+    llvm::outs() << "\n";
+  }
+
+protected:
+  static constexpr int kIters = 2000;
+
+  MLIRContext ctx;
+  LinearLayout src;
+  LinearLayout dst;
+};
+
+TEST_F(LinearLayoutBenchmark, Apply) {
+  SmallVector<SmallVector<std::pair<StringAttr, int32_t>>> inputs;
+  for (int reg = 0; reg < 8; reg++)
+    for (int lane = 0; lane < 32; lane += 3)
+      inputs.push_back({{S("register"), reg},
+                        {S("lane"), lane},
+                        {S("warp"), lane % 4},
+                        {S("block"), reg % 2}});
+  for (const auto &in : inputs)
+    EXPECT_EQ(src.apply(in), referenceApply(src, in));
+
+  int64_t sink = 0;
+  double newUs = timeUs(kIters, [&] {
+    for (const auto &in : inputs)
+      sink += src.apply(in)[0].second;
+  });
+  double oldUs = timeUs(kIters, [&] {
+    for (const auto &in : inputs)
+      sink += referenceApply(src, in)[0].second;
+  });
+  report("apply", newUs, oldUs);
+  EXPECT_NE(sink, -1);
+}
+
+TEST_F(LinearLayoutBenchmark, Compose) {
+  LinearLayout cvt = src.invertAndCompose(dst);
+  EXPECT_EQ(cvt.compose(dst), referenceCompose(cvt, dst));
+  EXPECT_EQ(cvt.compose(dst),
+            src.transposeOuts(llvm::to_vector(dst.getOutDimNames())));
+
+  double newUs = timeUs(kIters, [&] { (void)cvt.compose(dst); });
+  double oldUs = timeUs(kIters, [&] { (void)referenceCompose(cvt, dst); });
+  report("compose", newUs, oldUs);
+}
+
+TEST_F(LinearLayoutBenchmark, InvertAndCompose) {
+  report("invertAndCompose",
+         timeUs(kIters, [&] { (void)src.invertAndCompose(dst); }));
+}
+
+TEST_F(LinearLayoutBenchmark, Pseudoinvert) {
+  LinearLayout inv = src.pseudoinvert();
+  LinearLayout identity =
+      LinearLayout::identity1D(8, S("register"), S("register")) *
+      LinearLayout::identity1D(32, S("lane"), S("lane")) *
+      LinearLayout::identity1D(4, S("warp"), S("warp")) *
+      LinearLayout::identity1D(2, S("block"), S("block"));
+  EXPECT_EQ(src.compose(inv), identity);
+  report("pseudoinvert", timeUs(kIters, [&] { (void)src.pseudoinvert(); }));
+}
+
+TEST_F(LinearLayoutBenchmark, Multiply) {
+  report("operator*", timeUs(kIters, [&] { (void)(src * src); }));
+}
+
+} // namespace
+} // namespace mlir::triton
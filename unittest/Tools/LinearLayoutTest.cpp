@@ -1093,6 +1093,91 @@ TEST_F(LinearLayoutTest, Divide_EliminateOutDim) {
   EXPECT_EQ(divideRight(l4, l5).value(), l6);
 }
 
+TEST_F(LinearLayoutTest, ConvertLayoutRoundTrip) {
+  // Two blocked-style layouts of a 64x32 tensor over 2 CTAs of 4 warps that
+  // distribute the same elements in a different order.
+  LinearLayout src = LinearLayout::identity1D(4, S("register"), S("dim1")) *
+                     LinearLayout::identity1D(8, S("lane"), S("dim1")) *
+                     LinearLayout::identity1D(4, S("lane"), S("dim0")) *
+                     LinearLayout::identity1D(4, S("warp"), S("dim0")) *
+                     LinearLayout::identity1D(2, S("register"), S("dim0")) *
+                     LinearLayout::identity1D(2, S("block"), S("dim0"));
+  LinearLayout dst = LinearLayout::identity1D(2, S("register"), S("dim0")) *
+                     LinearLayout::identity1D(4, S("lane"), S("dim0")) *
+                     LinearLayout::identity1D(8, S("lane"), S("dim1")) *
+                     LinearLayout::identity1D(4, S("register"), S("dim1")) *
+                     LinearLayout::identity1D(4, S("warp"), S("dim0")) *
+                     LinearLayout::identity1D(2, S("block"), S("dim0"));
+
+  LinearLayout cvt = src.invertAndCompose(dst);
+  EXPECT_EQ(cvt.compose(dst),
+            src.transposeOuts(to_vector(dst.getOutDimNames())));
+
+  LinearLayout identity =
+      LinearLayout::identity1D(8, S("register"), S("register")) *
+      LinearLayout::identity1D(32, S("lane"), S("lane")) *
+      LinearLayout::identity1D(4, S("warp"), S("warp")) *
+      LinearLayout::identity1D(2, S("block"), S("block"));
+  EXPECT_EQ(src.compose(src.pseudoinvert()), identity);
+
+  // apply() agrees with xor'ing the bases of the set bits.
+  for (int reg = 0; reg < 8; reg++) {
+    for (int lane = 0; lane < 32; lane += 3) {
+      SmallVector<std::pair<StringAttr, int32_t>> ins = {{S("register"), reg},
+                                                         {S("lane"), lane},
+                                                         {S("warp"), lane % 4},
+                                                         {S("block"), reg % 2}};
+      SmallVector<std::pair<StringAttr, int32_t>> expected;
+      for (StringAttr outDim : src.getOutDimNames()) {
+        int32_t outVal = 0;
+        for (auto [inDim, val] : ins) {
+          for (int i = 0; i < src.getInDimSizeLog2(inDim); i++) {
+            if (val & (1 << i))
+              outVal ^= src.getBasis(inDim, i, outDim);
+          }
+        }
+        expected.push_back({outDim, outVal});
+      }
+      EXPECT_EQ(src.apply(ins), expected);
+    }
+  }
+}
+
+TEST_F(LinearLayoutTest, MoreThan64OutBits) {
+  // 90 out bits, so every basis takes two words and out2 straddles them.
+  LinearLayout ll = LinearLayout::identity1D(1 << 30, S("in0"), S("out0")) *
+                    LinearLayout::identity1D(1 << 30, S("in1"), S("out1")) *
+                    LinearLayout::identity1D(1 << 30, S("in2"), S("out2"));
+  EXPECT_EQ(ll.getNumBasisWords(), 2);
+  EXPECT_TRUE(ll.isSurjective());
+  EXPECT_TRUE(ll.isInjective());
+  EXPECT_THAT(ll.getBasis(S("in2"), 3), ElementsAre(0, 0, 8));
+  EXPECT_EQ(ll.getBasis(S("in2"), 29, S("out2")), 1 << 29);
+  EXPECT_THAT(ll.apply({{S("in0"), 5}, {S("in1"), 0}, {S("in2"), 0x3fff0001}}),
+              ElementsAre(Pair(S("out0"), 5), Pair(S("out1"), 0),
+                          Pair(S("out2"), 0x3fff0001)));
+
+  LinearLayout transposed = ll.transposeOuts({S("out2"), S("out0"), S("out1")});
+  EXPECT_THAT(transposed.getBasis(S("in2"), 29), ElementsAre(1 << 29, 0, 0));
+  EXPECT_EQ(transposed.transposeOuts({S("out0"), S("out1"), S("out2")}), ll);
+  EXPECT_EQ(ll.sublayout({S("in2")}, {S("out2")}),
+            LinearLayout::identity1D(1 << 30, S("in2"), S("out2")));
+
+  LinearLayout identity =
+      LinearLayout::identity1D(1 << 30, S("in0"), S("in0")) *
+      LinearLayout::identity1D(1 << 30, S("in1"), S("in1")) *
+      LinearLayout::identity1D(1 << 30, S("in2"), S("in2"));
+  EXPECT_EQ(ll.compose(ll.pseudoinvert()), identity);
+
+  using AR = llvm::ArrayRef<std::pair<StringAttr, int32_t>>;
+  LinearLayout broadcast = ll * LinearLayout::zeros1D(4, S("in3"), S("out0"));
+  EXPECT_EQ(AR(to_vector(broadcast.getFreeVariableMasks())),
+            AR({{S("in0"), 0},
+                {S("in1"), 0},
+                {S("in2"), 0},
+                {S("in3"), 0b11}}));
+}
+
 TEST_F(LinearLayoutTest, ColumnActionApplyLayout) {
   // Create a simple LinearLayout with one input dimension "in" and one output
   // "out". The original bases for "in" are: [{1}, {2}, {4}]. According to the